@@ -0,0 +1,30 @@
+# Copyright (c) 2019, MariaDB Corporation.
+#
+# This program is free software; you can redistribute it and/or modify it under
+# the terms of the GNU General Public License as published by the Free Software
+# Foundation; version 2 of the License.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along with
+# this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+# zstd as an alternative to zlib in the compressed client/server protocol
+
+SET(WITH_PROTOCOL_ZSTD AUTO CACHE STRING
+  "Use zstd in the compressed client/server protocol. Possible values are 'ON', 'OFF', 'AUTO' and default is 'AUTO'")
+
+MACRO (MYSQL_CHECK_ZSTD)
+  IF (WITH_PROTOCOL_ZSTD STREQUAL "ON" OR WITH_PROTOCOL_ZSTD STREQUAL "AUTO")
+    FIND_PACKAGE(zstd)
+    IF (ZSTD_FOUND AND HAVE_COMPRESS)
+      SET(HAVE_ZSTD 1)
+      INCLUDE_DIRECTORIES(SYSTEM ${ZSTD_INCLUDE_DIR})
+    ELSEIF (WITH_PROTOCOL_ZSTD STREQUAL "ON")
+      MESSAGE(FATAL_ERROR "Required zstd library is not found")
+    ENDIF()
+  ENDIF()
+ENDMACRO()
@@ -41,6 +41,8 @@ typedef struct st_json_string_t
 
   my_charset_conv_mb_wc wc; /* UNICODE conversion function. */
                             /* It's taken out of the cs just to speed calls. */
+  my_bool ascii_based;   /* Bytes below 0x80 are always ASCII characters, */
+                         /* so runs of them can be scanned in bulk.       */
 } json_string_t;
 
 
@@ -726,6 +726,7 @@ struct st_my_thread_var
   my_bool init;
   struct st_my_thread_var *next,**prev;
   void *keycache_link;
+  void *compress_ctx;        /* zstd contexts of my_compress_packet() */
   uint  lock_type; /* used by conditional release the queue */
   void  *stack_ends_here;
   safe_mutex_t *mutex_in_use;
@@ -132,6 +132,9 @@ typedef struct my_aio_result {
 #define MY_WAIT_FOR_USER_TO_FIX_PANIC	60	/* in seconds */
 #define MY_WAIT_GIVE_USER_A_MESSAGE	10	/* Every 10 times of prev */
 #define MIN_COMPRESS_LENGTH		50	/* Don't compress small bl. */
+	/* Compression algorithms of my_compress_packet() */
+#define MY_COMPRESS_ZLIB		0
+#define MY_COMPRESS_ZSTD		1
 #define DFLT_INIT_HITS  3
 
 	/* root_alloc flags */
@@ -896,6 +899,33 @@ extern void free_root(MEM_ROOT *root, myf MyFLAGS);
 extern void set_prealloc_root(MEM_ROOT *root, char *ptr);
 extern void reset_root_defaults(MEM_ROOT *mem_root, size_t block_size,
                                 size_t prealloc_size);
+
+/*
+  Free blocks of thread specific memory roots, kept for reuse by the
+  roots of the same thread. The blocks are listed by power of two size
+  classes, from MEM_ROOT_BLOCK_CACHE_MIN_BLOCK to
+  MEM_ROOT_BLOCK_CACHE_MAX_BLOCK, rounding their size down.
+*/
+#define MEM_ROOT_BLOCK_CACHE_MIN_SHIFT 10
+#define MEM_ROOT_BLOCK_CACHE_CLASSES   8
+#define MEM_ROOT_BLOCK_CACHE_MIN_BLOCK ((size_t) 1 << MEM_ROOT_BLOCK_CACHE_MIN_SHIFT)
+#define MEM_ROOT_BLOCK_CACHE_MAX_BLOCK \
+  (MEM_ROOT_BLOCK_CACHE_MIN_BLOCK << (MEM_ROOT_BLOCK_CACHE_CLASSES - 1))
+
+typedef struct st_mem_root_block_cache
+{
+  USED_MEM *blocks[MEM_ROOT_BLOCK_CACHE_CLASSES]; /* Free blocks per size */
+  size_t size;                     /* Total size of cached blocks */
+  size_t max_size;                 /* Don't cache more than this */
+  ulong *allocated;                /* Blocks allocated with my_malloc() */
+  ulong *reused;                   /* Blocks taken from the cache */
+} MEM_ROOT_BLOCK_CACHE;
+
+typedef MEM_ROOT_BLOCK_CACHE *(*MEM_ROOT_BLOCK_CACHE_CB)(void);
+extern void set_mem_root_block_cache_cb(MEM_ROOT_BLOCK_CACHE_CB func);
+extern void init_mem_root_block_cache(MEM_ROOT_BLOCK_CACHE *cache,
+                                      size_t max_size);
+extern void free_mem_root_block_cache(MEM_ROOT_BLOCK_CACHE *cache);
 extern char *strdup_root(MEM_ROOT *root,const char *str);
 static inline char *safe_strdup_root(MEM_ROOT *root, const char *str)
 {
@@ -912,6 +942,12 @@ extern void *my_az_allocator(void *dummy, unsigned int items, unsigned int size)
 extern void my_az_free(void *dummy, void *address);
 extern int my_compress_buffer(uchar *dest, size_t *destLen,
                               const uchar *source, size_t sourceLen);
+extern size_t my_compress_packet(uint algorithm, int level,
+                                 const uchar *from, size_t len, uchar *to);
+extern my_bool my_uncompress_packet(uint algorithm, uchar *packet,
+                                    size_t len, size_t *complen);
+extern my_bool my_compress_algorithm_supported(uint algorithm);
+extern void my_compress_ctx_free(void *ctx);
 extern int packfrm(const uchar *, size_t, uchar **, size_t *);
 extern int unpackfrm(uchar **, size_t *, const uchar *);
 
@@ -271,6 +271,12 @@ enum enum_indicator_type
 #define CLIENT_SESSION_TRACK (1ULL << 23)
 /* Client no longer needs EOF packet */
 #define CLIENT_DEPRECATE_EOF (1ULL << 24)
+/*
+  Client can use the compressed protocol with zstd instead of zlib, the
+  zstd compression level follows the connection attributes in the
+  handshake response. Same bit and format as in MySQL 8.0.18.
+*/
+#define CLIENT_ZSTD_COMPRESSION_ALGORITHM (1ULL << 26)
 
 #define CLIENT_PROGRESS_OBSOLETE  (1ULL << 29)
 #define CLIENT_SSL_VERIFY_SERVER_CERT (1ULL << 30)
@@ -300,6 +306,12 @@ enum enum_indicator_type
 #define CAN_CLIENT_COMPRESS 0
 #endif
 
+#ifdef HAVE_ZSTD
+#define CAN_CLIENT_ZSTD_COMPRESSION CLIENT_ZSTD_COMPRESSION_ALGORITHM
+#else
+#define CAN_CLIENT_ZSTD_COMPRESSION 0
+#endif
+
 /*
   Gather all possible capabilities (flags) supported by the server
 
@@ -311,6 +323,7 @@ enum enum_indicator_type
                            CLIENT_CONNECT_WITH_DB | \
                            CLIENT_NO_SCHEMA | \
                            CLIENT_COMPRESS | \
+                           CLIENT_ZSTD_COMPRESSION_ALGORITHM | \
                            CLIENT_ODBC | \
                            CLIENT_LOCAL_FILES | \
                            CLIENT_IGNORE_SPACE | \
@@ -345,8 +358,9 @@ enum enum_indicator_type
   If any of the optional flags is supported by the build it will be switched
   on before sending to the client during the connection handshake.
 */
-#define CLIENT_BASIC_FLAGS (((CLIENT_ALL_FLAGS & ~CLIENT_SSL) \
+#define CLIENT_BASIC_FLAGS ((((CLIENT_ALL_FLAGS & ~CLIENT_SSL) \
                                                & ~CLIENT_COMPRESS) \
+                                               & ~CLIENT_ZSTD_COMPRESSION_ALGORITHM) \
                                                & ~CLIENT_SSL_VERIFY_SERVER_CERT)
 
 /**
@@ -459,7 +473,7 @@ typedef struct st_net {
   char net_skip_rest_factor;
   my_bool thread_specific_malloc;
   unsigned char compress;
-  my_bool unused3; /* Please remove with the next incompatible ABI change. */
+  unsigned char compress_algorithm;     /* MY_COMPRESS_ZLIB or _ZSTD */
   /*
     Pointer to query object in query cache, do not equal NULL (0) for
     queries in cache that have not stored its results yet
@@ -468,7 +482,7 @@ typedef struct st_net {
   void *thd; 	   /* Used by MariaDB server to avoid calling current_thd */
   unsigned int last_errno;
   unsigned char error; 
-  my_bool unused4; /* Please remove with the next incompatible ABI change. */
+  unsigned char compress_level;         /* 0 for the default level */
   my_bool unused5; /* Please remove with the next incompatible ABI change. */
   /** Client library error message buffer. Actually belongs to struct MYSQL. */
   char last_error[MYSQL_ERRMSG_SIZE];
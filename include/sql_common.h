@@ -44,6 +44,8 @@ struct st_mysql_options_extention {
   struct mysql_async_context *async_context;
   HASH connection_attributes;
   size_t connection_attributes_length;
+  uint compression_algorithm;                   /* MY_COMPRESS_ZLIB or _ZSTD */
+  uint zstd_compression_level;
 };
 
 typedef struct st_mysql_methods
@@ -76,6 +76,7 @@ void	vio_delete(Vio* vio);
 int	vio_close(Vio* vio);
 my_bool vio_reset(Vio* vio, enum enum_vio_type type,
                   my_socket sd, void *ssl, uint flags);
+my_bool vio_set_buffered_read(Vio *vio, my_bool on);
 size_t	vio_read(Vio *vio, uchar *	buf, size_t size);
 size_t  vio_read_buff(Vio *vio, uchar * buf, size_t size);
 size_t	vio_write(Vio *vio, const uchar * buf, size_t size);
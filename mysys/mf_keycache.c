@@ -24,6 +24,8 @@
 
     Partitioned Key Cache Module
 
+    Clock Key Cache Module
+
     Key Cache Interface Module
      
 */
@@ -34,6 +36,7 @@
 #include "my_static.h"
 #include <m_string.h>
 #include <my_bit.h>
+#include <my_atomic.h>
 #include <errno.h>
 #include <stdarg.h>
 #include "probes_mysql.h"
@@ -5822,92 +5825,1626 @@ static KEY_CACHE_FUNCS partitioned_key_cache_funcs =
 };
 
 
-/****************************************************************************** 
-  Key Cache Interface Module
-
-  The module contains wrappers for all key cache interface functions. 
-  
-  Currently there are key caches of two types: simple key caches and
-  partitioned key caches. Each type (class) has its own implementation of the
-  basic key cache operations used the MyISAM storage engine. The pointers
-  to the implementation functions are stored in two static structures of the
-  type KEY_CACHE_FUNC: simple_key_cache_funcs - for simple key caches, and
-  partitioned_key_cache_funcs - for partitioned key caches. When a key cache
-  object is created the constructor procedure init_key_cache places a pointer
-  to the corresponding table into one of its fields. The procedure also
-  initializes a control block for the key cache oject and saves the pointer
-  to this block in another field of the key cache object.
-  When a key cache wrapper function is invoked for a key cache object to
-  perform a basic key cache operation it looks into the interface table
-  associated with the key cache oject and calls the corresponding
-  implementation of the operation. It passes the saved key cache control
-  block to this implementation. If, for some reasons, the control block
-  has not been fully initialized yet, the wrapper function either does not
-  do anything or, in the case when it perform a read/write operation, the
-  function do it directly through the system i/o functions.
+/******************************************************************************
+  Clock Key Cache Module
 
-  As we can see the model with which the key cache interface is supported
-  as quite conventional for interfaces in general.
-          
+  The module contains implementations of all key cache interface functions
+  employed by clock key caches.
+
+  Any request to a simple key cache, even one for a page that is in the
+  cache, locks cache_lock to look the page up and to relink its block in
+  the LRU chain. Under read mostly loads the threads queue on this mutex,
+  and a partitioned key cache only spreads them over a few mutexes: the
+  root pages of the indexes are still found in the same partitions.
+
+  A clock key cache serves requests for pages found in the cache without
+  locking anything:
+  - The hash chains of the blocks are changed only under cache_lock, but
+    they are read without it. A thread walking along a chain while a
+    block is moved to another chain may miss its page. It then repeats
+    the lookup under cache_lock.
+  - A thread uses a block only after it has incremented the pin count in
+    CLOCK_BLOCK::state. The increment fails if the block is not
+    CLOCK_VALID or is CLOCK_EXCLUSIVE. A block is assigned to another page
+    only after its state has been switched from 'valid and not pinned' to
+    CLOCK_EXCLUSIVE, so a pinned block whose file and position are those
+    of the request contains the requested page.
+  - A hit does not move the block in a list. It only sets the referenced
+    flag of the block, and does not even write it if it is set already.
+    To find a block for a new page the clock hand sweeps over the blocks,
+    clearing the referenced flags, until it finds an unpinned block that
+    has not been referenced since the previous sweep (second chance
+    replacement). A newly read page is not marked referenced, so that the
+    pages of a scan are replaced before the pages that are used again.
+  - Every request is counted in one of CLOCK_STRIPES stripes, chosen by
+    the id of the thread, so that a resize can wait until no thread reads
+    the hash chains or the blocks any more. The stripes also keep the
+    statistics, so that threads don't write the same cache line on every
+    hit.
+
+  Misses, writes and flushes lock cache_lock as they do in a simple key
+  cache. A thread that has to wait for a block to be read, written or
+  unpinned by another thread waits on the condition variable cond of the
+  key cache.
+
+  A clock key cache is not partitioned, and the parameters division_limit
+  and age_threshold of the midpoint insertion strategy do not apply to it.
 ******************************************************************************/
 
+/* The bits of CLOCK_BLOCK::state */
+#define CLOCK_PINS         0x00ffffff /* number of threads using the block   */
+#define CLOCK_VALID        0x01000000 /* the buffer contains the page        */
+#define CLOCK_EXCLUSIVE    0x02000000 /* block is being read or reassigned   */
+#define CLOCK_WANTED       0x04000000 /* a thread waits for the pins to go   */
+
+/* Number of counters for the requests in progress */
+#define CLOCK_STRIPES      64
+
+#define CLOCK_HASH(kc, f, pos)                                                \
+  (((ulong) ((pos) / (kc)->key_cache_block_size) + (ulong) (f)) &             \
+   ((kc)->hash_entries - 1))
+
+/* A block of a clock key cache */
+
+typedef struct st_clock_block
+{
+  struct st_clock_block *next_hash;    /* next block in the hash chain       */
+  struct st_clock_block *next_file;    /* next block in the file list        */
+  struct st_clock_block **prev_file;   /* previous link in the file list     */
+  uchar *buffer;                       /* buffer for the page                */
+  my_off_t diskpos;                    /* position of the page in the file   */
+  File file;                           /* file of the page                   */
+  int32 state;                         /* pin count and CLOCK_xxx flags      */
+  int32 referenced;                    /* block was used since last sweep    */
+  uint status;                         /* BLOCK_xxx flags, under cache_lock  */
+  uint updates;                        /* number of writers copying data     */
+  uint length;                         /* length of the data in the buffer   */
+  uint offset;                         /* beginning of the modified data     */
+} CLOCK_BLOCK;
+
+/* Requests in progress and statistics of the threads of one stripe */
+
+typedef struct st_clock_key_cache_stripe
+{
+  int32 requests;                      /* requests in progress               */
+  int64 cache_w_requests;              /* number of write requests           */
+  int64 cache_write;                   /* number of writes to files          */
+  int64 cache_r_requests;              /* number of read requests            */
+  int64 cache_read;                    /* number of reads from files         */
+  char pad[CPU_LEVEL1_DCACHE_LINESIZE];
+} CLOCK_KEY_CACHE_STRIPE;
+
+/* Control block for a clock key cache */
+
+typedef struct st_clock_key_cache_cb
+{
+  my_bool key_cache_inited;      /* <=> control block is allocated           */
+  my_bool can_be_used;           /* usage of cache for read/write is allowed */
+  int32 in_resize;               /* true during resize operation             */
+  size_t key_cache_mem_size;     /* specified size of the cache memory       */
+  uint key_cache_block_size;     /* size of the page buffer of a cache block */
+  uint hash_entries;             /* number of entries in the hash table      */
+  uint changed_blocks_hash_size; /* number of hash buckets for file blocks   */
+  int disk_blocks;               /* number of blocks in the cache            */
+  ulong blocks_used;           /* maximum number of concurrently used blocks */
+  ulong blocks_unused;           /* number of currently unused blocks        */
+  ulong blocks_changed;          /* number of currently dirty blocks         */
+  ulong clock_hand;              /* next block to look at for replacement    */
+  CLOCK_BLOCK **hash_root;       /* arr. of entries into hash table buckets  */
+  CLOCK_BLOCK *block_root;       /* memory for blocks                        */
+  CLOCK_BLOCK *free_block_list;  /* list of free blocks                      */
+  uchar *block_mem;              /* memory for block buffers                 */
+  CLOCK_BLOCK **changed_blocks;  /* hash for dirty file blocks               */
+  CLOCK_BLOCK **file_blocks;     /* hash for other file blocks               */
+  CLOCK_KEY_CACHE_STRIPE *stripes; /* requests and statistics               */
+  mysql_mutex_t cache_lock;      /* to lock access to the cache structure    */
+  mysql_cond_t cond;             /* to wait for blocks and for resize        */
+} CLOCK_KEY_CACHE_CB;
+
 static
-int repartition_key_cache_internal(KEY_CACHE *keycache,
-                                   uint key_cache_block_size, size_t use_mem,
-                                   uint division_limit, uint age_threshold,
-                                   uint changed_blocks_hash_size,
-                                   uint partitions, my_bool use_op_lock);
+void end_clock_key_cache(CLOCK_KEY_CACHE_CB *keycache, my_bool cleanup);
+
 
 /*
-  Initialize a key cache : internal
+  Initialize a clock key cache
 
   SYNOPSIS
-    init_key_cache_internal()
-    keycache           pointer to the key cache to be initialized
+    init_clock_key_cache()
+    keycache                pointer to the control block of a clock key cache
     key_cache_block_size    size of blocks to keep cached data
-    use_mem             total memory to use for cache buffers/structures 
-    division_limit      division limit (may be zero)
-    age_threshold       age threshold (may be zero)
-    changed_blocks_hash_size Number of hash buckets to hold a link of different
-                        files. Should be proportional to number of different
-                        files sused.
-    partitions          Number of partitions in the key cache
-    use_op_lock         if TRUE use keycache->op_lock, otherwise - ignore it
+    use_mem                 memory to use for the key cache buffers/structures
+    division_limit          not used
+    age_threshold           not used
+    changed_blocks_hash_size number of hash buckets for the files
 
   DESCRIPTION
-    The function performs the actions required from init_key_cache().
-    It has an additional parameter: use_op_lock. When the parameter
-    is TRUE than the function initializes keycache->op_lock if needed,
-    then locks it, and unlocks it before the return. Otherwise the actions
-    with the lock are omitted. 
+    This function is the implementation of the init_key_cache interface
+    function that is employed by clock key caches. All blocks of the new
+    key cache are put into the list of free blocks.
 
   RETURN VALUE
-    total number of blocks in key cache partitions, if successful,
+    number of blocks in the key cache, if successful,
     <= 0 - otherwise.
+*/
+
+static
+int init_clock_key_cache(CLOCK_KEY_CACHE_CB *keycache,
+                         uint key_cache_block_size,
+                         size_t use_mem,
+                         uint division_limit __attribute__((unused)),
+                         uint age_threshold __attribute__((unused)),
+                         uint changed_blocks_hash_size)
+{
+  ulong blocks, i;
+  uint stripe;
+  int error;
+  DBUG_ENTER("init_clock_key_cache");
+  DBUG_ASSERT(key_cache_block_size >= 512);
+
+  if (keycache->key_cache_inited && keycache->disk_blocks > 0)
+  {
+    DBUG_PRINT("warning",("key cache already in use"));
+    DBUG_RETURN(0);
+  }
+
+  if (!keycache->key_cache_inited)
+  {
+    /*
+      The mutex, the condition and the stripes must survive the
+      re-initialization during resizing.
+    */
+    if (!(keycache->stripes= (CLOCK_KEY_CACHE_STRIPE *)
+          my_malloc(sizeof(CLOCK_KEY_CACHE_STRIPE) * CLOCK_STRIPES,
+                    MYF(MY_ZEROFILL))))
+      DBUG_RETURN(0);
+    keycache->key_cache_inited= 1;
+    keycache->in_resize= 0;
+    mysql_mutex_init(key_KEY_CACHE_cache_lock,
+                     &keycache->cache_lock, MY_MUTEX_INIT_FAST);
+    mysql_cond_init(key_KEY_CACHE_cond, &keycache->cond, 0);
+  }
+
+  for (stripe= 0; stripe < CLOCK_STRIPES; stripe++)
+  {
+    CLOCK_KEY_CACHE_STRIPE *s= keycache->stripes + stripe;
+    s->cache_w_requests= s->cache_write= 0;
+    s->cache_r_requests= s->cache_read= 0;
+  }
+  keycache->blocks_used= keycache->blocks_unused= 0;
+  keycache->blocks_changed= 0;
+  keycache->disk_blocks= -1;
+  keycache->key_cache_mem_size= use_mem;
+  keycache->key_cache_block_size= key_cache_block_size;
+
+  blocks= (ulong) (use_mem / (sizeof(CLOCK_BLOCK) + 2 * sizeof(CLOCK_BLOCK*) +
+                              key_cache_block_size));
+
+  /* Changed blocks hash needs to be a power of 2 */
+  changed_blocks_hash_size=
+    my_round_up_to_next_power(MY_MAX(changed_blocks_hash_size,
+                                     MIN_CHANGED_BLOCKS_HASH_SIZE));
+
+  /* It doesn't make sense to have too few blocks (less than 8) */
+  if (blocks >= 8)
+  {
+    for ( ; ; )
+    {
+      keycache->hash_entries= my_round_up_to_next_power((uint32) blocks);
+      while ((ALIGN_SIZE(blocks * sizeof(CLOCK_BLOCK)) +
+              ALIGN_SIZE(sizeof(CLOCK_BLOCK*) * keycache->hash_entries) +
+              sizeof(CLOCK_BLOCK*) * (changed_blocks_hash_size * 2)) +
+             ((size_t) blocks * key_cache_block_size) > use_mem &&
+             blocks > 8)
+        blocks--;
+      /* Allocate memory for cache page buffers */
+      if ((keycache->block_mem=
+           my_large_malloc((size_t) blocks * key_cache_block_size, MYF(0))))
+      {
+        if (my_multi_malloc_large(MYF(MY_ZEROFILL),
+                                  &keycache->block_root,
+                                  (ulonglong) (blocks * sizeof(CLOCK_BLOCK)),
+                                  &keycache->hash_root,
+                                  (ulonglong) (sizeof(CLOCK_BLOCK*) *
+                                               keycache->hash_entries),
+                                  &keycache->changed_blocks,
+                                  (ulonglong) (sizeof(CLOCK_BLOCK*) *
+                                               changed_blocks_hash_size),
+                                  &keycache->file_blocks,
+                                  (ulonglong) (sizeof(CLOCK_BLOCK*) *
+                                               changed_blocks_hash_size),
+                                  NullS))
+          break;
+        my_large_free(keycache->block_mem);
+        keycache->block_mem= 0;
+      }
+      if (blocks < 8)
+      {
+        my_errno= ENOMEM;
+        my_error(EE_OUTOFMEMORY, MYF(ME_FATAL),
+                 blocks * key_cache_block_size);
+        goto err;
+      }
+      blocks= blocks / 4*3;
+    }
+
+    keycache->free_block_list= NULL;
+    for (i= blocks; i-- > 0; )
+    {
+      CLOCK_BLOCK *block= keycache->block_root + i;
+      block->buffer= keycache->block_mem + (size_t) i * key_cache_block_size;
+      block->next_hash= keycache->free_block_list;
+      keycache->free_block_list= block;
+    }
+    keycache->blocks_unused= blocks;
+    keycache->disk_blocks= (int) blocks;
+    keycache->clock_hand= 0;
+    keycache->changed_blocks_hash_size= changed_blocks_hash_size;
+    keycache->can_be_used= 1;
+    DBUG_PRINT("exit", ("disk_blocks: %d  hash_entries: %u",
+                        keycache->disk_blocks, keycache->hash_entries));
+  }
+  else
+  {
+    /* key_buffer_size is specified too small. Disable the cache. */
+    keycache->can_be_used= 0;
+  }
+  DBUG_RETURN(keycache->disk_blocks);
+
+err:
+  error= my_errno;
+  keycache->disk_blocks= 0;
+  if (keycache->block_mem)
+  {
+    my_large_free(keycache->block_mem);
+    keycache->block_mem= NULL;
+  }
+  my_errno= error;
+  keycache->can_be_used= 0;
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Choose the stripe for the requests of the current thread
+*/
+
+static inline
+CLOCK_KEY_CACHE_STRIPE *clock_stripe(CLOCK_KEY_CACHE_CB *keycache)
+{
+  struct st_my_thread_var *thread_var= my_thread_var;
+  return keycache->stripes +
+         (thread_var ? (uint) (thread_var->id % CLOCK_STRIPES) : 0);
+}
+
+#define clock_count(stripe, counter)                                          \
+  my_atomic_add64_explicit(&(stripe)->counter, 1, MY_MEMORY_ORDER_RELAXED)
+
+
+/*
+  Wake up all threads waiting in a clock key cache
+*/
+
+static void clock_signal(CLOCK_KEY_CACHE_CB *keycache)
+{
+  mysql_mutex_lock(&keycache->cache_lock);
+  mysql_cond_broadcast(&keycache->cond);
+  mysql_mutex_unlock(&keycache->cache_lock);
+}
+
+
+/*
+  Unregister a request to a clock key cache
 
   NOTES
-    if keycache->key_cache_inited != 0 we assume that the memory
-    for the control block of the key cache has been already allocated.
+    A resizer sets in_resize before it counts the requests in progress,
+    we decrement the count before we look at in_resize. So either the
+    resizer sees that this request has ended, or we see that it waits.
+*/
+
+static void clock_end_request(CLOCK_KEY_CACHE_CB *keycache,
+                              CLOCK_KEY_CACHE_STRIPE *stripe)
+{
+  my_atomic_add32(&stripe->requests, -1);
+  if (my_atomic_load32(&keycache->in_resize))
+    clock_signal(keycache);
+}
+
+
+/*
+  Register a request to a clock key cache
+
+  DESCRIPTION
+    The request is counted in the stripe of the thread, so that a resize
+    waits for it to end. If a resize is in progress, the function waits
+    until it has finished.
+
+  RETURN VALUE
+    the stripe to pass to clock_end_request()
 */
 
 static
-int init_key_cache_internal(KEY_CACHE *keycache, uint key_cache_block_size,
-		            size_t use_mem, uint division_limit,
-		            uint age_threshold, uint changed_blocks_hash_size,
-                            uint partitions,
-                            my_bool use_op_lock)
+CLOCK_KEY_CACHE_STRIPE *clock_start_request(CLOCK_KEY_CACHE_CB *keycache)
 {
-  void *keycache_cb;
-  int blocks;
-  if (keycache->key_cache_inited)
+  CLOCK_KEY_CACHE_STRIPE *stripe= clock_stripe(keycache);
+  for (;;)
   {
-    if (use_op_lock)
-      pthread_mutex_lock(&keycache->op_lock);
-    keycache_cb= keycache->keycache_cb;
+    my_atomic_add32(&stripe->requests, 1);
+    if (!my_atomic_load32(&keycache->in_resize))
+      return stripe;
+    clock_end_request(keycache, stripe);
+    mysql_mutex_lock(&keycache->cache_lock);
+    while (keycache->in_resize)
+      mysql_cond_wait(&keycache->cond, &keycache->cache_lock);
+    mysql_mutex_unlock(&keycache->cache_lock);
   }
-  else
+}
+
+
+/*
+  Pin a block that contains a valid page
+
+  RETURN VALUE
+    TRUE  if the block has been pinned
+    FALSE if the block is free, being read or being reassigned
+*/
+
+static inline my_bool clock_pin(CLOCK_BLOCK *block)
+{
+  int32 state= my_atomic_load32(&block->state);
+  do
+  {
+    if ((state & (CLOCK_VALID | CLOCK_EXCLUSIVE)) != CLOCK_VALID)
+      return FALSE;
+  } while (!my_atomic_cas32(&block->state, &state, state + 1));
+  return TRUE;
+}
+
+
+/*
+  Unpin a block
+
+  RETURN VALUE
+    TRUE if a thread waits for the block to be unpinned and must be woken up
+*/
+
+static inline my_bool clock_unpin(CLOCK_BLOCK *block)
+{
+  return (my_atomic_add32(&block->state, -1) &
+          (CLOCK_PINS | CLOCK_WANTED)) == (CLOCK_WANTED | 1);
+}
+
+
+/*
+  Get exclusive use of a block that is not pinned
+
+  DESCRIPTION
+    The function switches the state of a valid block to CLOCK_EXCLUSIVE.
+    If the block is in use by another thread, the block is marked as
+    CLOCK_WANTED and the function waits for it to be released.
+
+  RETURN VALUE
+    TRUE  if the block now is exclusive
+    FALSE if the function had to wait, the caller must look up the block
+          again
+*/
+
+static my_bool clock_lock_block(CLOCK_KEY_CACHE_CB *keycache,
+                                CLOCK_BLOCK *block)
+{
+  int32 state= my_atomic_load32(&block->state);
+  mysql_mutex_assert_owner(&keycache->cache_lock);
+  if ((state & ~CLOCK_WANTED) == CLOCK_VALID)
   {
-    if (partitions == 0)
+    if (my_atomic_cas32(&block->state, &state, CLOCK_EXCLUSIVE))
+      return TRUE;
+  }
+  else if ((state & CLOCK_EXCLUSIVE) ||
+           my_atomic_cas32(&block->state, &state, state | CLOCK_WANTED))
+    mysql_cond_wait(&keycache->cond, &keycache->cache_lock);
+  return FALSE;
+}
+
+
+/*
+  Link a block into a list of file blocks
+*/
+
+static void clock_link_to_list(CLOCK_BLOCK *block, CLOCK_BLOCK **phead)
+{
+  if ((block->next_file= *phead))
+    (*phead)->prev_file= &block->next_file;
+  *phead= block;
+  block->prev_file= phead;
+}
+
+
+/*
+  Unlink a block from its list of file blocks
+*/
+
+static void clock_unlink_from_list(CLOCK_BLOCK *block)
+{
+  if ((*block->prev_file= block->next_file))
+    block->next_file->prev_file= block->prev_file;
+  block->prev_file= NULL;
+}
+
+
+/*
+  Remove a block from the hash table and from its file list
+
+  NOTES
+    The link of the block to the next block in the hash chain is not
+    changed, so that threads reading the chain without the lock can go on.
+*/
+
+static void clock_unlink_block(CLOCK_KEY_CACHE_CB *keycache,
+                               CLOCK_BLOCK *block)
+{
+  CLOCK_BLOCK **prev= &keycache->hash_root[CLOCK_HASH(keycache, block->file,
+                                                      block->diskpos)];
+  mysql_mutex_assert_owner(&keycache->cache_lock);
+  while (*prev != block)
+    prev= &(*prev)->next_hash;
+  my_atomic_storeptr((void**) prev, block->next_hash);
+  clock_unlink_from_list(block);
+}
+
+
+/*
+  Put an exclusive block that is not in the hash table into the free list
+*/
+
+static void clock_free_block(CLOCK_KEY_CACHE_CB *keycache,
+                             CLOCK_BLOCK *block)
+{
+  mysql_mutex_assert_owner(&keycache->cache_lock);
+  my_atomic_store32(&block->state, 0);
+  block->status= 0;
+  my_atomic_storeptr_explicit((void**) &block->next_hash,
+                              keycache->free_block_list,
+                              MY_MEMORY_ORDER_RELAXED);
+  keycache->free_block_list= block;
+  keycache->blocks_unused++;
+  mysql_cond_broadcast(&keycache->cond);
+}
+
+
+/*
+  Write the modified part of a dirty block to its file
+
+  DESCRIPTION
+    The block must be pinned or exclusive, and no writer may be copying
+    data into it. Writers wait while the block is BLOCK_IN_FLUSHWRITE.
+    The cache_lock is released during the write.
+
+  RETURN VALUE
+    0 on success, 1 otherwise (the block stays dirty)
+*/
+
+static int clock_write_block(CLOCK_KEY_CACHE_CB *keycache,
+                             CLOCK_KEY_CACHE_STRIPE *stripe,
+                             CLOCK_BLOCK *block)
+{
+  int error;
+  DBUG_ASSERT(block->status & BLOCK_CHANGED);
+  DBUG_ASSERT(!block->updates);
+
+  block->status|= BLOCK_IN_FLUSHWRITE;
+  mysql_mutex_unlock(&keycache->cache_lock);
+  error= (int) my_pwrite(block->file, block->buffer + block->offset,
+                         block->length - block->offset,
+                         block->diskpos + block->offset,
+                         MYF(MY_NABP | MY_WAIT_IF_FULL));
+  mysql_mutex_lock(&keycache->cache_lock);
+  clock_count(stripe, cache_write);
+  block->status&= ~BLOCK_IN_FLUSHWRITE;
+  if (!error)
+  {
+    block->status&= ~BLOCK_CHANGED;
+    block->offset= keycache->key_cache_block_size;
+    keycache->blocks_changed--;
+    clock_unlink_from_list(block);
+    clock_link_to_list(block,
+                       &keycache->file_blocks[FILE_HASH(block->file,
+                                                        keycache)]);
+  }
+  /* Writers may wait for the write to be done */
+  mysql_cond_broadcast(&keycache->cond);
+  return error;
+}
+
+
+/*
+  Find a block to read a new page into
+
+  DESCRIPTION
+    A free block is taken if there is one. Otherwise the clock hand
+    sweeps over the blocks: a referenced block gets a second chance, the
+    first unpinned block that has not been referenced since the hand
+    passed it last time is replaced. A dirty block is written before.
+    If all blocks are in use, the function waits for the block under the
+    hand to be unpinned.
+    The cache_lock may be released meanwhile.
+
+  RETURN VALUE
+    an exclusive block that is not in the hash table, or
+    NULL if a dirty block could not be written
+*/
+
+static CLOCK_BLOCK *clock_find_victim(CLOCK_KEY_CACHE_CB *keycache,
+                                      CLOCK_KEY_CACHE_STRIPE *stripe)
+{
+  CLOCK_BLOCK *block;
+  mysql_mutex_assert_owner(&keycache->cache_lock);
+
+  for (;;)
+  {
+    ulong sweeps;
+
+    if ((block= keycache->free_block_list))
+    {
+      keycache->free_block_list= block->next_hash;
+      keycache->blocks_unused--;
+      set_if_bigger(keycache->blocks_used,
+                    keycache->disk_blocks - keycache->blocks_unused);
+      my_atomic_store32(&block->state, CLOCK_EXCLUSIVE);
+      return block;
+    }
+
+    /* The first round may only clear the referenced flags */
+    for (sweeps= 2 * (ulong) keycache->disk_blocks; sweeps; sweeps--)
+    {
+      block= keycache->block_root + keycache->clock_hand;
+      if (++keycache->clock_hand == (ulong) keycache->disk_blocks)
+        keycache->clock_hand= 0;
+      if ((my_atomic_load32(&block->state) & ~CLOCK_WANTED) != CLOCK_VALID)
+        continue;
+      if (my_atomic_load32_explicit(&block->referenced,
+                                    MY_MEMORY_ORDER_RELAXED))
+      {
+        my_atomic_store32_explicit(&block->referenced, 0,
+                                   MY_MEMORY_ORDER_RELAXED);
+        continue;
+      }
+      if (!clock_lock_block(keycache, block))
+        break;                               /* Waited, start anew */
+
+      if ((block->status & BLOCK_CHANGED) &&
+          clock_write_block(keycache, stripe, block))
+      {
+        my_atomic_store32(&block->state, CLOCK_VALID);
+        mysql_cond_broadcast(&keycache->cond);
+        return NULL;
+      }
+      clock_unlink_block(keycache, block);
+      return block;
+    }
+
+    if (!sweeps)
+    {
+      /* All blocks are in use: wait for the one under the hand */
+      block= keycache->block_root + keycache->clock_hand;
+      if (clock_lock_block(keycache, block))
+      {
+        /* It was released before we could wait */
+        my_atomic_store32(&block->state, CLOCK_VALID);
+      }
+    }
+  }
+}
+
+
+/*
+  Get a pinned block with the page of a file
+
+  SYNOPSIS
+    clock_get_block()
+    keycache            pointer to the control block of a clock key cache
+    stripe              stripe of the request
+    file                file of the page
+    filepos             position of the page in the file
+    page                if not NULL, the contents of the whole page, that
+                        is put into the block instead of reading it
+    min_length          at least so much data must be read from the file
+
+  DESCRIPTION
+    The function looks up the page under cache_lock. If the page is not in
+    the cache, it is read into a block found by clock_find_victim(). While
+    the page is being read, the block is in the hash table but exclusive,
+    so that other threads requesting the page wait for it.
+    The cache_lock may be released meanwhile.
+
+  RETURN VALUE
+    the pinned block, or
+    NULL on error
+*/
+
+static CLOCK_BLOCK *clock_get_block(CLOCK_KEY_CACHE_CB *keycache,
+                                    CLOCK_KEY_CACHE_STRIPE *stripe,
+                                    File file, my_off_t filepos,
+                                    const uchar *page, uint min_length)
+{
+  CLOCK_BLOCK *block, *victim= NULL, **start;
+  mysql_mutex_assert_owner(&keycache->cache_lock);
+
+  for (;;)
+  {
+    start= &keycache->hash_root[CLOCK_HASH(keycache, file, filepos)];
+    for (block= *start; block; block= block->next_hash)
+    {
+      if (block->diskpos == filepos && block->file == file)
+        break;
+    }
+    if (block)
+    {
+      if (victim)
+        clock_free_block(keycache, victim);
+      if (clock_pin(block))
+        return block;
+      /* The page is being read by another thread */
+      mysql_cond_wait(&keycache->cond, &keycache->cache_lock);
+      victim= NULL;
+      continue;
+    }
+    if (victim)
+      break;
+    /*
+      Another thread may read the page while we look for a block, so
+      look it up again before taking it.
+    */
+    if (!(victim= clock_find_victim(keycache, stripe)))
+      return NULL;
+  }
+
+  block= victim;
+  block->file= file;
+  block->diskpos= filepos;
+  block->status= 0;
+  block->length= 0;
+  block->offset= keycache->key_cache_block_size;
+  my_atomic_store32_explicit(&block->referenced, 0, MY_MEMORY_ORDER_RELAXED);
+  my_atomic_storeptr_explicit((void**) &block->next_hash, *start,
+                              MY_MEMORY_ORDER_RELAXED);
+  my_atomic_storeptr((void**) start, block);
+  clock_link_to_list(block,
+                     &keycache->file_blocks[FILE_HASH(file, keycache)]);
+
+  mysql_mutex_unlock(&keycache->cache_lock);
+  if (page)
+  {
+    memcpy(block->buffer, page, keycache->key_cache_block_size);
+    block->length= keycache->key_cache_block_size;
+  }
+  else
+  {
+    size_t got_length= my_pread(file, block->buffer,
+                                keycache->key_cache_block_size, filepos,
+                                MYF(0));
+    clock_count(stripe, cache_read);
+    if (got_length != (size_t) -1 && got_length >= min_length)
+      block->length= (uint) got_length;
+    else
+      block= NULL;
+  }
+  mysql_mutex_lock(&keycache->cache_lock);
+
+  if (!block)
+  {
+    clock_unlink_block(keycache, victim);
+    clock_free_block(keycache, victim);
+    return NULL;
+  }
+  my_atomic_store32(&block->state, CLOCK_VALID | 1);
+  mysql_cond_broadcast(&keycache->cond);
+  return block;
+}
+
+
+/*
+  Pin a block with the page of a file without locking the cache
+
+  RETURN VALUE
+    the pinned block, or
+    NULL if the page is not found, and must be looked up under cache_lock
+*/
+
+static CLOCK_BLOCK *clock_find_block(CLOCK_KEY_CACHE_CB *keycache,
+                                     File file, my_off_t filepos)
+{
+  CLOCK_BLOCK *block;
+  for (block= (CLOCK_BLOCK*)
+         my_atomic_loadptr((void**) &keycache->hash_root[CLOCK_HASH(keycache,
+                                                                    file,
+                                                                    filepos)]);
+       block;
+       block= (CLOCK_BLOCK*) my_atomic_loadptr((void**) &block->next_hash))
+  {
+    if (block->diskpos == filepos && block->file == file)
+    {
+      if (!clock_pin(block))
+        break;
+      /* The block may have been reassigned before we pinned it */
+      if (block->diskpos == filepos && block->file == file)
+      {
+        if (!my_atomic_load32_explicit(&block->referenced,
+                                       MY_MEMORY_ORDER_RELAXED))
+          my_atomic_store32_explicit(&block->referenced, 1,
+                                     MY_MEMORY_ORDER_RELAXED);
+        return block;
+      }
+      if (clock_unpin(block))
+        clock_signal(keycache);
+      break;
+    }
+  }
+  return NULL;
+}
+
+
+/*
+  Read a block of data from a clock key cache into a buffer
+
+  SYNOPSIS
+    clock_key_cache_read()
+    keycache            pointer to the control block of a clock key cache
+    file                handler for the file for the block of data to be read
+    filepos             position of the block of data in the file
+    level               not used
+    buff                buffer to where the data must be placed
+    length              length of the buffer
+    block_length        not used
+    return_buffer       not used
+
+  DESCRIPTION
+    This function is the implementation of the key_cache_read interface
+    function that is employed by clock key caches. The data is read in
+    key_cache_block_size increments. Pages found in the cache are copied
+    without taking cache_lock.
+
+  RETURN VALUE
+    Returns address from where the data is placed if successful, 0 - otherwise.
+*/
+
+static
+uchar *clock_key_cache_read(CLOCK_KEY_CACHE_CB *keycache,
+                            File file, my_off_t filepos,
+                            int level __attribute__((unused)),
+                            uchar *buff, uint length,
+                            uint block_length __attribute__((unused)),
+                            int return_buffer __attribute__((unused)))
+{
+  CLOCK_KEY_CACHE_STRIPE *stripe;
+  uchar *start= buff;
+  uint offset, read_length;
+  int error= 0;
+  DBUG_ENTER("clock_key_cache_read");
+  DBUG_PRINT("enter", ("fd: %u  pos: %lu  length: %u",
+               (uint) file, (ulong) filepos, length));
+
+  stripe= clock_start_request(keycache);
+  if (!keycache->can_be_used)
+  {
+    /* Key cache is not used */
+    clock_count(stripe, cache_r_requests);
+    clock_count(stripe, cache_read);
+    if (my_pread(file, buff, length, filepos, MYF(MY_NABP)))
+      error= 1;
+    goto end;
+  }
+
+  do
+  {
+    CLOCK_BLOCK *block;
+    /* Requested data may not always be aligned to cache blocks. */
+    offset= (uint) (filepos % keycache->key_cache_block_size);
+    read_length= MY_MIN(length, keycache->key_cache_block_size - offset);
+
+    clock_count(stripe, cache_r_requests);
+    if (!(block= clock_find_block(keycache, file, filepos - offset)))
+    {
+      mysql_mutex_lock(&keycache->cache_lock);
+      block= clock_get_block(keycache, stripe, file, filepos - offset,
+                             NULL, offset + read_length);
+      mysql_mutex_unlock(&keycache->cache_lock);
+      if (!block)
+      {
+        error= 1;
+        break;
+      }
+    }
+    if (block->length < offset + read_length)
+    {
+      /* A file with small key blocks is read beyond its end */
+      my_errno= -1;
+      error= 1;
+    }
+    else
+      memcpy(buff, block->buffer + offset, (size_t) read_length);
+    if (clock_unpin(block))
+      clock_signal(keycache);
+    if (error)
+      break;
+
+    buff+= read_length;
+    filepos+= read_length;
+  } while ((length-= read_length));
+
+end:
+  clock_end_request(keycache, stripe);
+  DBUG_PRINT("exit", ("error: %d", error ));
+  DBUG_RETURN(error ? (uchar*) 0 : start);
+}
+
+
+/*
+  Insert a block of file data from a buffer into a clock key cache
+
+  SYNOPSIS
+    clock_key_cache_insert()
+    keycache            pointer to the control block of a clock key cache
+    file                handler for the file to insert data from
+    filepos             position of the block of data in the file to insert
+    level               not used
+    buff                buffer to read data from
+    length              length of the data in the buffer
+
+  DESCRIPTION
+    This function is the implementation of the key_cache_insert interface
+    function that is employed by clock key caches. Pages that are in the
+    cache already are left as they are. A page that is supplied only
+    partly is read from the file.
+
+  RETURN VALUE
+    0 if a success, 1 - otherwise.
+*/
+
+static
+int clock_key_cache_insert(CLOCK_KEY_CACHE_CB *keycache,
+                           File file, my_off_t filepos,
+                           int level __attribute__((unused)),
+                           uchar *buff, uint length)
+{
+  CLOCK_KEY_CACHE_STRIPE *stripe;
+  uint offset, read_length;
+  int error= 0;
+  DBUG_ENTER("clock_key_cache_insert");
+  DBUG_PRINT("enter", ("fd: %u  pos: %lu  length: %u",
+               (uint) file,(ulong) filepos, length));
+
+  stripe= clock_start_request(keycache);
+  /* We do not load index data into a disabled cache */
+  if (keycache->can_be_used)
+  {
+    do
+    {
+      CLOCK_BLOCK *block;
+      my_bool whole_page;
+      offset= (uint) (filepos % keycache->key_cache_block_size);
+      read_length= MY_MIN(length, keycache->key_cache_block_size - offset);
+      whole_page= !offset && read_length == keycache->key_cache_block_size;
+
+      /* The block has been read by the caller already. */
+      clock_count(stripe, cache_read);
+      clock_count(stripe, cache_r_requests);
+      if (!(block= clock_find_block(keycache, file, filepos - offset)))
+      {
+        mysql_mutex_lock(&keycache->cache_lock);
+        block= clock_get_block(keycache, stripe, file, filepos - offset,
+                               whole_page ? buff : NULL,
+                               offset + read_length);
+        mysql_mutex_unlock(&keycache->cache_lock);
+        if (!block)
+        {
+          error= 1;
+          break;
+        }
+      }
+      if (clock_unpin(block))
+        clock_signal(keycache);
+
+      buff+= read_length;
+      filepos+= read_length;
+    } while ((length-= read_length));
+  }
+  clock_end_request(keycache, stripe);
+  DBUG_RETURN(error);
+}
+
+
+/*
+  Write a buffer into a clock key cache
+
+  SYNOPSIS
+    clock_key_cache_write()
+    keycache            pointer to the control block of a clock key cache
+    file                handler for the file to write data to
+    file_extra          not used
+    filepos             position in the file to write data to
+    level               not used
+    buff                buffer with the data
+    length              length of the buffer
+    block_length        not used
+    dont_write          if is 0 then the data is also written to the file
+
+  DESCRIPTION
+    This function is the implementation of the key_cache_write interface
+    function that is employed by clock key caches. The data is copied into
+    the blocks of the pages in key_cache_block_size increments. A page
+    that is only partly overwritten is read first if it is not in the
+    cache. The blocks are marked as dirty unless the data is written to
+    the file as well.
+
+  RETURN VALUE
+    0 if a success, 1 - otherwise.
+
+  NOTES
+    As for a simple key cache, locks outside of the key cache assure that
+    no other thread reads or writes the same data meanwhile.
+*/
+
+static
+int clock_key_cache_write(CLOCK_KEY_CACHE_CB *keycache,
+                          File file,
+                          void *file_extra __attribute__((unused)),
+                          my_off_t filepos,
+                          int level __attribute__((unused)),
+                          uchar *buff, uint length,
+                          uint block_length __attribute__((unused)),
+                          int dont_write)
+{
+  CLOCK_KEY_CACHE_STRIPE *stripe;
+  uint offset, read_length;
+  int error= 0;
+  DBUG_ENTER("clock_key_cache_write");
+  DBUG_PRINT("enter", ("fd: %u  pos: %lu  length: %u",
+               (uint) file, (ulong) filepos, length));
+
+  stripe= clock_start_request(keycache);
+  if (!keycache->can_be_used)
+  {
+    /* Key cache is not used */
+    clock_count(stripe, cache_w_requests);
+    clock_count(stripe, cache_write);
+    if (my_pwrite(file, buff, length, filepos, MYF(MY_NABP | MY_WAIT_IF_FULL)))
+      error= 1;
+    goto end;
+  }
+
+  do
+  {
+    CLOCK_BLOCK *block;
+    my_bool whole_page;
+    offset= (uint) (filepos % keycache->key_cache_block_size);
+    read_length= MY_MIN(length, keycache->key_cache_block_size - offset);
+    whole_page= !offset && read_length == keycache->key_cache_block_size;
+
+    clock_count(stripe, cache_w_requests);
+    mysql_mutex_lock(&keycache->cache_lock);
+    if (!(block= clock_get_block(keycache, stripe, file, filepos - offset,
+                                 whole_page ? buff : NULL, offset)))
+    {
+      mysql_mutex_unlock(&keycache->cache_lock);
+      error= 1;
+      break;
+    }
+    /*
+      Do not change the buffer while it is written to the file, the file
+      would get an unpredictable contents.
+    */
+    while (block->status & BLOCK_IN_FLUSHWRITE)
+      mysql_cond_wait(&keycache->cond, &keycache->cache_lock);
+    block->updates++;
+    mysql_mutex_unlock(&keycache->cache_lock);
+
+    memcpy(block->buffer + offset, buff, (size_t) read_length);
+    if (!dont_write)
+    {
+      /*
+        Not used in the server.
+        Write the data through while the block can neither be flushed nor
+        replaced, so that an older version of the page can't overwrite it.
+      */
+      clock_count(stripe, cache_write);
+      if (my_pwrite(file, buff, read_length, filepos,
+                    MYF(MY_NABP | MY_WAIT_IF_FULL)))
+        error= 1;
+    }
+
+    mysql_mutex_lock(&keycache->cache_lock);
+    if (!--block->updates && (block->status & BLOCK_IN_FLUSH))
+      mysql_cond_broadcast(&keycache->cond);
+    if (dont_write && !(block->status & BLOCK_CHANGED))
+    {
+      block->status|= BLOCK_CHANGED;
+      keycache->blocks_changed++;
+      clock_unlink_from_list(block);
+      clock_link_to_list(block,
+                         &keycache->changed_blocks[FILE_HASH(file,
+                                                             keycache)]);
+    }
+    if (dont_write)
+      set_if_smaller(block->offset, offset);
+    set_if_bigger(block->length, read_length + offset);
+    if (clock_unpin(block))
+      mysql_cond_broadcast(&keycache->cond);
+    mysql_mutex_unlock(&keycache->cache_lock);
+    if (error)
+      break;
+
+    buff+= read_length;
+    filepos+= read_length;
+  } while ((length-= read_length));
+
+end:
+  clock_end_request(keycache, stripe);
+  DBUG_RETURN(error);
+}
+
+
+static int cmp_clock_block(CLOCK_BLOCK **a, CLOCK_BLOCK **b)
+{
+  return (((*a)->diskpos < (*b)->diskpos) ? -1 :
+          ((*a)->diskpos > (*b)->diskpos) ? 1 : 0);
+}
+
+
+/*
+  Write all dirty blocks of a file in a clock key cache to the file
+
+  DESCRIPTION
+    The dirty blocks are collected in portions of FLUSH_CACHE blocks and
+    written in the order of their positions. A block that is being written
+    by another thread is waited for.
+
+  RETURN VALUE
+    0 on success, 1 otherwise
+*/
+
+static int clock_flush_file(CLOCK_KEY_CACHE_CB *keycache,
+                            CLOCK_KEY_CACHE_STRIPE *stripe, File file)
+{
+  CLOCK_BLOCK *cache_buff[FLUSH_CACHE], **end, **pos;
+  int error= 0;
+  mysql_mutex_assert_owner(&keycache->cache_lock);
+
+  for (;;)
+  {
+    CLOCK_BLOCK *block;
+    my_bool busy= FALSE;
+
+    end= cache_buff;
+    for (block= keycache->changed_blocks[FILE_HASH(file, keycache)];
+         block && end < cache_buff + FLUSH_CACHE;
+         block= block->next_file)
+    {
+      if (block->file != file)
+        continue;
+      if ((block->status & BLOCK_IN_FLUSH) || !clock_pin(block))
+        busy= TRUE;               /* In flush by another thread or evicted */
+      else
+      {
+        block->status|= BLOCK_IN_FLUSH;
+        *end++= block;
+      }
+    }
+    if (end == cache_buff)
+    {
+      if (!busy)
+        break;
+      mysql_cond_wait(&keycache->cond, &keycache->cache_lock);
+      continue;
+    }
+
+    my_qsort((uchar*) cache_buff, (size_t) (end - cache_buff),
+             sizeof(*cache_buff), (qsort_cmp) cmp_clock_block);
+    for (pos= cache_buff; pos < end; pos++)
+    {
+      block= *pos;
+      while (block->updates)
+        mysql_cond_wait(&keycache->cond, &keycache->cache_lock);
+      if ((block->status & BLOCK_CHANGED) &&
+          clock_write_block(keycache, stripe, block))
+        error= 1;
+      block->status&= ~BLOCK_IN_FLUSH;
+      clock_unpin(block);
+    }
+    /* Wake up the threads waiting for the blocks to be flushed or unpinned */
+    mysql_cond_broadcast(&keycache->cond);
+    if (error)
+      break;
+  }
+  return error;
+}
+
+
+/*
+  Remove all blocks of a file from a clock key cache
+
+  DESCRIPTION
+    Dirty blocks are dropped without writing them if ignore_changed is
+    set, and are left in the cache otherwise.
+*/
+
+static void clock_release_file(CLOCK_KEY_CACHE_CB *keycache, File file,
+                               my_bool ignore_changed)
+{
+  CLOCK_BLOCK **heads[2], *block;
+  uint i;
+  mysql_mutex_assert_owner(&keycache->cache_lock);
+
+  heads[0]= &keycache->file_blocks[FILE_HASH(file, keycache)];
+  heads[1]= &keycache->changed_blocks[FILE_HASH(file, keycache)];
+  for (i= 0; i < (ignore_changed ? 2U : 1U); i++)
+  {
+restart:
+    for (block= *heads[i]; block; block= block->next_file)
+    {
+      if (block->file != file)
+        continue;
+      if (!clock_lock_block(keycache, block))
+        goto restart;
+      if (block->status & BLOCK_CHANGED)
+        keycache->blocks_changed--;
+      clock_unlink_block(keycache, block);
+      clock_free_block(keycache, block);
+      goto restart;
+    }
+  }
+}
+
+
+/*
+  Flush all blocks for a file from a clock key cache
+
+  SYNOPSIS
+    flush_clock_key_cache_blocks()
+    keycache            pointer to the control block of a clock key cache
+    file                handler for the file to flush to
+    file_extra          not used
+    flush_type          type of the flush operation
+
+  DESCRIPTION
+    This function is the implementation of the flush_key_blocks interface
+    function that is employed by clock key caches. The dirty blocks of the
+    file are written unless the type is FLUSH_IGNORE_CHANGED. With
+    FLUSH_RELEASE and FLUSH_IGNORE_CHANGED the blocks of the file are
+    removed from the cache.
+
+  RETURN
+    0   ok
+    1  error
+*/
+
+static
+int flush_clock_key_cache_blocks(CLOCK_KEY_CACHE_CB *keycache,
+                                 File file,
+                                 void *file_extra __attribute__((unused)),
+                                 enum flush_type type)
+{
+  CLOCK_KEY_CACHE_STRIPE *stripe;
+  int res= 0;
+  DBUG_ENTER("flush_clock_key_cache_blocks");
+  DBUG_PRINT("enter", ("file: %d  blocks_used: %lu  blocks_changed: %lu",
+                       file, keycache->blocks_used, keycache->blocks_changed));
+
+  if (!keycache->key_cache_inited)
+    DBUG_RETURN(0);
+
+  stripe= clock_start_request(keycache);
+  if (keycache->can_be_used)
+  {
+    mysql_mutex_lock(&keycache->cache_lock);
+    if (type != FLUSH_IGNORE_CHANGED)
+      res= clock_flush_file(keycache, stripe, file);
+    if (!res && (type == FLUSH_RELEASE || type == FLUSH_IGNORE_CHANGED))
+      clock_release_file(keycache, file, type == FLUSH_IGNORE_CHANGED);
+    mysql_mutex_unlock(&keycache->cache_lock);
+  }
+  clock_end_request(keycache, stripe);
+  DBUG_RETURN(res);
+}
+
+
+/*
+  Resize a clock key cache
+
+  SYNOPSIS
+    resize_clock_key_cache()
+    keycache                pointer to the control block of a clock key cache
+    key_cache_block_size    size of blocks to keep cached data
+    use_mem                 memory to use for the key cache buffers/structures
+    division_limit          not used
+    age_threshold           not used
+    changed_blocks_hash_size number of hash buckets for the files
+
+  DESCRIPTION
+    This function is the implementation of the resize_key_cache interface
+    function that is employed by clock key caches. It waits until all
+    requests in progress are finished, new requests wait until the resize
+    is done. Then the dirty blocks are written, and the key cache is built
+    anew with the new parameters.
+
+  RETURN VALUE
+    number of blocks in the key cache, if successful,
+    0 - otherwise.
+*/
+
+static
+int resize_clock_key_cache(CLOCK_KEY_CACHE_CB *keycache,
+                           uint key_cache_block_size,
+                           size_t use_mem, uint division_limit,
+                           uint age_threshold, uint changed_blocks_hash_size)
+{
+  CLOCK_KEY_CACHE_STRIPE *stripe= clock_stripe(keycache);
+  int blocks= 0;
+  DBUG_ENTER("resize_clock_key_cache");
+  DBUG_ASSERT(keycache->key_cache_inited);
+
+  mysql_mutex_lock(&keycache->cache_lock);
+  while (keycache->in_resize)
+    mysql_cond_wait(&keycache->cond, &keycache->cache_lock);
+  my_atomic_store32(&keycache->in_resize, 1);
+
+  for (;;)
+  {
+    int32 requests= 0;
+    uint i;
+    for (i= 0; i < CLOCK_STRIPES; i++)
+      requests+= my_atomic_load32(&keycache->stripes[i].requests);
+    if (!requests)
+      break;
+    mysql_cond_wait(&keycache->cond, &keycache->cache_lock);
+  }
+
+  if (keycache->can_be_used)
+  {
+    uint i;
+    for (i= 0; i < keycache->changed_blocks_hash_size; i++)
+    {
+      while (keycache->changed_blocks[i])
+      {
+        if (clock_flush_file(keycache, stripe,
+                             keycache->changed_blocks[i]->file))
+        {
+          my_printf_error(0, "Could not flush changed key cache blocks "
+                          "on resize, the key cache is disabled",
+                          MYF(ME_WARNING | ME_ERROR_LOG_ONLY));
+          keycache->can_be_used= 0;
+          goto finish;
+        }
+      }
+    }
+  }
+
+  end_clock_key_cache(keycache, 0);
+  /* The following will work even if use_mem is 0 */
+  blocks= init_clock_key_cache(keycache, key_cache_block_size, use_mem,
+                               division_limit, age_threshold,
+                               changed_blocks_hash_size);
+
+finish:
+  my_atomic_store32(&keycache->in_resize, 0);
+  mysql_cond_broadcast(&keycache->cond);
+  mysql_mutex_unlock(&keycache->cache_lock);
+  DBUG_RETURN(blocks);
+}
+
+
+/*
+  Change key cache parameters of a clock key cache
+
+  DESCRIPTION
+    This function is the implementation of the change_key_cache_param
+    interface function that is employed by clock key caches. The
+    parameters of the midpoint insertion strategy do not apply to them,
+    so the function does nothing.
+*/
+
+static
+void change_clock_key_cache_param(CLOCK_KEY_CACHE_CB *keycache
+                                  __attribute__((unused)),
+                                  uint division_limit __attribute__((unused)),
+                                  uint age_threshold __attribute__((unused)))
+{
+}
+
+
+/*
+  Destroy a clock key cache
+
+  SYNOPSIS
+    end_clock_key_cache()
+    keycache                pointer to the control block of a clock key cache
+    cleanup                 <=> complete free (free also mutex for key cache)
+
+  DESCRIPTION
+    This function is the implementation of the end_key_cache interface
+    function that is employed by clock key caches. The function frees the
+    memory allocated for the key cache blocks and auxiliary structures. If
+    the value of the parameter cleanup is TRUE then the mutex, the
+    condition and the stripes of the key cache are freed too.
+
+  RETURN VALUE
+    none
+*/
+
+static
+void end_clock_key_cache(CLOCK_KEY_CACHE_CB *keycache, my_bool cleanup)
+{
+  DBUG_ENTER("end_clock_key_cache");
+  DBUG_PRINT("enter", ("key_cache: %p",  keycache));
+
+  if (!keycache->key_cache_inited)
+    DBUG_VOID_RETURN;
+
+  if (keycache->disk_blocks > 0)
+  {
+    my_large_free(keycache->block_mem);
+    keycache->block_mem= NULL;
+    my_free(keycache->block_root);
+    keycache->block_root= NULL;
+    keycache->disk_blocks= -1;
+    keycache->blocks_changed= 0;
+  }
+  keycache->blocks_used= 0;
+  keycache->blocks_unused= 0;
+
+  if (cleanup)
+  {
+    mysql_cond_destroy(&keycache->cond);
+    mysql_mutex_destroy(&keycache->cache_lock);
+    my_free(keycache->stripes);
+    keycache->stripes= NULL;
+    keycache->key_cache_inited= keycache->can_be_used= 0;
+  }
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Reset the counters of a clock key cache
+
+  SYNOPSIS
+    reset_clock_key_cache_counters()
+    name                the name of a key cache
+    keycache            pointer to the control block of a clock key cache
+
+  DESCRIPTION
+    This function is the implementation of the reset_key_cache_counters
+    interface function that is employed by clock key caches.
+
+  RETURN
+    0 on success (always because it can't fail)
+*/
+
+static
+int reset_clock_key_cache_counters(const char *name __attribute__((unused)),
+                                   CLOCK_KEY_CACHE_CB *keycache)
+{
+  uint i;
+  DBUG_ENTER("reset_clock_key_cache_counters");
+  if (!keycache->key_cache_inited)
+  {
+    DBUG_PRINT("info", ("Key cache %s not initialized.", name));
+    DBUG_RETURN(0);
+  }
+  DBUG_PRINT("info", ("Resetting counters for key cache %s.", name));
+
+  for (i= 0; i < CLOCK_STRIPES; i++)
+  {
+    CLOCK_KEY_CACHE_STRIPE *stripe= keycache->stripes + i;
+    my_atomic_store64(&stripe->cache_r_requests, 0); /* Key_read_requests */
+    my_atomic_store64(&stripe->cache_read, 0);       /* Key_reads */
+    my_atomic_store64(&stripe->cache_w_requests, 0); /* Key_write_requests */
+    my_atomic_store64(&stripe->cache_write, 0);      /* Key_writes */
+  }
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Get statistics for a clock key cache
+
+  SYNOPSIS
+    get_clock_key_cache_statistics()
+    keycache            pointer to the control block of a clock key cache
+    partition_no        partition number (not used)
+    key_cache_stats OUT pointer to the structure for the returned statistics
+
+  DESCRIPTION
+    This function is the implementation of the get_key_cache_statistics
+    interface function that is employed by clock key caches. The request
+    counters of all stripes are summed up. There are no warm blocks.
+
+  RETURN
+    none
+*/
+
+static
+void get_clock_key_cache_statistics(CLOCK_KEY_CACHE_CB *keycache,
+                                    uint partition_no __attribute__((unused)),
+                                    KEY_CACHE_STATISTICS *keycache_stats)
+{
+  uint i;
+  DBUG_ENTER("get_clock_key_cache_statistics");
+
+  keycache_stats->mem_size= (longlong) keycache->key_cache_mem_size;
+  keycache_stats->block_size= (longlong) keycache->key_cache_block_size;
+  keycache_stats->blocks_used= keycache->blocks_used;
+  keycache_stats->blocks_unused= keycache->blocks_unused;
+  keycache_stats->blocks_changed= keycache->blocks_changed;
+  keycache_stats->blocks_warm= 0;
+  keycache_stats->read_requests= keycache_stats->reads= 0;
+  keycache_stats->write_requests= keycache_stats->writes= 0;
+  for (i= 0; keycache->stripes && i < CLOCK_STRIPES; i++)
+  {
+    CLOCK_KEY_CACHE_STRIPE *stripe= keycache->stripes + i;
+    keycache_stats->read_requests+=
+      my_atomic_load64_explicit(&stripe->cache_r_requests,
+                                MY_MEMORY_ORDER_RELAXED);
+    keycache_stats->reads+=
+      my_atomic_load64_explicit(&stripe->cache_read, MY_MEMORY_ORDER_RELAXED);
+    keycache_stats->write_requests+=
+      my_atomic_load64_explicit(&stripe->cache_w_requests,
+                                MY_MEMORY_ORDER_RELAXED);
+    keycache_stats->writes+=
+      my_atomic_load64_explicit(&stripe->cache_write,
+                                MY_MEMORY_ORDER_RELAXED);
+  }
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  The array of pointers to the key cache interface functions used by
+  clock key caches.
+*/
+
+static KEY_CACHE_FUNCS clock_key_cache_funcs =
+{
+  (INIT_KEY_CACHE) init_clock_key_cache,
+  (RESIZE_KEY_CACHE) resize_clock_key_cache,
+  (CHANGE_KEY_CACHE_PARAM) change_clock_key_cache_param,
+  (KEY_CACHE_READ) clock_key_cache_read,
+  (KEY_CACHE_INSERT) clock_key_cache_insert,
+  (KEY_CACHE_WRITE) clock_key_cache_write,
+  (FLUSH_KEY_BLOCKS) flush_clock_key_cache_blocks,
+  (RESET_KEY_CACHE_COUNTERS) reset_clock_key_cache_counters,
+  (END_KEY_CACHE) end_clock_key_cache,
+  (GET_KEY_CACHE_STATISTICS) get_clock_key_cache_statistics,
+};
+
+
+/****************************************************************************** 
+  Key Cache Interface Module
+
+  The module contains wrappers for all key cache interface functions. 
+  
+  Currently there are key caches of three types: simple key caches,
+  partitioned key caches and clock key caches. Each type (class) has its own
+  implementation of the basic key cache operations used the MyISAM storage
+  engine. The pointers to the implementation functions are stored in three
+  static structures of the type KEY_CACHE_FUNC: simple_key_cache_funcs - for
+  simple key caches, partitioned_key_cache_funcs - for partitioned key caches,
+  and clock_key_cache_funcs - for clock key caches. When a key cache
+  object is created the constructor procedure init_key_cache places a pointer
+  to the corresponding table into one of its fields. The procedure also
+  initializes a control block for the key cache oject and saves the pointer
+  to this block in another field of the key cache object.
+  When a key cache wrapper function is invoked for a key cache object to
+  perform a basic key cache operation it looks into the interface table
+  associated with the key cache oject and calls the corresponding
+  implementation of the operation. It passes the saved key cache control
+  block to this implementation. If, for some reasons, the control block
+  has not been fully initialized yet, the wrapper function either does not
+  do anything or, in the case when it perform a read/write operation, the
+  function do it directly through the system i/o functions.
+
+  As we can see the model with which the key cache interface is supported
+  as quite conventional for interfaces in general.
+          
+******************************************************************************/
+
+static
+int repartition_key_cache_internal(KEY_CACHE *keycache,
+                                   uint key_cache_block_size, size_t use_mem,
+                                   uint division_limit, uint age_threshold,
+                                   uint changed_blocks_hash_size,
+                                   uint partitions, my_bool use_op_lock);
+
+/*
+  Get the size of the memory specified for the control block of a key cache
+*/
+
+static size_t key_cache_cb_mem_size(KEY_CACHE *keycache)
+{
+  switch (keycache->key_cache_type) {
+  case PARTITIONED_KEY_CACHE:
+    return ((PARTITIONED_KEY_CACHE_CB *) keycache->keycache_cb)->
+             key_cache_mem_size;
+  case CLOCK_KEY_CACHE:
+    return ((CLOCK_KEY_CACHE_CB *) keycache->keycache_cb)->key_cache_mem_size;
+  case SIMPLE_KEY_CACHE:
+    break;
+  }
+  return ((SIMPLE_KEY_CACHE_CB *) keycache->keycache_cb)->key_cache_mem_size;
+}
+
+
+/*
+  Check whether a key cache must be rebuilt to get the type and the
+  number of partitions requested by its parameters
+*/
+
+static my_bool key_cache_needs_repartition(KEY_CACHE *keycache)
+{
+  if (keycache->param_clock)
+    return keycache->key_cache_type != CLOCK_KEY_CACHE;
+  return keycache->key_cache_type == CLOCK_KEY_CACHE ||
+         (uint) keycache->param_partitions != keycache->partitions;
+}
+
+
+/*
+  Initialize a key cache : internal
+
+  SYNOPSIS
+    init_key_cache_internal()
+    keycache           pointer to the key cache to be initialized
+    key_cache_block_size    size of blocks to keep cached data
+    use_mem             total memory to use for cache buffers/structures 
+    division_limit      division limit (may be zero)
+    age_threshold       age threshold (may be zero)
+    changed_blocks_hash_size Number of hash buckets to hold a link of different
+                        files. Should be proportional to number of different
+                        files sused.
+    partitions          Number of partitions in the key cache
+    use_op_lock         if TRUE use keycache->op_lock, otherwise - ignore it
+
+  DESCRIPTION
+    The function performs the actions required from init_key_cache().
+    It has an additional parameter: use_op_lock. When the parameter
+    is TRUE than the function initializes keycache->op_lock if needed,
+    then locks it, and unlocks it before the return. Otherwise the actions
+    with the lock are omitted. 
+
+  RETURN VALUE
+    total number of blocks in key cache partitions, if successful,
+    <= 0 - otherwise.
+
+  NOTES
+    if keycache->key_cache_inited != 0 we assume that the memory
+    for the control block of the key cache has been already allocated.
+*/
+
+static
+int init_key_cache_internal(KEY_CACHE *keycache, uint key_cache_block_size,
+		            size_t use_mem, uint division_limit,
+		            uint age_threshold, uint changed_blocks_hash_size,
+                            uint partitions,
+                            my_bool use_op_lock)
+{
+  void *keycache_cb;
+  int blocks;
+  if (keycache->key_cache_inited)
+  {
+    if (use_op_lock)
+      pthread_mutex_lock(&keycache->op_lock);
+    keycache_cb= keycache->keycache_cb;
+  }
+  else
+  {
+    if (keycache->param_clock)
+    {
+      if (!(keycache_cb= (void *)  my_malloc(sizeof(CLOCK_KEY_CACHE_CB),
+                                             MYF(0))))
+        return 0;
+      ((CLOCK_KEY_CACHE_CB *) keycache_cb)->key_cache_inited= 0;
+      keycache->key_cache_type= CLOCK_KEY_CACHE;
+      keycache->interface_funcs= &clock_key_cache_funcs;
+    }
+    else if (partitions == 0)
     {
       if (!(keycache_cb= (void *)  my_malloc(sizeof(SIMPLE_KEY_CACHE_CB),
                                              MYF(0)))) 
@@ -5938,6 +7475,9 @@ int init_key_cache_internal(KEY_CACHE *keycache, uint key_cache_block_size,
       pthread_mutex_lock(&keycache->op_lock);
   }
 
+  /* A clock key cache is never partitioned */
+  if (keycache->key_cache_type == CLOCK_KEY_CACHE)
+    partitions= 0;
   if (partitions != 0)
   {
     ((PARTITIONED_KEY_CACHE_CB *) keycache_cb)->partitions= partitions;
@@ -5950,10 +7490,7 @@ int init_key_cache_internal(KEY_CACHE *keycache, uint key_cache_block_size,
                         ((PARTITIONED_KEY_CACHE_CB *) keycache_cb)->partitions :
                         0;
   DBUG_ASSERT(partitions <= MAX_KEY_CACHE_PARTITIONS);
-  keycache->key_cache_mem_size=
-    keycache->partitions ?
-    ((PARTITIONED_KEY_CACHE_CB *) keycache_cb)->key_cache_mem_size :
-    ((SIMPLE_KEY_CACHE_CB *) keycache_cb)->key_cache_mem_size;
+  keycache->key_cache_mem_size= key_cache_cb_mem_size(keycache);
   if (blocks > 0)
     keycache->can_be_used= 1;
   if (use_op_lock)
@@ -5979,7 +7516,8 @@ int init_key_cache_internal(KEY_CACHE *keycache, uint key_cache_block_size,
     places the pointer to this block in the structure keycache. 
     If the value of the parameter 'partitions' is 0 then a simple key cache
     is created. Otherwise a partitioned key cache with the specified number
-    of partitions is created.  
+    of partitions is created. If keycache->param_clock is set, a clock key
+    cache is created whatever the number of partitions is.
     The parameter key_cache_block_size specifies the size of the blocks in
     the key cache to be created. The parameters division_limit and
     age_threshold determine the initial values of those characteristics of
@@ -6051,7 +7589,7 @@ int resize_key_cache(KEY_CACHE *keycache, uint key_cache_block_size,
   if (keycache->key_cache_inited)
   {
     pthread_mutex_lock(&keycache->op_lock);
-    if ((uint) keycache->param_partitions != keycache->partitions && use_mem)
+    if (key_cache_needs_repartition(keycache) && use_mem)
       blocks= repartition_key_cache_internal(keycache,
                                              key_cache_block_size, use_mem,
                                              division_limit, age_threshold, 
@@ -6071,10 +7609,7 @@ int resize_key_cache(KEY_CACHE *keycache, uint key_cache_block_size,
           ((PARTITIONED_KEY_CACHE_CB *)(keycache->keycache_cb))->partitions;
     }
 
-    keycache->key_cache_mem_size=
-    keycache->partitions ?
-    ((PARTITIONED_KEY_CACHE_CB *)(keycache->keycache_cb))->key_cache_mem_size :
-    ((SIMPLE_KEY_CACHE_CB *)(keycache->keycache_cb))->key_cache_mem_size;
+    keycache->key_cache_mem_size= key_cache_cb_mem_size(keycache);
 
     keycache->can_be_used= (blocks >= 0);
     pthread_mutex_unlock(&keycache->op_lock);
@@ -28,6 +28,149 @@
 
 #define TRASH_MEM(X) TRASH_FREE(((char*)(X) + ((X)->size-(X)->left)), (X)->left)
 
+/*
+  Recycling of blocks of thread specific memory roots
+
+  The server registers a function that returns the block cache of the
+  current thread. Blocks of thread specific roots are returned to that
+  cache by free_root() and picked up again by the next alloc_root() of
+  the same thread that needs a new block, instead of going through
+  my_malloc() and my_free() every statement.
+*/
+
+static MEM_ROOT_BLOCK_CACHE *no_block_cache(void)
+{
+  return 0;
+}
+
+static MEM_ROOT_BLOCK_CACHE_CB get_block_cache= no_block_cache;
+
+void set_mem_root_block_cache_cb(MEM_ROOT_BLOCK_CACHE_CB func)
+{
+  get_block_cache= func ? func : no_block_cache;
+}
+
+
+void init_mem_root_block_cache(MEM_ROOT_BLOCK_CACHE *cache, size_t max_size)
+{
+  bzero(cache, sizeof(*cache));
+  cache->max_size= max_size;
+}
+
+
+/*
+  Free all cached blocks. The cache will not keep any new blocks
+  until max_size is set again.
+*/
+
+void free_mem_root_block_cache(MEM_ROOT_BLOCK_CACHE *cache)
+{
+  uint i;
+  for (i= 0; i < MEM_ROOT_BLOCK_CACHE_CLASSES; i++)
+  {
+    USED_MEM *block;
+    while ((block= cache->blocks[i]))
+    {
+      cache->blocks[i]= block->next;
+      my_free(block);
+    }
+  }
+  cache->size= cache->max_size= 0;
+}
+
+
+#if !(defined(HAVE_valgrind) && defined(EXTRA_DEBUG))
+/*
+  Size class of a block: the biggest n with MIN_BLOCK << n <= size, or
+  MEM_ROOT_BLOCK_CACHE_CLASSES if the block is not cached
+*/
+
+static inline uint block_cache_class(size_t size)
+{
+  uint n= 0;
+  if (size < MEM_ROOT_BLOCK_CACHE_MIN_BLOCK ||
+      size >= MEM_ROOT_BLOCK_CACHE_MAX_BLOCK * 2)
+    return MEM_ROOT_BLOCK_CACHE_CLASSES;
+  for (size>>= MEM_ROOT_BLOCK_CACHE_MIN_SHIFT + 1; size; size>>= 1)
+    n++;
+  return n;
+}
+
+
+/*
+  Get a new block of at least 'size' bytes for a memory root
+
+  Blocks of thread specific roots are taken from the block cache of the
+  thread, if there is one with a fitting block. The blocks in the size
+  class of the request may be smaller than it, the ones in the next
+  class are all big enough. Otherwise a block of exactly 'size' bytes
+  is allocated. block->size is set to the real size of the block.
+*/
+
+static USED_MEM *get_block(MEM_ROOT *root, size_t size, myf my_flags)
+{
+  USED_MEM *block;
+  MEM_ROOT_BLOCK_CACHE *cache;
+  uint n, last;
+
+  if ((root->block_size & 1) &&
+      size > MEM_ROOT_BLOCK_CACHE_MIN_BLOCK / 2 &&
+      (n= block_cache_class(MY_MAX(size, MEM_ROOT_BLOCK_CACHE_MIN_BLOCK))) <
+        MEM_ROOT_BLOCK_CACHE_CLASSES &&
+      (cache= get_block_cache()))
+  {
+    for (last= MY_MIN(n + 2, MEM_ROOT_BLOCK_CACHE_CLASSES); n < last; n++)
+    {
+      if ((block= cache->blocks[n]) && block->size >= size)
+      {
+        cache->blocks[n]= block->next;
+        cache->size-= block->size;
+        if (cache->reused)
+          (*cache->reused)++;
+        return block;                           /* block->size is set */
+      }
+    }
+    if (cache->allocated)
+      (*cache->allocated)++;
+  }
+  if ((block= (USED_MEM*) my_malloc(size, my_flags)))
+    block->size= size;
+  return block;
+}
+
+
+/* Return a block of a memory root to the block cache or free it */
+
+static void put_block(MEM_ROOT *root, USED_MEM *block)
+{
+  MEM_ROOT_BLOCK_CACHE *cache;
+  uint n;
+
+  if ((root->block_size & 1) &&
+      (n= block_cache_class(block->size)) < MEM_ROOT_BLOCK_CACHE_CLASSES &&
+      (cache= get_block_cache()) &&
+      cache->size + block->size <= cache->max_size)
+  {
+    block->next= cache->blocks[n];
+    cache->blocks[n]= block;
+    cache->size+= block->size;
+    return;
+  }
+  my_free(block);
+}
+#else
+/* Valgrind should see every block of the roots freed */
+static USED_MEM *get_block(MEM_ROOT *root __attribute__((unused)),
+                           size_t size, myf my_flags)
+{
+  USED_MEM *block;
+  if ((block= (USED_MEM*) my_malloc(size, my_flags)))
+    block->size= size;
+  return block;
+}
+#define put_block(root, block) my_free(block)
+#endif
+
 /*
   Initialize memory root
 
@@ -142,7 +285,7 @@ void reset_root_defaults(MEM_ROOT *mem_root, size_t block_size,
           /* remove block from the list and free it */
           *prev= mem->next;
           mem_root->total_alloc-= mem->size;
-          my_free(mem);
+          put_block(mem_root, mem);
         }
         else
           prev= &mem->next;
@@ -247,20 +390,18 @@ void *alloc_root(MEM_ROOT *mem_root, size_t length)
     get_size= length+ALIGN_SIZE(sizeof(USED_MEM));
     get_size= MY_MAX(get_size, block_size);
 
-    if (!(next = (USED_MEM*) my_malloc(get_size,
-                                       MYF(MY_WME | ME_FATAL |
-                                           MALLOC_FLAG(mem_root->
-                                                       block_size)))))
+    if (!(next= get_block(mem_root, get_size,
+                          MYF(MY_WME | ME_FATAL |
+                              MALLOC_FLAG(mem_root->block_size)))))
     {
       if (mem_root->error_handler)
 	(*mem_root->error_handler)();
       DBUG_RETURN((void*) 0);                      /* purecov: inspected */
     }
     mem_root->block_num++;
-    mem_root->total_alloc+= get_size;
+    mem_root->total_alloc+= next->size;
     next->next= *prev;
-    next->size= get_size;
-    next->left= get_size-ALIGN_SIZE(sizeof(USED_MEM));
+    next->left= next->size-ALIGN_SIZE(sizeof(USED_MEM));
     *prev=next;
     TRASH_MEM(next);
   }
@@ -416,7 +557,7 @@ void free_root(MEM_ROOT *root, myf MyFlags)
     if (old != root->pre_alloc)
     {
       root->total_alloc-= old->size;
-      my_free(old);
+      put_block(root, old);
     }
   }
   for (next=root->free ; next ;)
@@ -425,7 +566,7 @@ void free_root(MEM_ROOT *root, myf MyFlags)
     if (old != root->pre_alloc)
     {
       root->total_alloc-= old->size;
-      my_free(old);
+      put_block(root, old);
     }
   }
   root->used=root->free=0;
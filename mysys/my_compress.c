@@ -22,6 +22,12 @@
 #include <m_string.h>
 #endif
 #include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#ifndef ZSTD_CLEVEL_DEFAULT
+#define ZSTD_CLEVEL_DEFAULT 3
+#endif
+#endif
 
 /*
    This replaces the packet with a compressed packet
@@ -203,4 +209,261 @@ my_bool my_uncompress(uchar *packet, size_t len, size_t *complen)
   DBUG_RETURN(0);
 }
 
+
+/*
+  Compression of the client/server protocol packets
+
+  zlib compresses every packet with a new stream, as my_compress() does:
+  resetting a kept stream costs about as much as creating one. Creating a
+  zstd context costs more than compressing a typical packet, so every
+  thread keeps its zstd contexts in my_thread_var->compress_ctx. The
+  packets are still compressed independently of each other, as the
+  protocol requires.
+*/
+
+static size_t zlib_compress(int level, const uchar *from, size_t len,
+                            uchar *to)
+{
+  z_stream stream;
+  size_t complen;
+
+  if (level <= 0)
+    level= Z_DEFAULT_COMPRESSION;
+  else if (level > Z_BEST_COMPRESSION)
+    level= Z_BEST_COMPRESSION;
+
+  stream.zalloc= (alloc_func) my_az_allocator;
+  stream.zfree= (free_func) my_az_free;
+  stream.opaque= (voidpf) 0;
+  if (deflateInit(&stream, level) != Z_OK)
+    return 0;
+  stream.next_in= (Bytef*) from;
+  stream.avail_in= (uInt) len;
+  stream.next_out= (Bytef*) to;
+  stream.avail_out= (uInt) len - 1;
+  /* Z_OK or Z_BUF_ERROR if the data does not get shorter */
+  complen= deflate(&stream, Z_FINISH) == Z_STREAM_END ?
+           (size_t) stream.total_out : 0;
+  deflateEnd(&stream);
+  return complen;
+}
+
+
+static my_bool zlib_uncompress(const uchar *from, size_t len,
+                               uchar *to, size_t *complen)
+{
+  z_stream stream;
+  int error;
+
+  stream.zalloc= (alloc_func) my_az_allocator;
+  stream.zfree= (free_func) my_az_free;
+  stream.opaque= (voidpf) 0;
+  stream.next_in= (Bytef*) from;
+  stream.avail_in= (uInt) len;
+  if (inflateInit(&stream) != Z_OK)
+    return 1;
+  stream.next_out= (Bytef*) to;
+  stream.avail_out= (uInt) *complen;
+  error= inflate(&stream, Z_FINISH);
+  *complen= (size_t) stream.total_out;
+  inflateEnd(&stream);
+  if (error != Z_STREAM_END)
+  {
+    DBUG_PRINT("error",("Can't uncompress packet, error: %d", error));
+    return 1;
+  }
+  return 0;
+}
+
+
+#ifdef HAVE_ZSTD
+typedef struct st_my_compress_ctx
+{
+  ZSTD_CCtx *zstd_cctx;
+  ZSTD_DCtx *zstd_dctx;
+} MY_COMPRESS_CTX;
+
+
+static void compress_ctx_end(MY_COMPRESS_CTX *ctx)
+{
+  ZSTD_freeCCtx(ctx->zstd_cctx);
+  ZSTD_freeDCtx(ctx->zstd_dctx);
+}
+
+
+/*
+  The contexts of the current thread, or 'tmp' if the thread has not
+  called my_thread_init(). Then compress_ctx_release() frees it.
+*/
+
+static MY_COMPRESS_CTX *compress_ctx_get(MY_COMPRESS_CTX *tmp)
+{
+  struct st_my_thread_var *thr= my_thread_var;
+  if (thr)
+  {
+    if (!thr->compress_ctx)
+      thr->compress_ctx= my_malloc(sizeof(MY_COMPRESS_CTX),
+                                   MYF(MY_ZEROFILL));
+    if (thr->compress_ctx)
+      return (MY_COMPRESS_CTX*) thr->compress_ctx;
+  }
+  bzero(tmp, sizeof(*tmp));
+  return tmp;
+}
+
+
+static void compress_ctx_release(MY_COMPRESS_CTX *ctx, MY_COMPRESS_CTX *tmp)
+{
+  if (ctx == tmp)
+    compress_ctx_end(tmp);
+}
+
+
+static size_t zstd_compress(int level, const uchar *from, size_t len,
+                            uchar *to)
+{
+  MY_COMPRESS_CTX tmp, *ctx= compress_ctx_get(&tmp);
+  size_t res= 0;
+  if (level <= 0)
+    level= ZSTD_CLEVEL_DEFAULT;
+  else if (level > ZSTD_maxCLevel())
+    level= ZSTD_maxCLevel();
+  if (ctx->zstd_cctx || (ctx->zstd_cctx= ZSTD_createCCtx()))
+  {
+    /* An error also if the data does not get shorter */
+    res= ZSTD_compressCCtx(ctx->zstd_cctx, to, len - 1, from, len, level);
+    if (ZSTD_isError(res))
+      res= 0;
+  }
+  compress_ctx_release(ctx, &tmp);
+  return res;
+}
+
+
+static my_bool zstd_uncompress(const uchar *from, size_t len,
+                               uchar *to, size_t *complen)
+{
+  MY_COMPRESS_CTX tmp, *ctx= compress_ctx_get(&tmp);
+  size_t res;
+  my_bool error= 1;
+  if (ctx->zstd_dctx || (ctx->zstd_dctx= ZSTD_createDCtx()))
+  {
+    res= ZSTD_decompressDCtx(ctx->zstd_dctx, to, *complen, from, len);
+    if (ZSTD_isError(res))
+      DBUG_PRINT("error",("Can't uncompress packet: %s",
+                          ZSTD_getErrorName(res)));
+    else
+    {
+      *complen= res;
+      error= 0;
+    }
+  }
+  compress_ctx_release(ctx, &tmp);
+  return error;
+}
+#endif /* HAVE_ZSTD */
+
+
+void my_compress_ctx_free(void *ctx)
+{
+#ifdef HAVE_ZSTD
+  compress_ctx_end((MY_COMPRESS_CTX*) ctx);
+#endif
+  my_free(ctx);
+}
+
+
+my_bool my_compress_algorithm_supported(uint algorithm)
+{
+#ifdef HAVE_ZSTD
+  if (algorithm == MY_COMPRESS_ZSTD)
+    return 1;
+#endif
+  return algorithm == MY_COMPRESS_ZLIB;
+}
+
+
+/*
+  Compress a packet of the client/server protocol
+
+  SYNOPSIS
+    my_compress_packet()
+    algorithm   MY_COMPRESS_ZLIB or MY_COMPRESS_ZSTD
+    level       Compression level, 0 for the default of the algorithm
+    from        Data to compress
+    len         Length of data to compress at 'from'
+    to          Buffer of 'len' bytes for the compressed data
+
+  RETURN
+    0   The data was not compressed as it is too short, would not get
+        shorter, or because of an error
+    #   Length of the compressed data at 'to'
+*/
+
+size_t my_compress_packet(uint algorithm, int level,
+                          const uchar *from, size_t len, uchar *to)
+{
+  size_t complen;
+  DBUG_ENTER("my_compress_packet");
+  DBUG_ASSERT(my_compress_algorithm_supported(algorithm));
+
+  if (len < MIN_COMPRESS_LENGTH)
+  {
+    DBUG_PRINT("note",("Packet too short: Not compressed"));
+    DBUG_RETURN(0);
+  }
+#ifdef HAVE_ZSTD
+  if (algorithm == MY_COMPRESS_ZSTD)
+    complen= zstd_compress(level, from, len, to);
+  else
+#endif
+    complen= zlib_compress(level, from, len, to);
+  DBUG_RETURN(complen);
+}
+
+
+/*
+  Uncompress a packet of the client/server protocol
+
+  SYNOPSIS
+    my_uncompress_packet()
+    algorithm   MY_COMPRESS_ZLIB or MY_COMPRESS_ZSTD
+    packet      Compressed data. This is replaced with the original data.
+    len         Length of compressed data
+    complen     Length of the original data, 0 if the packet was not
+                compressed. The packet buffer must be big enough for it.
+
+  RETURN
+    1   error
+    0   ok.  In this case 'complen' contains the size of the real data.
+*/
+
+my_bool my_uncompress_packet(uint algorithm, uchar *packet, size_t len,
+                             size_t *complen)
+{
+  uchar *buff;
+  my_bool error;
+  DBUG_ENTER("my_uncompress_packet");
+  DBUG_ASSERT(my_compress_algorithm_supported(algorithm));
+
+  if (!*complen)                                /* Not compressed */
+  {
+    *complen= len;
+    DBUG_RETURN(0);
+  }
+
+  if (!(buff= (uchar*) my_malloc(*complen, MYF(MY_WME))))
+    DBUG_RETURN(1);                             /* Not enough memory */
+#ifdef HAVE_ZSTD
+  if (algorithm == MY_COMPRESS_ZSTD)
+    error= zstd_uncompress(packet, len, buff, complen);
+  else
+#endif
+    error= zlib_uncompress(packet, len, buff, complen);
+  if (!error)
+    memcpy(packet, buff, *complen);
+  my_free(buff);
+  DBUG_RETURN(error);
+}
+
 #endif /* HAVE_COMPRESS */
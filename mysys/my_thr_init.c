@@ -366,6 +366,13 @@ void my_thread_end(void)
       free(tmp->dbug);
       tmp->dbug=0;
     }
+#endif
+#ifdef HAVE_COMPRESS
+    if (tmp->compress_ctx)
+    {
+      my_compress_ctx_free(tmp->compress_ctx);
+      tmp->compress_ctx= 0;
+    }
 #endif
     my_thread_destory_thr_mutex(tmp);
 
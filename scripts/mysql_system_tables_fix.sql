@@ -727,6 +727,7 @@ ALTER TABLE help_topic MODIFY url TEXT NOT NULL;
 
 # MDEV-7383 - varbinary on mix/max of column_stats
 alter table column_stats modify min_value varbinary(255) DEFAULT NULL, modify max_value varbinary(255) DEFAULT NULL;
+alter table column_stats modify hist_type enum('SINGLE_PREC_HB','DOUBLE_PREC_HB','DOUBLE_PREC_MCV_HB');
 
 --
 -- Ensure that all tables are of type Aria and transactional
@@ -2249,7 +2249,7 @@ static int send_client_reply_packet(MCPVIO_EXT *mpvio,
     see end= buff+32 below, fixed size of the packet is 32 bytes.
      +9 because data is a length encoded binary where meta data size is max 9.
   */
-  buff_size= 33 + USERNAME_LENGTH + data_len + 9 + NAME_LEN + NAME_LEN + connect_attrs_len + 9;
+  buff_size= 33 + USERNAME_LENGTH + data_len + 9 + NAME_LEN + NAME_LEN + connect_attrs_len + 9 + 1;
   buff= my_alloca(buff_size);
 
   mysql->client_flag|= mysql->options.client_flag;
@@ -2270,6 +2270,19 @@ static int send_client_reply_packet(MCPVIO_EXT *mpvio,
   if (mpvio->db)
     mysql->client_flag|= CLIENT_CONNECT_WITH_DB;
 
+  /*
+    Use zstd instead of zlib if it is asked for and the server can do it,
+    otherwise stay with zlib
+  */
+  mysql->client_flag&= ~CLIENT_ZSTD_COMPRESSION_ALGORITHM;
+  if ((mysql->client_flag & CLIENT_COMPRESS) && mysql->options.extension &&
+      mysql->options.extension->compression_algorithm == MY_COMPRESS_ZSTD &&
+      (mysql->server_capabilities & CAN_CLIENT_ZSTD_COMPRESSION))
+  {
+    mysql->client_flag&= ~CLIENT_COMPRESS;
+    mysql->client_flag|= CLIENT_ZSTD_COMPRESSION_ALGORITHM;
+  }
+
   /* Remove options that server doesn't support */
   mysql->client_flag= mysql->client_flag &
                        (~(CLIENT_COMPRESS | CLIENT_SSL | CLIENT_PROTOCOL_41) 
@@ -2434,6 +2447,14 @@ static int send_client_reply_packet(MCPVIO_EXT *mpvio,
 
   end= (char *) send_client_connect_attrs(mysql, (uchar *) end);
 
+  if (mysql->client_flag & CLIENT_ZSTD_COMPRESSION_ALGORITHM)
+  {
+    /* MySQL servers want a valid level, 3 is the zstd default */
+    if (!mysql->options.extension->zstd_compression_level)
+      mysql->options.extension->zstd_compression_level= 3;
+    *end++= (char) mysql->options.extension->zstd_compression_level;
+  }
+
   /* Write authentication package */
   if (my_net_write(net, (uchar*) buff, (size_t) (end-buff)) || net_flush(net))
   {
@@ -3302,6 +3323,12 @@ CLI_MYSQL_REAL_CONNECT(MYSQL *mysql,const char *host, const char *user,
 
   if (mysql->client_flag & CLIENT_COMPRESS)      /* We will use compression */
     net->compress=1;
+  else if (mysql->client_flag & CLIENT_ZSTD_COMPRESSION_ALGORITHM)
+  {
+    net->compress=1;
+    net->compress_algorithm= MY_COMPRESS_ZSTD;
+    net->compress_level= (uchar) mysql->options.extension->zstd_compression_level;
+  }
 
   if (db && !mysql->db && mysql_select_db(mysql, db))
   {
@@ -4033,6 +4060,29 @@ mysql_options(MYSQL *mysql,enum mysql_option option, const void *arg)
   case MYSQL_OPT_USE_THREAD_SPECIFIC_MEMORY:
     mysql->options.use_thread_specific_memory= *(my_bool *) arg;
     break;
+  case MYSQL_OPT_COMPRESSION_ALGORITHM:
+    {
+      uint algorithm;
+      if (!strcmp(arg, "zlib"))
+        algorithm= MY_COMPRESS_ZLIB;
+      else if (!strcmp(arg, "zstd"))
+        algorithm= MY_COMPRESS_ZSTD;
+      else
+        DBUG_RETURN(1);
+      ENSURE_EXTENSIONS_PRESENT(&mysql->options);
+      if (!mysql->options.extension)
+        DBUG_RETURN(1);
+      mysql->options.extension->compression_algorithm= algorithm;
+    }
+    break;
+  case MYSQL_OPT_ZSTD_COMPRESSION_LEVEL:
+    if (*(uint*) arg < 1 || *(uint*) arg > 22)
+      DBUG_RETURN(1);
+    ENSURE_EXTENSIONS_PRESENT(&mysql->options);
+    if (!mysql->options.extension)
+      DBUG_RETURN(1);
+    mysql->options.extension->zstd_compression_level= *(uint*) arg;
+    break;
   case MYSQL_OPT_SSL_VERIFY_SERVER_CERT:
     if (*(my_bool*) arg)
       mysql->options.client_flag|= CLIENT_SSL_VERIFY_SERVER_CERT;
@@ -3388,6 +3388,17 @@ my_decimal* Field_new_decimal::val_decimal(my_decimal *decimal_value)
 }
 
 
+char *Field_new_decimal::val_text(char *to)
+{
+  ASSERT_COLUMN_MARKED_FOR_READ;
+  my_decimal decimal_value(ptr, precision, dec);
+  int length= FIELD_TEXT_BUFFER_LENGTH;
+  decimal2string(&decimal_value, to, &length, zerofill ? precision : 0, dec,
+                 '0');
+  return to + length;
+}
+
+
 int Field_new_decimal::cmp(const uchar *a,const uchar*b)
 {
   return memcmp(a, b, bin_size);
@@ -3705,6 +3716,16 @@ String *Field_tiny::val_str(String *val_buffer,
   return val_str_from_long(val_buffer, 5, -10, nr);
 }
 
+
+char *Field_tiny::val_text(char *to)
+{
+  ASSERT_COLUMN_MARKED_FOR_READ;
+  if (zerofill)
+    return NULL;
+  return int10_to_str(unsigned_flag ? (long) ptr[0] :
+                      (long) ((signed char*) ptr)[0], to, -10);
+}
+
 bool Field_tiny::send_binary(Protocol *protocol)
 {
   return protocol->store_tiny((longlong) (int8) ptr[0]);
@@ -3873,6 +3894,17 @@ String *Field_short::val_str(String *val_buffer,
 }
 
 
+char *Field_short::val_text(char *to)
+{
+  ASSERT_COLUMN_MARKED_FOR_READ;
+  if (zerofill)
+    return NULL;
+  short j= sint2korr(ptr);
+  return int10_to_str(unsigned_flag ? (long) (unsigned short) j : (long) j,
+                      to, -10);
+}
+
+
 bool Field_short::send_binary(Protocol *protocol)
 {
   return protocol->store_short(Field_short::val_int());
@@ -4047,6 +4079,16 @@ String *Field_medium::val_str(String *val_buffer,
 }
 
 
+char *Field_medium::val_text(char *to)
+{
+  ASSERT_COLUMN_MARKED_FOR_READ;
+  if (zerofill)
+    return NULL;
+  return int10_to_str(unsigned_flag ? (long) uint3korr(ptr) : sint3korr(ptr),
+                      to, -10);
+}
+
+
 String *Field_int::val_str_from_long(String *val_buffer,
                                      uint max_char_length,
                                      int radix, long nr)
@@ -4244,6 +4286,16 @@ String *Field_long::val_str(String *val_buffer,
 }
 
 
+char *Field_long::val_text(char *to)
+{
+  ASSERT_COLUMN_MARKED_FOR_READ;
+  if (zerofill)
+    return NULL;
+  return int10_to_str(unsigned_flag ? (long) uint4korr(ptr) : sint4korr(ptr),
+                      to, unsigned_flag ? 10 : -10);
+}
+
+
 bool Field_long::send_binary(Protocol *protocol)
 {
   ASSERT_COLUMN_MARKED_FOR_READ;
@@ -4389,6 +4441,15 @@ String *Field_longlong::val_str(String *val_buffer,
 }
 
 
+char *Field_longlong::val_text(char *to)
+{
+  ASSERT_COLUMN_MARKED_FOR_READ;
+  if (zerofill)
+    return NULL;
+  return longlong10_to_str(sint8korr(ptr), to, unsigned_flag ? 10 : -10);
+}
+
+
 bool Field_longlong::send_binary(Protocol *protocol)
 {
   ASSERT_COLUMN_MARKED_FOR_READ;
@@ -6530,12 +6591,20 @@ longlong Field_newdate::val_int(void)
 String *Field_newdate::val_str(String *val_buffer,
 			       String *val_ptr __attribute__((unused)))
 {
-  ASSERT_COLUMN_MARKED_FOR_READ;
   val_buffer->alloc(field_length);
   val_buffer->length(field_length);
+  val_text((char*) val_buffer->ptr());
+  val_buffer->set_charset(&my_charset_numeric);
+  return val_buffer;
+}
+
+
+char *Field_newdate::val_text(char *to)
+{
+  ASSERT_COLUMN_MARKED_FOR_READ;
   uint32 tmp=(uint32) uint3korr(ptr);
   int part;
-  char *pos=(char*) val_buffer->ptr()+10;
+  char *pos= to + 10;
 
   /* Open coded to get more speed */
   *pos--=0;					// End NULL
@@ -6552,8 +6621,7 @@ String *Field_newdate::val_str(String *val_buffer,
   *pos--= (char) ('0'+part%10); part/=10;
   *pos--= (char) ('0'+part%10); part/=10;
   *pos=   (char) ('0'+part);
-  val_buffer->set_charset(&my_charset_numeric);
-  return val_buffer;
+  return to + 10;
 }
 
 
@@ -6843,6 +6911,14 @@ String *Field_datetime_with_dec::val_str(String *str,
 }
 
 
+char *Field_datetime_with_dec::val_text(char *to)
+{
+  MYSQL_TIME ltime;
+  get_date(&ltime, date_mode_t(0));
+  return to + my_datetime_to_str(&ltime, to, dec);
+}
+
+
 bool Field_datetime_hires::get_TIME(MYSQL_TIME *ltime, const uchar *pos,
                                     date_mode_t fuzzydate) const
 {
@@ -7963,6 +8039,13 @@ void Field_varstring::hash(ulong *nr, ulong *nr2)
 
   Header is immediately followed by original data length,
   followed by compressed data.
+
+  If compression method is json:
+
+  Bits 1-4: format version, 0
+  Bits 5-8: store 9 (json)
+
+  Header is immediately followed by binary JSON, see json_binary.cc.
 */
 
 int Field_longstr::compress(char *to, uint to_length,
@@ -7998,7 +8081,8 @@ int Field_longstr::compress(char *to, uint to_length,
   if (buf_length == 0)
     *out_length= 0;
   else if (buf_length >= thd->variables.column_compression_threshold &&
-      (*out_length= compression_method()->compress(thd, to, buf, buf_length)))
+      (*out_length= compression_method()->compress(thd, to, buf, buf_length,
+                                                   field_charset)))
     status_var_increment(thd->status_var.column_compressions);
   else
   {
@@ -8021,6 +8105,33 @@ int Field_longstr::compress(char *to, uint to_length,
 }
 
 
+Compression_method *Field::compression_method(utype unireg_check_arg)
+{
+  switch (unireg_check_arg) {
+  case TMYSQL_COMPRESSED:
+    return zlib_compression_method;
+  case JSON_COMPRESSED:
+    return json_compression_method;
+  default:
+    return NULL;
+  }
+}
+
+
+void Field_longstr::sql_type_compressed(String &str,
+                                        const Compression_method *method)
+{
+  if (method == zlib_compression_method)
+    str.append(STRING_WITH_LEN(" /*!100301 COMPRESSED*/"));
+  else
+  {
+    str.append(STRING_WITH_LEN(" /*!100402 COMPRESSED="));
+    str.append(method->name, strlen(method->name));
+    str.append(STRING_WITH_LEN("*/"));
+  }
+}
+
+
 /*
   Memory is allocated only when original data was actually compressed.
   Otherwise val_ptr points at data located immediately after header.
@@ -10657,11 +10768,9 @@ Column_definition::Column_definition(THD *thd, Field *old_field,
   {
     default_value= orig_field->default_value;
     check_constraint= orig_field->check_constraint;
-    if (orig_field->unireg_check == Field::TMYSQL_COMPRESSED)
-    {
-      unireg_check= Field::TMYSQL_COMPRESSED;
-      compression_method_ptr= zlib_compression_method;
-    }
+    if ((compression_method_ptr=
+           Field::compression_method(orig_field->unireg_check)))
+      unireg_check= orig_field->unireg_check;
   }
   else
   {
@@ -10818,6 +10927,12 @@ bool Column_definition::set_compressed(const char *method)
       compression_method_ptr= zlib_compression_method;
       return false;
     }
+    if (!strcmp(method, json_compression_method->name))
+    {
+      unireg_check= Field::JSON_COMPRESSED;
+      compression_method_ptr= json_compression_method;
+      return false;
+    }
     my_error(ER_UNKNOWN_COMPRESSION_METHOD, MYF(0), method);
   }
   else
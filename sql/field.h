@@ -415,6 +415,12 @@ class Value_source
 };
 
 
+/*
+  The longest text of Field::val_text(): a negative DECIMAL(65,38) value
+  and the terminating '\0'
+*/
+#define FIELD_TEXT_BUFFER_LENGTH (DECIMAL_MAX_STR_LENGTH + 1)
+
 #define STORAGE_TYPE_MASK 7
 #define COLUMN_FORMAT_MASK 7
 #define COLUMN_FORMAT_SHIFT 3
@@ -680,6 +686,7 @@ class Field: public Value_source
     TIMESTAMP_UN_FIELD=22,      // TIMESTAMP ON UPDATE NOW()
     TIMESTAMP_DNUN_FIELD=23,    // TIMESTAMP DEFAULT NOW() ON UPDATE NOW()
     TMYSQL_COMPRESSED= 24,      // Compatibility with TMySQL
+    JSON_COMPRESSED= 25,        // COMPRESSED=json
     };
   enum geometry_type
   {
@@ -1337,6 +1344,13 @@ class Field: public Value_source
     ptr= old_ptr;
     return str;
   }
+  /*
+    Print the value as val_str() would, into a buffer of at least
+    FIELD_TEXT_BUFFER_LENGTH bytes. Returns the end of the text, or NULL
+    if the field type does not support this and val_str() is to be used.
+    The text is ASCII in my_charset_numeric.
+  */
+  virtual char *val_text(char *to) { return NULL; }
   virtual bool send_binary(Protocol *protocol);
 
   virtual uchar *pack(uchar *to, const uchar *from, uint max_length);
@@ -1655,6 +1669,17 @@ class Field: public Value_source
   void register_field_in_read_map();
 
   virtual Compression_method *compression_method() const { return 0; }
+  static Compression_method *compression_method(utype unireg_check_arg);
+  /*
+    The stored value of a compressed field: the compression header byte
+    followed by the compressed or the plain data.
+  */
+  virtual LEX_CUSTRING compressed_image() const
+  {
+    DBUG_ASSERT(0);
+    LEX_CUSTRING res= {0, 0};
+    return res;
+  }
 
   virtual Virtual_tmp_table **virtual_tmp_table_addr()
   {
@@ -1910,6 +1935,7 @@ class Field_longstr :public Field_str
                CHARSET_INFO *cs, size_t nchars);
   String *uncompress(String *val_buffer, String *val_ptr,
                      const uchar *from, uint from_length);
+  static void sql_type_compressed(String &str, const Compression_method *method);
 public:
   Field_longstr(uchar *ptr_arg, uint32 len_arg, uchar *null_ptr_arg,
                 uchar null_bit_arg, utype unireg_check_arg,
@@ -2096,6 +2122,7 @@ class Field_new_decimal :public Field_num {
     return my_decimal(ptr, precision, dec).
              to_string(val_buffer, fixed_precision, dec, '0');
   }
+  char *val_text(char *to);
   bool get_date(MYSQL_TIME *ltime, date_mode_t fuzzydate)
   {
     my_decimal nr(ptr, precision, dec);
@@ -2208,6 +2235,7 @@ class Field_tiny :public Field_int
   double val_real(void);
   longlong val_int(void);
   String *val_str(String*,String *);
+  char *val_text(char *to);
   bool send_binary(Protocol *protocol);
   int cmp(const uchar *,const uchar *);
   void sort_string(uchar *buff,uint length);
@@ -2261,6 +2289,7 @@ class Field_short :public Field_int
   double val_real(void);
   longlong val_int(void);
   String *val_str(String*,String *);
+  char *val_text(char *to);
   bool send_binary(Protocol *protocol);
   int cmp(const uchar *,const uchar *);
   void sort_string(uchar *buff,uint length);
@@ -2298,6 +2327,7 @@ class Field_medium :public Field_int
   double val_real(void);
   longlong val_int(void);
   String *val_str(String*,String *);
+  char *val_text(char *to);
   bool send_binary(Protocol *protocol);
   int cmp(const uchar *,const uchar *);
   void sort_string(uchar *buff,uint length);
@@ -2341,6 +2371,7 @@ class Field_long :public Field_int
   longlong val_int(void);
   bool send_binary(Protocol *protocol);
   String *val_str(String*,String *);
+  char *val_text(char *to);
   int cmp(const uchar *,const uchar *);
   void sort_string(uchar *buff,uint length);
   uint32 pack_length() const { return 4; }
@@ -2393,6 +2424,7 @@ class Field_longlong :public Field_int
   double val_real(void);
   longlong val_int(void);
   String *val_str(String*,String *);
+  char *val_text(char *to);
   bool send_binary(Protocol *protocol);
   int cmp(const uchar *,const uchar *);
   void sort_string(uchar *buff,uint length);
@@ -2983,6 +3015,7 @@ class Field_year :public Field_tiny {
   double val_real(void);
   longlong val_int(void);
   String *val_str(String*,String *);
+  char *val_text(char *to) { return NULL; }    // Printed with 2 or 4 digits
   bool get_date(MYSQL_TIME *ltime, date_mode_t fuzzydate);
   bool send_binary(Protocol *protocol);
   Information_schema_numeric_attributes
@@ -3072,6 +3105,7 @@ class Field_newdate :public Field_date_common
   double val_real(void);
   longlong val_int(void);
   String *val_str(String*,String *);
+  char *val_text(char *to);
   bool send_binary(Protocol *protocol);
   int cmp(const uchar *,const uchar *);
   void sort_string(uchar *buff,uint length);
@@ -3344,6 +3378,7 @@ class Field_datetime_with_dec :public Field_datetime {
   double val_real(void);
   longlong val_int(void);
   String *val_str(String*,String *);
+  char *val_text(char *to);
 };
 
 
@@ -3676,7 +3711,12 @@ class Field_varstring_compressed: public Field_varstring {
   void sql_type(String &str) const
   {
     Field_varstring::sql_type(str);
-    str.append(STRING_WITH_LEN(" /*!100301 COMPRESSED*/"));
+    sql_type_compressed(str, compression_method_ptr);
+  }
+  LEX_CUSTRING compressed_image() const
+  {
+    LEX_CUSTRING res= {get_data(), get_length()};
+    return res;
   }
   uint32 max_display_length() const { return field_length - 1; }
   uint32 character_octet_length() const { return field_length - 1; }
@@ -4013,7 +4053,12 @@ class Field_blob_compressed: public Field_blob {
   void sql_type(String &str) const
   {
     Field_blob::sql_type(str);
-    str.append(STRING_WITH_LEN(" /*!100301 COMPRESSED*/"));
+    sql_type_compressed(str, compression_method_ptr);
+  }
+  LEX_CUSTRING compressed_image() const
+  {
+    LEX_CUSTRING res= {get_ptr(), get_length()};
+    return res;
   }
 
   /*
@@ -18,6 +18,7 @@
 #include "sql_string.h"
 #include "sql_class.h"
 #include "field_comp.h"
+#include "json_binary.h"
 #include <zlib.h>
 
 
@@ -27,6 +28,7 @@
   @param[out]    to         destination buffer for compressed data
   @param[in]     from       data to compress
   @param[in]     length     from length
+  @param[in]     cs         character set of the data
 
   Requirement is such that string stored at `to' must not exceed `from' length.
   Otherwise 0 is returned and caller stores string uncompressed.
@@ -37,7 +39,8 @@
   least 2 bytes required to store metadata.
 */
 
-static uint compress_zlib(THD *thd, char *to, const char *from, uint length)
+static uint compress_zlib(THD *thd, char *to, const char *from, uint length,
+                          CHARSET_INFO *cs)
 {
   uint level= thd->variables.column_compression_zlib_level;
 
@@ -140,7 +143,7 @@ Compression_method compression_methods[MAX_COMPRESSION_METHODS]=
   { 0, 0, 0 },
   { 0, 0, 0 },
   { "zlib", compress_zlib, uncompress_zlib },
-  { 0, 0, 0 },
+  { "json", compress_json, uncompress_json },
   { 0, 0, 0 },
   { 0, 0, 0 },
   { 0, 0, 0 },
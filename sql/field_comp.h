@@ -21,7 +21,8 @@
 struct Compression_method
 {
   const char *name;
-  uint (*compress)(THD *thd, char *to, const char *from, uint length);
+  uint (*compress)(THD *thd, char *to, const char *from, uint length,
+                   CHARSET_INFO *cs);
   int (*uncompress)(String *to, const uchar *from, uint from_length,
                     uint field_length);
 };
@@ -29,5 +30,6 @@ struct Compression_method
 
 extern Compression_method compression_methods[MAX_COMPRESSION_METHODS];
 #define zlib_compression_method (&compression_methods[8])
+#define json_compression_method (&compression_methods[9])
 
 #endif
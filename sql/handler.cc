@@ -4827,6 +4827,9 @@ void handler::get_dynamic_partition_info(PARTITION_STATS *stat_info,
 
 /*
   Updates the global table stats with the TABLE this handler represents
+
+  The rows changed are also counted in the TABLE for ANALYZE TABLE,
+  see statistics_are_up_to_date()
 */
 
 void handler::update_global_table_stats()
@@ -4836,6 +4839,9 @@ void handler::update_global_table_stats()
   status_var_add(table->in_use->status_var.rows_read, rows_read);
   DBUG_ASSERT(rows_tmp_read == 0);
 
+  my_atomic_add64_explicit(&table->stats_rows_changed, (int64) rows_changed,
+                           MY_MEMORY_ORDER_RELAXED);
+
   if (!table->in_use->userstat_running)
   {
     rows_read= rows_changed= 0;
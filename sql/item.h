@@ -112,6 +112,7 @@ struct SARGABLE_PARAM;
 class RANGE_OPT_PARAM;
 class SEL_TREE;
 class With_sum_func_cache;
+class Expr_program_builder;
 
 enum precedence {
   LOWEST_PRECEDENCE,
@@ -1685,6 +1686,12 @@ class Item: public Value_source,
   {
     return false;
   }
+  /*
+    Add the native instructions of the item to a program, see
+    sql_expr_program.h. Return the register with the value, of the
+    type of cmp_type(), or -1 to have the program call val_*() of the item.
+  */
+  virtual int expr_program_add(Expr_program_builder *prog) { return -1; }
   virtual void split_sum_func(THD *thd, Ref_ptr_array ref_pointer_array,
                               List<Item> &fields, uint flags) {}
   /* Called for items that really have to be split */
@@ -3356,6 +3363,7 @@ class Item_field :public Item_ident,
   bool get_date_result(THD *thd, MYSQL_TIME *ltime,date_mode_t fuzzydate);
   bool is_null() { return field->is_null(); }
   void update_null_value();
+  int expr_program_add(Expr_program_builder *prog);
   void update_table_bitmaps()
   {
     if (field && field->table)
@@ -6588,6 +6596,12 @@ class Item_cache_int: public Item_cache
   bool get_date(THD *thd, MYSQL_TIME *ltime, date_mode_t fuzzydate)
   { return get_date_from_int(thd, ltime, fuzzydate); }
   bool cache_value();
+  void set_value(longlong nr, bool is_null)
+  {
+    value= nr;
+    null_value= is_null;
+    value_cached= TRUE;
+  }
   int save_in_field(Field *field, bool no_conversions);
   Item *convert_to_basic_const_item(THD *thd);
   Item *get_copy(THD *thd)
@@ -6784,6 +6798,12 @@ class Item_cache_real: public Item_cache
   bool get_date(THD *thd, MYSQL_TIME *ltime, date_mode_t fuzzydate)
   { return get_date_from_real(thd, ltime, fuzzydate); }
   bool cache_value();
+  void set_value(double nr, bool is_null)
+  {
+    value= nr;
+    null_value= is_null;
+    value_cached= TRUE;
+  }
   Item *convert_to_basic_const_item(THD *thd);
   Item *get_copy(THD *thd)
   { return get_item_copy<Item_cache_real>(thd, this); }
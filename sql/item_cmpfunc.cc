@@ -3610,8 +3610,67 @@ static int cmp_decimal(void *cmp_arg, my_decimal *a, my_decimal *b)
 bool in_vector::find(Item *item)
 {
   uchar *result=get_value(item);
-  if (!result || !used_count)
+  if (!result)
     return false;				// Null value
+  return find_value(result);
+}
+
+
+/*
+  A mix of all the bits of nr, as the low bits of the hash address the
+  hash table.
+*/
+
+static inline ulong hash_longlong(ulonglong nr)
+{
+  nr^= nr >> 33;
+  nr*= 0xff51afd7ed558ccdULL;
+  nr^= nr >> 33;
+  return (ulong) nr;
+}
+
+
+void in_vector::sort()
+{
+  my_qsort2(base,used_count,size,compare,(void*)collation);
+  hash_table= 0;
+  if (used_count < HASH_MIN_ELEMENTS || !has_hash_value())
+    return;
+
+  uint hash_size= 1;
+  while (hash_size < used_count * 2)
+    hash_size<<= 1;
+  if (!(hash_table= (uint*) thd_calloc(current_thd, hash_size * sizeof(uint))))
+    return;                                     // Bisect then
+  hash_mask= hash_size - 1;
+  for (uint i= 0; i < used_count; i++)
+  {
+    /* The equal values are adjacent, the first of them is enough */
+    if (i && !compare_elems(i, i - 1))
+      continue;
+    uint pos= (uint) hash_value((uchar*) base + i * size) & hash_mask;
+    while (hash_table[pos])
+      pos= (pos + 1) & hash_mask;
+    hash_table[pos]= i + 1;
+  }
+}
+
+
+bool in_vector::find_value(const uchar *result)
+{
+  if (hash_table)
+  {
+    for (uint pos= (uint) hash_value(result) & hash_mask; hash_table[pos];
+         pos= (pos + 1) & hash_mask)
+    {
+      if (!(*compare)(collation, base + (hash_table[pos] - 1) * size, result))
+        return true;
+    }
+    return false;
+  }
+
+  if (!used_count)
+    return false;
 
   uint start,end;
   start=0; end=used_count-1;
@@ -3678,6 +3737,17 @@ Item *in_string::create_item(THD *thd)
   return new (thd->mem_root) Item_string_for_in_vector(thd, collation);
 }
 
+/* hash_sort() agrees with the strnncollsp() that srtcmp_in() uses */
+
+ulong in_string::hash_value(const uchar *value) const
+{
+  const String *str= (const String*) value;
+  ulong nr1= 1, nr2= 4;
+  collation->coll->hash_sort(collation, (const uchar*) str->ptr(),
+                             str->length(), &nr1, &nr2);
+  return nr1;
+}
+
 
 in_row::in_row(THD *thd, uint elements, Item * item)
 {
@@ -3745,6 +3815,16 @@ Item *in_longlong::create_item(THD *thd)
   return new (thd->mem_root) Item_int(thd, (longlong)0);
 }
 
+/*
+  cmp_longlong() finds values of a different signedness equal only if
+  both are in the positive signed range, so equal values have equal bits
+*/
+
+ulong in_longlong::hash_value(const uchar *value) const
+{
+  return hash_longlong((ulonglong) ((const packed_longlong*) value)->val);
+}
+
 
 static int cmp_timestamp(void *cmp_arg,
                          Timestamp_or_zero_datetime *a,
@@ -3855,6 +3935,16 @@ Item *in_double::create_item(THD *thd)
   return new (thd->mem_root) Item_float(thd, 0.0, 0);
 }
 
+ulong in_double::hash_value(const uchar *value) const
+{
+  double nr= *(const double*) value;
+  ulonglong bits;
+  if (nr == 0.0)
+    nr= 0.0;                                    // -0.0 == 0.0
+  memcpy(&bits, &nr, sizeof(bits));
+  return hash_longlong(bits);
+}
+
 
 in_decimal::in_decimal(THD *thd, uint elements)
   :in_vector(thd, elements, sizeof(my_decimal), (qsort2_cmp) cmp_decimal, 0)
@@ -537,6 +537,7 @@ class Item_bool_rowready_func2 :public Item_bool_func2_with_rev
     return cmp.compare_type_handler();
   }
   Arg_comparator *get_comparator() { return &cmp; }
+  int expr_program_add(Expr_program_builder *prog);
   void cleanup()
   {
     Item_bool_func2::cleanup();
@@ -595,6 +596,7 @@ class Item_func_not :public Item_bool_func
   virtual void top_level_item() { abort_on_null= 1; }
   bool is_top_level_item() { return abort_on_null; }
   longlong val_int();
+  int expr_program_add(Expr_program_builder *prog);
   enum Functype functype() const { return NOT_FUNC; }
   const char *func_name() const { return "not"; }
   enum precedence precedence() const { return BANG_PRECEDENCE; }
@@ -643,6 +645,7 @@ class Item_func_trig_cond: public Item_bool_func
   Item_func_trig_cond(THD *thd, Item *a, bool *f): Item_bool_func(thd, a)
   { trig_var= f; }
   longlong val_int() { return *trig_var ? args[0]->val_int() : 1; }
+  int expr_program_add(Expr_program_builder *prog);
   enum Functype functype() const { return TRIG_COND_FUNC; };
   const char *func_name() const { return "trigcond"; };
   bool const_item() const { return FALSE; }
@@ -906,6 +909,7 @@ class Item_func_between :public Item_func_opt_neg
     DBUG_ASSERT(fixed);
     return m_comparator.type_handler()->Item_func_between_val_int(this);
   }
+  int expr_program_add(Expr_program_builder *prog);
   enum Functype functype() const   { return BETWEEN; }
   const char *func_name() const { return "between"; }
   enum precedence precedence() const { return BETWEEN_PRECEDENCE; }
@@ -1321,20 +1325,33 @@ class in_vector :public Sql_alloc
   CHARSET_INFO *collation;
   uint count;
   uint used_count;
-  in_vector() {}
+  /*
+    Lists of at least HASH_MIN_ELEMENTS values of a type that implements
+    hash_value() also get an open addressing hash index over the sorted
+    values, so that find() costs a probe or two instead of a bisection.
+  */
+  static const uint HASH_MIN_ELEMENTS= 32;
+  uint *hash_table;                     /* Element number + 1, 0 if free */
+  uint hash_mask;
+  in_vector() :hash_table(0), hash_mask(0) {}
   in_vector(THD *thd, uint elements, uint element_length, qsort2_cmp cmp_func,
   	    CHARSET_INFO *cmp_coll)
     :base((char*) thd_calloc(thd, elements * element_length)),
      size(element_length), compare(cmp_func), collation(cmp_coll),
-     count(elements), used_count(elements) {}
+     count(elements), used_count(elements), hash_table(0), hash_mask(0) {}
   virtual ~in_vector() {}
   virtual void set(uint pos,Item *item)=0;
   virtual uchar *get_value(Item *item)=0;
-  void sort()
-  {
-    my_qsort2(base,used_count,size,compare,(void*)collation);
-  }
+  void sort();
   bool find(Item *item);
+  /* find() of a value that get_value() has stored */
+  bool find_value(const uchar *value);
+  /*
+    A hash of a value that is the same for all values that compare()
+    finds equal. Only called if has_hash_value() is true.
+  */
+  virtual bool has_hash_value() const { return false; }
+  virtual ulong hash_value(const uchar *value) const { return 0; }
   
   /* 
     Create an instance of Item_{type} (e.g. Item_decimal) constant object
@@ -1386,6 +1403,8 @@ class in_string :public in_vector
   void set(uint pos,Item *item);
   uchar *get_value(Item *item);
   Item* create_item(THD *thd);
+  bool has_hash_value() const { return true; }
+  ulong hash_value(const uchar *value) const;
   void value_to_item(uint pos, Item *item)
   {    
     String *str=((String*) base)+pos;
@@ -1413,6 +1432,8 @@ class in_longlong :public in_vector
   void set(uint pos,Item *item);
   uchar *get_value(Item *item);
   Item* create_item(THD *thd);
+  bool has_hash_value() const { return true; }
+  ulong hash_value(const uchar *value) const;
   void value_to_item(uint pos, Item *item)
   {
     ((Item_int*) item)->value= ((packed_longlong*) base)[pos].val;
@@ -1420,6 +1441,12 @@ class in_longlong :public in_vector
       ((packed_longlong*) base)[pos].unsigned_flag;
   }
   const Type_handler *type_handler() const { return &type_handler_longlong; }
+  bool find_longlong(longlong value, bool unsigned_flag)
+  {
+    tmp.val= value;
+    tmp.unsigned_flag= unsigned_flag;
+    return find_value((uchar*) &tmp);
+  }
 
   friend int cmp_longlong(void *cmp_arg, packed_longlong *a,packed_longlong *b);
 };
@@ -1491,11 +1518,18 @@ class in_double :public in_vector
   void set(uint pos,Item *item);
   uchar *get_value(Item *item);
   Item *create_item(THD *thd);
+  bool has_hash_value() const { return true; }
+  ulong hash_value(const uchar *value) const;
   void value_to_item(uint pos, Item *item)
   {
     ((Item_float*)item)->value= ((double*) base)[pos];
   }
   const Type_handler *type_handler() const { return &type_handler_double; }
+  bool find_double(double value)
+  {
+    tmp= value;
+    return find_value((uchar*) &tmp);
+  }
 };
 
 
@@ -2341,6 +2375,8 @@ class Item_func_in :public Item_func_opt_neg,
 protected:
   SEL_TREE *get_func_mm_tree(RANGE_OPT_PARAM *param,
                              Field *field, Item *value);
+  SEL_TREE *get_func_point_list_mm_tree(RANGE_OPT_PARAM *param, Field *field,
+                                        bool *handled);
   bool transform_into_subq;
 public:
   /// An array of values, created when the bisection lookup method is used
@@ -2368,6 +2404,7 @@ class Item_func_in :public Item_func_opt_neg,
     arg_types_compatible(FALSE), emb_on_expr_nest(0)
   { }
   longlong val_int();
+  int expr_program_add(Expr_program_builder *prog);
   bool fix_fields(THD *, Item **);
   bool fix_length_and_dec();
   bool compatible_types_scalar_bisection_possible()
@@ -2549,6 +2586,7 @@ class Item_func_isnull :public Item_func_null_predicate
 public:
   Item_func_isnull(THD *thd, Item *a): Item_func_null_predicate(thd, a) {}
   longlong val_int();
+  int expr_program_add(Expr_program_builder *prog);
   enum Functype functype() const { return ISNULL_FUNC; }
   const char *func_name() const { return "isnull"; }
   void print(String *str, enum_query_type query_type);
@@ -2627,6 +2665,7 @@ class Item_func_isnotnull :public Item_func_null_predicate
     Item_func_null_predicate(thd, a), abort_on_null(0)
   { }
   longlong val_int();
+  int expr_program_add(Expr_program_builder *prog);
   enum Functype functype() const { return ISNOTNULL_FUNC; }
   const char *func_name() const { return "isnotnull"; }
   enum precedence precedence() const { return CMP_PRECEDENCE; }
@@ -3330,6 +3369,7 @@ class Item_cond_and :public Item_cond
   Item_cond_and(THD *thd, List<Item> &list_arg): Item_cond(thd, list_arg) {}
   enum Functype functype() const { return COND_AND_FUNC; }
   longlong val_int();
+  int expr_program_add(Expr_program_builder *prog);
   const char *func_name() const { return "and"; }
   enum precedence precedence() const { return AND_PRECEDENCE; }
   table_map not_null_tables() const
@@ -3363,6 +3403,7 @@ class Item_cond_or :public Item_cond
   Item_cond_or(THD *thd, List<Item> &list_arg): Item_cond(thd, list_arg) {}
   enum Functype functype() const { return COND_OR_FUNC; }
   longlong val_int();
+  int expr_program_add(Expr_program_builder *prog);
   const char *func_name() const { return "or"; }
   enum precedence precedence() const { return OR_PRECEDENCE; }
   table_map not_null_tables() const { return and_tables_cache; }
@@ -1258,6 +1258,7 @@ class Item_func_plus :public Item_func_additive_op
   longlong int_op();
   double real_op();
   my_decimal *decimal_op(my_decimal *);
+  int expr_program_add(Expr_program_builder *prog);
   Item *get_copy(THD *thd)
   { return get_item_copy<Item_func_plus>(thd, this); }
 };
@@ -1272,6 +1273,7 @@ class Item_func_minus :public Item_func_additive_op
   longlong int_op();
   double real_op();
   my_decimal *decimal_op(my_decimal *);
+  int expr_program_add(Expr_program_builder *prog);
   bool fix_length_and_dec();
   void fix_unsigned_flag();
   void fix_length_and_dec_double()
@@ -1304,6 +1306,7 @@ class Item_func_mul :public Item_num_op
   longlong int_op();
   double real_op();
   my_decimal *decimal_op(my_decimal *);
+  int expr_program_add(Expr_program_builder *prog);
   void result_precision();
   bool fix_length_and_dec();
   bool check_partition_func_processor(void *int_arg) {return FALSE;}
@@ -1321,6 +1324,7 @@ class Item_func_div :public Item_num_op
   longlong int_op() { DBUG_ASSERT(0); return 0; }
   double real_op();
   my_decimal *decimal_op(my_decimal *);
+  int expr_program_add(Expr_program_builder *prog);
   const char *func_name() const { return "/"; }
   enum precedence precedence() const { return MUL_PRECEDENCE; }
   bool fix_length_and_dec();
@@ -1398,6 +1402,7 @@ class Item_func_neg :public Item_func_num1
   double real_op();
   longlong int_op();
   my_decimal *decimal_op(my_decimal *);
+  int expr_program_add(Expr_program_builder *prog);
   const char *func_name() const { return "-"; }
   enum Functype functype() const   { return NEG_FUNC; }
   enum precedence precedence() const { return NEG_PRECEDENCE; }
@@ -18,6 +18,7 @@
 #include "sql_priv.h"
 #include "sql_class.h"
 #include "item.h"
+#include "json_binary.h"
 
 
 /*
@@ -755,11 +756,28 @@ static bool path_ok(const json_path_with_flags *paths_list, int n_paths,
 }
 
 
+/*
+  Returns the field if the item reads a column stored in the binary
+  JSON format.
+*/
+
+static Field *json_binary_field(Item *item)
+{
+  Item *real_item= item->real_item();
+  Field *field;
+  if (real_item->type() != Item::FIELD_ITEM)
+    return NULL;
+  field= ((Item_field *) real_item)->field;
+  return field->compression_method() == json_compression_method ? field : NULL;
+}
+
+
 String *Item_func_json_extract::read_json(String *str,
                                           json_value_types *type,
                                           char **out_val, int *value_len)
 {
-  String *js= args[0]->val_json(&tmp_js);
+  Field *bin_field= json_binary_field(args[0]);
+  String *js= NULL;
   json_engine_t je, sav_je;
   json_path_t p;
   const uchar *value;
@@ -768,7 +786,15 @@ String *Item_func_json_extract::read_json(String *str,
   size_t v_len;
   int possible_multiple_values;
 
-  if ((null_value= args[0]->null_value))
+  /* The binary JSON is only converted to text when the path is not found */
+  if (bin_field)
+    null_value= bin_field->is_null();
+  else
+  {
+    js= args[0]->val_json(&tmp_js);
+    null_value= args[0]->null_value;
+  }
+  if (null_value)
     return 0;
 
   for (n_arg=1; n_arg < arg_count; n_arg++)
@@ -794,6 +820,36 @@ String *Item_func_json_extract::read_json(String *str,
   possible_multiple_values= arg_count > 2 ||
     (paths[0].p.types_used & (JSON_PATH_WILD | JSON_PATH_DOUBLE_WILD));
 
+  if (bin_field)
+  {
+    LEX_CUSTRING image= bin_field->compressed_image();
+    enum json_binary_lookup res= possible_multiple_values ?
+      JSON_BINARY_UNSUPPORTED :
+      json_binary_find_path(image.str, image.length, &paths[0].p, &tmp_js);
+
+    if (res == JSON_BINARY_NOT_FOUND)
+      goto return_null;
+    if (res == JSON_BINARY_FOUND)
+    {
+      js= &tmp_js;
+      js->set_charset(bin_field->charset());
+      json_scan_start(&je, js->charset(), (const uchar *) js->ptr(),
+                      (const uchar *) js->ptr() + js->length());
+      if (json_read_value(&je))
+        goto error;
+      *type= je.value_type;
+      *out_val= (char *) je.value;
+      *value_len= je.value_len;
+      if (!str)
+        goto return_ok;
+      if (str->copy(*js))
+        goto error;
+      goto format_value;
+    }
+    if (!(js= args[0]->val_json(&tmp_js)))
+      goto return_null;
+  }
+
   *type= possible_multiple_values ? JSON_VALUE_ARRAY : JSON_VALUE_NULL;
 
   if (str)
@@ -866,6 +922,7 @@ String *Item_func_json_extract::read_json(String *str,
   if (possible_multiple_values && str->append("]", 1))
     goto error; /* Out of memory. */
 
+format_value:
   js= str;
   json_scan_start(&je, js->charset(),(const uchar *) js->ptr(),
                   (const uchar *) js->ptr() + js->length());
@@ -478,12 +478,12 @@ String *Item_func_from_base64::val_str(String *str)
 
 
 const char *histogram_types[] =
-           {"SINGLE_PREC_HB", "DOUBLE_PREC_HB", 0};
+           {"SINGLE_PREC_HB", "DOUBLE_PREC_HB", "DOUBLE_PREC_MCV_HB", 0};
 static TYPELIB hystorgam_types_typelib=
   { array_elements(histogram_types),
     "histogram_types",
     histogram_types, NULL};
-const char *representation_by_type[]= {"%.3f", "%.5f"};
+const char *representation_by_type[]= {"%.3f", "%.5f", "%.5f"};
 
 String *Item_func_decode_histogram::val_str(String *str)
 {
@@ -508,7 +508,18 @@ String *Item_func_decode_histogram::val_str(String *str)
     null_value= 1;
     return 0;
   }
-  if (type == DOUBLE_PREC_HB && res->length() % 2 != 0)
+  /*
+    DOUBLE_PREC_MCV_HB histograms start with the list of the most common
+    values, see the Histogram class
+  */
+  uint mcv_slots= 0, mcv_count= 0, start= 0;
+  if (type == DOUBLE_PREC_MCV_HB && res->length())
+  {
+    mcv_slots= res->length() > 12 ? (res->length() - 1) / 12 : 0;
+    mcv_count= MY_MIN((uint) (uchar) (*res)[0], mcv_slots);
+    start= 1 + mcv_slots * 4;
+  }
+  if (type != SINGLE_PREC_HB && (res->length() - start) % 2 != 0)
     res->length(res->length() - 1); // one byte is unused
 
   double prev= 0.0;
@@ -516,7 +527,7 @@ String *Item_func_decode_histogram::val_str(String *str)
   str->length(0);
   char numbuf[32];
   const uchar *p= (uchar*)res->c_ptr_safe();
-  for (i= 0; i < res->length(); i++)
+  for (i= start; i < res->length(); i++)
   {
     double val;
     switch (type)
@@ -525,6 +536,7 @@ String *Item_func_decode_histogram::val_str(String *str)
       val= p[i] / ((double)((1 << 8) - 1));
       break;
     case DOUBLE_PREC_HB:
+    case DOUBLE_PREC_MCV_HB:
       val= uint2korr(p + i) / ((double)((1 << 16) - 1));
       i++;
       break;
@@ -544,6 +556,16 @@ String *Item_func_decode_histogram::val_str(String *str)
                         representation_by_type[type], 1.0 - prev);
   str->append(numbuf, size);
 
+  /* show the most common values as position:fraction of rows */
+  for (i= 0; i < mcv_count; i++)
+  {
+    const uchar *mcv= p + 1 + i * 4;
+    size= my_snprintf(numbuf, sizeof(numbuf), ";%.5f:%.5f",
+                      uint2korr(mcv) / ((double)((1 << 16) - 1)),
+                      uint2korr(mcv + 2) / ((double)((1 << 16) - 1)));
+    str->append(numbuf, size);
+  }
+
   null_value=0;
   return str;
 }
@@ -2455,8 +2455,8 @@ bool Item_sum_min::add()
   DBUG_PRINT("info", ("null_value: %s", null_value ? "TRUE" : "FALSE"));
   /* args[0] < value */
   arg_cache->cache_value();
-  if (!arg_cache->null_value &&
-      (null_value || cmp->compare() < 0))
+  if ((last_add_replaced= !arg_cache->null_value &&
+                          (null_value || cmp->compare() < 0)))
   {
     value->store(arg_cache);
     value->cache_value();
@@ -2495,8 +2495,8 @@ bool Item_sum_max::add()
   /* args[0] > value */
   arg_cache->cache_value();
   DBUG_PRINT("info", ("null_value: %s", null_value ? "TRUE" : "FALSE"));
-  if (!arg_cache->null_value &&
-      (null_value || cmp->compare() > 0))
+  if ((last_add_replaced= !arg_cache->null_value &&
+                          (null_value || cmp->compare() > 0)))
   {
     value->store(arg_cache);
     value->cache_value();
@@ -1047,19 +1047,21 @@ class Item_sum_hybrid :public Item_sum, public Type_handler_hybrid_field_type
   int cmp_sign;
   bool was_values;  // Set if we have found at least one row (for max/min only)
   bool was_null_value;
+  bool last_add_replaced; // Set if the last add() changed the result
 
   public:
   Item_sum_hybrid(THD *thd, Item *item_par,int sign):
     Item_sum(thd, item_par),
     Type_handler_hybrid_field_type(&type_handler_longlong),
     direct_added(FALSE), value(0), arg_cache(0), cmp(0),
-    cmp_sign(sign), was_values(TRUE)
+    cmp_sign(sign), was_values(TRUE), last_add_replaced(FALSE)
   { collation.set(&my_charset_bin); }
   Item_sum_hybrid(THD *thd, Item_sum_hybrid *item)
     :Item_sum(thd, item),
     Type_handler_hybrid_field_type(item),
     direct_added(FALSE), value(item->value), arg_cache(0),
-    cmp_sign(item->cmp_sign), was_values(item->was_values)
+    cmp_sign(item->cmp_sign), was_values(item->was_values),
+    last_add_replaced(FALSE)
   { }
   bool fix_fields(THD *, Item **);
   bool fix_length_and_dec();
@@ -1087,6 +1089,12 @@ class Item_sum_hybrid :public Item_sum, public Type_handler_hybrid_field_type
   void min_max_update_decimal_field();
   void cleanup();
   bool any_value() { return was_values; }
+  /*
+    Whether the last add() call took the result from its argument. Equal
+    values do not replace the result, so window frames use it to remember
+    the first row the result is from.
+  */
+  bool last_added_is_result() const { return last_add_replaced; }
   void no_rows_in_result();
   void restore_to_before_no_rows_in_result();
   Field *create_tmp_field(bool group, TABLE *table);
@@ -0,0 +1,554 @@
+/* Copyright (c) 2019, MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+
+#include "mariadb.h"
+#include "sql_priv.h"
+#include "sql_class.h"
+#include "json_binary.h"
+
+
+/*
+  The binary JSON format.
+
+  The value follows the column compression header byte 0x90: method 9,
+  format version 0. Every JSON value starts with its type byte:
+
+    JSONB_NULL, JSONB_TRUE, JSONB_FALSE
+    JSONB_INT      zigzag encoded varint, for integers of up to 18 digits
+                   written without leading zeros
+    JSONB_NUMBER   varint length, the number as written
+    JSONB_STRING   varint length, the string as written between the quotes,
+                   escapings are not resolved
+    JSONB_OBJECT   varint count, varint length of the members,
+                   offsets of the members sorted by the key,
+                   members: varint key length, key, value
+    JSONB_ARRAY    varint count, varint length of the elements,
+                   offsets of the elements, elements
+
+  Objects and arrays keep their members in the original order, so the text
+  is written sequentially. The offsets are relative to the first member
+  and take 1, 2 or 4 bytes depending on the length of the members. The
+  keys are sorted by their bytes, the keys with escapings can't be
+  compared this way, so the objects having them are JSONB_OBJECT_UNSORTED
+  and are not searched by the key.
+
+  The varints have 7 bits per byte, least significant bits first.
+*/
+
+#define JSON_BINARY_HEADER 0x90
+
+enum json_binary_types
+{
+  JSONB_NULL= 0,
+  JSONB_TRUE= 1,
+  JSONB_FALSE= 2,
+  JSONB_INT= 3,
+  JSONB_NUMBER= 4,
+  JSONB_STRING= 5,
+  JSONB_OBJECT= 6,
+  JSONB_OBJECT_UNSORTED= 7,
+  JSONB_ARRAY= 8
+};
+
+#define JSONB_INT_MAX_DIGITS 18
+#define JSONB_VARINT_MAX_LENGTH 10
+
+
+static uchar *store_varint(uchar *to, ulonglong n)
+{
+  for ( ; n >= 0x80; n>>= 7)
+    *to++= (uchar) (n | 0x80);
+  *to++= (uchar) n;
+  return to;
+}
+
+
+static uint varint_length(ulonglong n)
+{
+  uint length= 1;
+  for ( ; n >= 0x80; n>>= 7)
+    length++;
+  return length;
+}
+
+
+static bool read_varint(const uchar **from, const uchar *end, ulonglong *n)
+{
+  const uchar *p= *from;
+  *n= 0;
+  for (uint shift= 0; p < end && shift < 64; shift+= 7)
+  {
+    uchar c= *p++;
+    *n|= (ulonglong) (c & 0x7F) << shift;
+    if (!(c & 0x80))
+    {
+      *from= p;
+      return false;
+    }
+  }
+  return true;
+}
+
+
+static inline uint offset_width(ulonglong members_length)
+{
+  return members_length < 0x100 ? 1 : members_length < 0x10000 ? 2 : 4;
+}
+
+
+static inline uint32 read_offset(const uchar *from, uint width)
+{
+  return width == 1 ? *from : width == 2 ? uint2korr(from) : uint4korr(from);
+}
+
+
+static inline void store_offset(uchar *to, uint width, uint32 offset)
+{
+  if (width == 1)
+    *to= (uchar) offset;
+  else if (width == 2)
+    int2store(to, offset);
+  else
+    int4store(to, offset);
+}
+
+
+/*
+  Order of the member offsets: by the key bytes, then by the position,
+  so the first one of the duplicate keys is found.
+*/
+
+static int cmp_member_keys(const void *members_arg, const void *a,
+                           const void *b)
+{
+  const uchar *members= (const uchar *) members_arg;
+  uint32 offset_a= uint4korr(a), offset_b= uint4korr(b);
+  const uchar *key_a= members + offset_a, *key_b= members + offset_b;
+  ulonglong length_a, length_b;
+  int res;
+
+  read_varint(&key_a, key_a + JSONB_VARINT_MAX_LENGTH, &length_a);
+  read_varint(&key_b, key_b + JSONB_VARINT_MAX_LENGTH, &length_b);
+  if ((res= memcmp(key_a, key_b, (size_t) MY_MIN(length_a, length_b))))
+    return res;
+  if (length_a != length_b)
+    return length_a < length_b ? -1 : 1;
+  return offset_a < offset_b ? -1 : 1;
+}
+
+
+class Json_binary_writer
+{
+  json_engine_t je;
+  String *out;
+  /* Member offsets of the objects and arrays being written, 4 bytes each */
+  String offsets;
+  size_t max_length;
+
+  bool append_varint(ulonglong n)
+  {
+    uchar buf[JSONB_VARINT_MAX_LENGTH];
+    return out->append((const char *) buf, store_varint(buf, n) - buf);
+  }
+  bool write_number();
+  bool write_container();
+  bool write_value();
+public:
+  bool write(CHARSET_INFO *cs, const uchar *js, size_t length,
+             String *to, size_t max_length_arg);
+};
+
+
+bool Json_binary_writer::write_number()
+{
+  const uchar *digits= je.value + MY_TEST(je.num_flags & JSON_NUM_NEG);
+  const uchar *end= je.value + je.value_len;
+
+  if (!(je.num_flags & (JSON_NUM_FRAC_PART | JSON_NUM_EXP)) &&
+      end - digits <= JSONB_INT_MAX_DIGITS &&
+      (*digits != '0' || (end - digits == 1 && digits == je.value)))
+  {
+    longlong n= 0;
+    for (const uchar *d= digits; d < end; d++)
+      n= n * 10 + (*d - '0');
+    if (je.num_flags & JSON_NUM_NEG)
+      n= -n;
+    return out->append((char) JSONB_INT) ||
+           append_varint(((ulonglong) n << 1) ^ (ulonglong) (n >> 63));
+  }
+  return out->append((char) JSONB_NUMBER) ||
+         append_varint(je.value_len) ||
+         out->append((const char *) je.value, je.value_len);
+}
+
+
+bool Json_binary_writer::write_container()
+{
+  bool object= je.value_type == JSON_VALUE_OBJECT;
+  bool sorted= object;
+  uint32 start= out->length();
+  uint32 first_offset= offsets.length();
+  ulonglong count= 0;
+  uint32 members_length, header_length;
+  uint width;
+  uchar *header, *index;
+
+  while (json_scan_next(&je) == 0 &&
+         je.state != JST_OBJ_END && je.state != JST_ARRAY_END)
+  {
+    char offset[4];
+    int4store(offset, out->length() - start);
+    if (offsets.append(offset, 4))
+      return true;
+
+    if (object)
+    {
+      const uchar *key= je.s.c_str, *key_end;
+      do
+        key_end= je.s.c_str;
+      while (json_read_keyname_chr(&je) == 0);
+      if (je.s.error)
+        return true;
+
+      if (memchr(key, '\\', key_end - key))
+        sorted= false;
+      if (append_varint(key_end - key) ||
+          out->append((const char *) key, key_end - key))
+        return true;
+    }
+
+    if (json_read_value(&je) || write_value() ||
+        out->length() > max_length)
+      return true;
+    count++;
+  }
+  if (je.s.error)
+    return true;
+
+  members_length= out->length() - start;
+  width= offset_width(members_length);
+  header_length= 1 + varint_length(count) + varint_length(members_length) +
+                 (uint32) count * width;
+  if (out->length() + header_length > max_length ||
+      out->reserve(header_length))
+    return true;
+
+  index= (uchar *) offsets.ptr() + first_offset;
+  if (sorted && count > 1)
+    my_qsort2(index, (size_t) count, 4, cmp_member_keys,
+              (void *) (out->ptr() + start));
+
+  header= (uchar *) out->ptr() + start;
+  memmove(header + header_length, header, members_length);
+  out->length(out->length() + header_length);
+
+  *header++= (uchar) (!object ? JSONB_ARRAY :
+                      sorted ? JSONB_OBJECT : JSONB_OBJECT_UNSORTED);
+  header= store_varint(header, count);
+  header= store_varint(header, members_length);
+  for (ulonglong i= 0; i < count; i++, header+= width)
+    store_offset(header, width, uint4korr(index + i * 4));
+
+  offsets.length(first_offset);
+  return false;
+}
+
+
+bool Json_binary_writer::write_value()
+{
+  switch (je.value_type)
+  {
+  case JSON_VALUE_NULL:
+    return out->append((char) JSONB_NULL);
+  case JSON_VALUE_TRUE:
+    return out->append((char) JSONB_TRUE);
+  case JSON_VALUE_FALSE:
+    return out->append((char) JSONB_FALSE);
+  case JSON_VALUE_NUMBER:
+    return write_number();
+  case JSON_VALUE_STRING:
+    return out->append((char) JSONB_STRING) ||
+           append_varint(je.value_len) ||
+           out->append((const char *) je.value, je.value_len);
+  case JSON_VALUE_OBJECT:
+  case JSON_VALUE_ARRAY:
+    return write_container();
+  }
+  return true;
+}
+
+
+bool Json_binary_writer::write(CHARSET_INFO *cs,
+                               const uchar *js, size_t length,
+                               String *to, size_t max_length_arg)
+{
+  out= to;
+  max_length= max_length_arg;
+  out->length(0);
+  json_scan_start(&je, cs, js, js + length);
+
+  if (out->append((char) JSON_BINARY_HEADER) ||
+      json_read_value(&je) || write_value())
+    return true;
+
+  /* Nothing but spaces can follow the value */
+  return json_scan_next(&je) == 0 || je.s.error ||
+         out->length() > max_length;
+}
+
+
+/*
+  Reads the header of an object or an array.
+*/
+
+static bool read_container(const uchar **from, const uchar *end,
+                           ulonglong *count, uint *width,
+                           const uchar **index, const uchar **members_end)
+{
+  ulonglong members_length;
+  if (read_varint(from, end, count) ||
+      read_varint(from, end, &members_length) ||
+      *count > (ulonglong) (end - *from))
+    return true;
+  *width= offset_width(members_length);
+  *index= *from;
+  *from+= *count * *width;
+  if (*from > end || members_length > (ulonglong) (end - *from))
+    return true;
+  *members_end= *from + members_length;
+  return false;
+}
+
+
+static bool read_string(const uchar **from, const uchar *end,
+                        const uchar **str, size_t *length)
+{
+  ulonglong n;
+  if (read_varint(from, end, &n) || n > (ulonglong) (end - *from))
+    return true;
+  *str= *from;
+  *length= (size_t) n;
+  *from+= n;
+  return false;
+}
+
+
+/*
+  Appends the compact JSON text of the value.
+*/
+
+static bool read_value(const uchar **from, const uchar *end, String *to,
+                       uint depth)
+{
+  const uchar *str;
+  size_t length;
+  ulonglong n;
+
+  if (*from >= end || depth > JSON_DEPTH_LIMIT)
+    return true;
+
+  switch (*(*from)++)
+  {
+  case JSONB_NULL:
+    return to->append(STRING_WITH_LEN("null"));
+  case JSONB_TRUE:
+    return to->append(STRING_WITH_LEN("true"));
+  case JSONB_FALSE:
+    return to->append(STRING_WITH_LEN("false"));
+  case JSONB_INT:
+  {
+    char buf[MY_INT64_NUM_DECIMAL_DIGITS + 2];
+    if (read_varint(from, end, &n))
+      return true;
+    n= (n >> 1) ^ (~(n & 1) + 1);
+    return to->append(buf, longlong10_to_str((longlong) n, buf, -10) - buf);
+  }
+  case JSONB_NUMBER:
+    return read_string(from, end, &str, &length) ||
+           to->append((const char *) str, length);
+  case JSONB_STRING:
+    return read_string(from, end, &str, &length) ||
+           to->append('"') ||
+           to->append((const char *) str, length) ||
+           to->append('"');
+  case JSONB_OBJECT:
+  case JSONB_OBJECT_UNSORTED:
+  case JSONB_ARRAY:
+  {
+    bool object= (*from)[-1] != JSONB_ARRAY;
+    const uchar *index, *members_end;
+    uint width;
+
+    if (read_container(from, end, &n, &width, &index, &members_end) ||
+        to->append(object ? '{' : '['))
+      return true;
+    for (ulonglong i= 0; i < n; i++)
+    {
+      if ((i && to->append(',')) ||
+          (object &&
+           (read_string(from, members_end, &str, &length) ||
+            to->append('"') ||
+            to->append((const char *) str, length) ||
+            to->append(STRING_WITH_LEN("\":")))) ||
+          read_value(from, members_end, to, depth + 1))
+        return true;
+    }
+    return *from != members_end || to->append(object ? '}' : ']');
+  }
+  }
+  return true;
+}
+
+
+uint compress_json(THD *thd, char *to, const char *from, uint length,
+                   CHARSET_INFO *cs)
+{
+  Json_binary_writer writer;
+  String buf, text;
+  const uchar *pos, *end;
+
+  /* The text is converted back with the ASCII structural characters */
+  if (!my_charset_is_ascii_based(cs) ||
+      writer.write(cs, (const uchar *) from, length, &buf, length))
+    return 0;
+
+  /*
+    Reading the column must give back the very bytes that were stored.
+    The binary form keeps no white space and no spelling of numbers and
+    escapes, so documents that do not convert back to the same text are
+    stored as text.
+  */
+  pos= (const uchar *) buf.ptr() + 1;
+  end= (const uchar *) buf.end();
+  if (read_value(&pos, end, &text, 0) || pos != end ||
+      text.length() != length || memcmp(text.ptr(), from, length))
+    return 0;
+
+  memcpy(to, buf.ptr(), buf.length());
+  return buf.length();
+}
+
+
+int uncompress_json(String *to, const uchar *from, uint from_length,
+                    uint field_length)
+{
+  const uchar *end= from + from_length;
+
+  to->length(0);
+  if (*from++ != JSON_BINARY_HEADER ||
+      read_value(&from, end, to, 0) || from != end ||
+      to->length() > field_length)
+  {
+    my_error(ER_JSON_BINARY_DATA_ERROR, MYF(0));
+    return 1;
+  }
+  return 0;
+}
+
+
+/*
+  Finds the value of a path without wildcards in the binary JSON.
+
+  Only the key steps into sorted objects and the array steps into arrays
+  are done here, everything else needs the JSON_PATH semantics, then
+  JSON_BINARY_UNSUPPORTED is returned and the caller should search the
+  text of the document.
+
+  @param image   the column value starting with the compression header
+  @param length  the length of the column value
+  @param p       the path
+  @param value   the text of the found value
+
+  @return JSON_BINARY_FOUND, JSON_BINARY_NOT_FOUND or
+          JSON_BINARY_UNSUPPORTED
+*/
+
+enum json_binary_lookup json_binary_find_path(const uchar *image,
+                                              size_t length,
+                                              const json_path_t *p,
+                                              String *value)
+{
+  const uchar *from= image + 1, *end= image + length;
+  const json_path_step_t *step;
+
+  if (length < 2 || *image != JSON_BINARY_HEADER || p->mode_strict ||
+      !my_charset_is_ascii_based(p->s.cs))
+    return JSON_BINARY_UNSUPPORTED;
+
+  for (step= p->steps + 1; step <= p->last_step; step++)
+  {
+    const uchar *index, *members, *members_end;
+    ulonglong count;
+    uint width;
+    uchar type= *from++;
+
+    if (!(step->type == JSON_PATH_KEY && type == JSONB_OBJECT) &&
+        !(step->type == JSON_PATH_ARRAY && type == JSONB_ARRAY))
+      return JSON_BINARY_UNSUPPORTED;
+    if (read_container(&from, end, &count, &width, &index, &members_end))
+      return JSON_BINARY_UNSUPPORTED;
+    members= from;
+
+    if (step->type == JSON_PATH_ARRAY)
+    {
+      if (step->n_item >= count)
+        return JSON_BINARY_NOT_FOUND;
+      from= members + read_offset(index + step->n_item * width, width);
+    }
+    else
+    {
+      size_t key_length= step->key_end - step->key;
+      const uchar *key;
+      size_t length;
+      ulonglong lo= 0, hi= count;
+
+      /* Plain ASCII keys have the same bytes in the document */
+      for (key= step->key; key < step->key_end; key++)
+      {
+        if (*key >= 0x80 || *key == '\\' || *key == '"')
+          return JSON_BINARY_UNSUPPORTED;
+      }
+
+      while (lo < hi)
+      {
+        ulonglong mid= (lo + hi) / 2;
+        int res;
+        from= members + read_offset(index + mid * width, width);
+        if (read_string(&from, members_end, &key, &length))
+          return JSON_BINARY_UNSUPPORTED;
+        res= memcmp(key, step->key, MY_MIN(length, key_length));
+        if (res < 0 || (res == 0 && length < key_length))
+          lo= mid + 1;
+        else
+          hi= mid;
+      }
+      if (lo == count)
+        return JSON_BINARY_NOT_FOUND;
+      from= members + read_offset(index + lo * width, width);
+      if (read_string(&from, members_end, &key, &length))
+        return JSON_BINARY_UNSUPPORTED;
+      if (length != key_length || memcmp(key, step->key, length))
+        return JSON_BINARY_NOT_FOUND;
+    }
+    if (from >= members_end)
+      return JSON_BINARY_UNSUPPORTED;
+    end= members_end;
+  }
+
+  value->length(0);
+  return read_value(&from, end, value, 0) ? JSON_BINARY_UNSUPPORTED :
+                                             JSON_BINARY_FOUND;
+}
@@ -0,0 +1,52 @@
+#ifndef JSON_BINARY_INCLUDED
+#define JSON_BINARY_INCLUDED
+/* Copyright (c) 2019, MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+
+/*
+  Binary JSON storage, the "json" column compression method.
+
+  COMPRESSED=json columns store the parsed JSON documents, so that
+  simple paths can be looked up without parsing the whole text. Reading
+  the column converts the value back to text. Only the documents that
+  convert back to exactly the stored text, that is compact JSON without
+  white space, are stored parsed. The other values, and the ones that are
+  not valid JSON, are stored as they are.
+*/
+
+#include <json_lib.h>
+
+class String;
+
+uint compress_json(THD *thd, char *to, const char *from, uint length,
+                   CHARSET_INFO *cs);
+int uncompress_json(String *to, const uchar *from, uint from_length,
+                    uint field_length);
+
+
+enum json_binary_lookup
+{
+  JSON_BINARY_FOUND,
+  JSON_BINARY_NOT_FOUND,
+  JSON_BINARY_UNSUPPORTED  /* The caller should search the text */
+};
+
+enum json_binary_lookup json_binary_find_path(const uchar *image,
+                                              size_t length,
+                                              const json_path_t *p,
+                                              String *value);
+
+#endif /* JSON_BINARY_INCLUDED */
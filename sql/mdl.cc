@@ -157,6 +157,8 @@ class MDL_map
   void init();
   void destroy();
   MDL_lock *find_or_insert(LF_PINS *pins, const MDL_key *key);
+  bool fast_path_acquire(LF_PINS *pins, const MDL_key *key,
+                         MDL_ticket *ticket, uint slot);
   unsigned long get_lock_owner(LF_PINS *pins, const MDL_key *key);
   void remove(LF_PINS *pins, MDL_lock *lock);
   LF_PINS *get_pins() { return lf_hash_get_pins(&m_locks); }
@@ -539,6 +541,82 @@ class MDL_lock
     return (m_granted.is_empty() && m_waiting.is_empty());
   }
 
+  /**
+    Number of fast path slots per lock. A power of two, contexts are
+    assigned to the slots round-robin. Every lock has them, so this is
+    kept small.
+  */
+  static const uint FAST_PATH_SLOTS= 8;
+
+  /**
+    Lock types which are granted through the fast path.
+
+    These are the "unobtrusive" types which are taken by ordinary DML:
+    they are compatible with each other, so that a request for one of
+    them can only conflict with a granted or waiting ticket of some other
+    ("obtrusive") type. Such tickets are counted in m_fast_path_blocked,
+    and while it is zero unobtrusive requests are satisfied by adding the
+    ticket to the slot of the requesting context, without touching
+    m_rwlock, m_granted and the bitmaps.
+  */
+  static bitmap_t fast_path_types(MDL_key::enum_mdl_namespace mdl_namespace)
+  {
+    switch (mdl_namespace) {
+    case MDL_key::BACKUP:
+      return MDL_BIT(MDL_BACKUP_DML) | MDL_BIT(MDL_BACKUP_TRANS_DML) |
+             MDL_BIT(MDL_BACKUP_SYS_DML) | MDL_BIT(MDL_BACKUP_DDL) |
+             MDL_BIT(MDL_BACKUP_ALTER_COPY) | MDL_BIT(MDL_BACKUP_COMMIT);
+    case MDL_key::SCHEMA:
+      return MDL_BIT(MDL_INTENTION_EXCLUSIVE);
+    default:
+      return MDL_BIT(MDL_SHARED) | MDL_BIT(MDL_SHARED_HIGH_PRIO) |
+             MDL_BIT(MDL_SHARED_READ) | MDL_BIT(MDL_SHARED_WRITE);
+    }
+  }
+
+  bool is_fast_path_type(enum_mdl_type type) const
+  { return fast_path_types(key.mdl_namespace()) & MDL_BIT(type); }
+
+  bool fast_path_acquire(MDL_ticket *ticket, uint slot);
+  bool fast_path_release(MDL_ticket *ticket, bool *last);
+  void remove_if_unused(LF_PINS *pins);
+  void block_fast_path();
+  void unblock_fast_path(const MDL_ticket *ticket)
+  {
+    if (!is_fast_path_type(ticket->get_type()))
+      m_fast_path_blocked--;
+  }
+  bool fast_path_is_empty();
+  bool retire_fast_path();
+
+  struct Fast_path_slot
+  {
+    mysql_mutex_t m_mutex;
+    /** Unobtrusive tickets granted through this slot. */
+    Ticket_list::List m_tickets;
+    /** Keep the slots of one lock on separate cache lines. */
+    char m_pad[CPU_LEVEL1_DCACHE_LINESIZE];
+  };
+
+  /**
+    Fast path slots. Tickets are moved from here to m_granted by
+    block_fast_path() as soon as an obtrusive lock is requested.
+  */
+  Fast_path_slot m_fast_path[FAST_PATH_SLOTS];
+
+  /**
+    Number of obtrusive tickets in m_granted and m_waiting plus number
+    of threads which are materializing fast path tickets. Changed under
+    m_rwlock, fast path acquisitions read it under the slot mutex.
+  */
+  Atomic_counter<uint32> m_fast_path_blocked;
+
+  /**
+    Number of tickets in the fast path slots. The release which takes it
+    to zero removes the lock from the hash if it is not used otherwise.
+  */
+  Atomic_counter<uint32> m_fast_path_tickets;
+
   const bitmap_t *incompatible_granted_types_bitmap() const
   { return m_strategy->incompatible_granted_types_bitmap(); }
   const bitmap_t *incompatible_waiting_types_bitmap() const
@@ -600,21 +678,45 @@ class MDL_lock
 public:
 
   MDL_lock()
-    : m_hog_lock_count(0),
+    : m_fast_path_blocked(0),
+      m_fast_path_tickets(0),
+      m_hog_lock_count(0),
       m_strategy(0)
-  { mysql_prlock_init(key_MDL_lock_rwlock, &m_rwlock); }
+  {
+    mysql_prlock_init(key_MDL_lock_rwlock, &m_rwlock);
+    init_fast_path();
+  }
 
   MDL_lock(const MDL_key *key_arg)
   : key(key_arg),
+    m_fast_path_blocked(0),
+    m_fast_path_tickets(0),
     m_hog_lock_count(0),
     m_strategy(&m_backup_lock_strategy)
   {
     DBUG_ASSERT(key_arg->mdl_namespace() == MDL_key::BACKUP);
     mysql_prlock_init(key_MDL_lock_rwlock, &m_rwlock);
+    init_fast_path();
   }
 
   ~MDL_lock()
-  { mysql_prlock_destroy(&m_rwlock); }
+  {
+    for (uint i= 0; i < FAST_PATH_SLOTS; i++)
+      mysql_mutex_destroy(&m_fast_path[i].m_mutex);
+    mysql_prlock_destroy(&m_rwlock);
+  }
+
+  void init_fast_path()
+  {
+    /*
+      The slot mutexes are not instrumented: there are FAST_PATH_SLOTS
+      of them per lock, which would quickly exhaust the performance
+      schema mutex instances.
+    */
+    for (uint i= 0; i < FAST_PATH_SLOTS; i++)
+      mysql_mutex_init(0, &m_fast_path[i].m_mutex,
+                       MY_MUTEX_INIT_FAST);
+  }
 
   static void lf_alloc_constructor(uchar *arg)
   { new (arg + LF_HASH_OVERHEAD) MDL_lock(); }
@@ -627,6 +729,7 @@ class MDL_lock
   {
     DBUG_ASSERT(key_arg->mdl_namespace() != MDL_key::BACKUP);
     new (&lock->key) MDL_key(key_arg);
+    lock->m_fast_path_blocked= 0;
     if (key_arg->mdl_namespace() == MDL_key::SCHEMA)
       lock->m_strategy= &m_scoped_lock_strategy;
     else
@@ -723,6 +826,15 @@ static my_bool mdl_iterate_lock(MDL_lock *lock, mdl_iterate_arg *arg)
   MDL_ticket *ticket;
   while ((ticket= granted_it++) && !(res= arg->callback(ticket, arg->argument, true)))
     /* no-op */;
+  for (uint i= 0; i < MDL_lock::FAST_PATH_SLOTS && !res; i++)
+  {
+    MDL_lock::Fast_path_slot *slot= &lock->m_fast_path[i];
+    mysql_mutex_lock(&slot->m_mutex);
+    MDL_lock::Ticket_iterator slot_it(slot->m_tickets);
+    while ((ticket= slot_it++) && !(res= arg->callback(ticket, arg->argument, true)))
+      /* no-op */;
+    mysql_mutex_unlock(&slot->m_mutex);
+  }
   while ((ticket= waiting_it++) && !(res= arg->callback(ticket, arg->argument, false)))
     /* no-op */;
   mysql_prlock_unlock(&lock->m_rwlock);
@@ -833,6 +945,38 @@ MDL_lock* MDL_map::find_or_insert(LF_PINS *pins, const MDL_key *mdl_key)
 }
 
 
+/**
+  Try to grant an unobtrusive lock through the fast path of an existing
+  MDL_lock object.
+
+  @retval TRUE   The ticket was added to the fast path slot.
+  @retval FALSE  The lock does not exist or its fast path is blocked,
+                 the slow path must be taken.
+*/
+
+bool MDL_map::fast_path_acquire(LF_PINS *pins, const MDL_key *mdl_key,
+                                MDL_ticket *ticket, uint slot)
+{
+  MDL_lock *lock;
+  bool res;
+
+  if (mdl_key->mdl_namespace() == MDL_key::BACKUP)
+    return m_backup_lock->fast_path_acquire(ticket, slot);
+
+  /*
+    A lock which is being removed from the hash has the fast path
+    blocked (see MDL_lock::retire_fast_path()), so there is no need to
+    check m_strategy here.
+  */
+  if (!(lock= (MDL_lock*) lf_hash_search(&m_locks, pins, mdl_key->ptr(),
+                                         mdl_key->length())))
+    return FALSE;
+  res= lock->fast_path_acquire(ticket, slot);
+  lf_hash_search_unpin(pins);
+  return res;
+}
+
+
 /**
  * Return thread id of the owner of the lock, if it is owned.
  */
@@ -889,6 +1033,10 @@ void MDL_map::remove(LF_PINS *pins, MDL_lock *lock)
 }
 
 
+/** Number of contexts created so far, used to spread them over the slots. */
+static Atomic_counter<uint32> mdl_context_count(0);
+
+
 /**
   Initialize a metadata locking context.
 
@@ -900,7 +1048,8 @@ MDL_context::MDL_context()
   m_owner(NULL),
   m_needs_thr_lock_abort(FALSE),
   m_waiting_for(NULL),
-  m_pins(NULL)
+  m_pins(NULL),
+  m_fast_path_slot(mdl_context_count++ % MDL_lock::FAST_PATH_SLOTS)
 {
   mysql_prlock_init(key_MDL_context_LOCK_waiting_for, &m_LOCK_waiting_for);
 }
@@ -1265,6 +1414,8 @@ void MDL_lock::Ticket_list::add_ticket(MDL_ticket *ticket)
     m_list.push_back(ticket);
   }
   m_bitmap|= MDL_BIT(ticket->get_type());
+  if (!ticket->get_lock()->is_fast_path_type(ticket->get_type()))
+    ticket->get_lock()->m_fast_path_blocked++;
 }
 
 
@@ -1287,6 +1438,8 @@ void MDL_lock::Ticket_list::remove_ticket(MDL_ticket *ticket)
     So this method should not be too expensive.
   */
   clear_bit_if_not_in_list(ticket->get_type());
+  if (!ticket->get_lock()->is_fast_path_type(ticket->get_type()))
+    ticket->get_lock()->m_fast_path_blocked--;
 }
 
 
@@ -1382,8 +1535,10 @@ void MDL_lock::reschedule_waiters()
           when manages to do so, already sees an updated state of the
           MDL_lock object.
         */
+        m_fast_path_blocked++;
         m_waiting.remove_ticket(ticket);
         m_granted.add_ticket(ticket);
+        m_fast_path_blocked--;
 
         /*
           Increase counter of successively granted high-priority strong locks,
@@ -1825,7 +1980,8 @@ void MDL_lock::remove_ticket(LF_PINS *pins, Ticket_list MDL_lock::*list,
 {
   mysql_prlock_wrlock(&m_rwlock);
   (this->*list).remove_ticket(ticket);
-  if (is_empty())
+  if (is_empty() &&
+      (key.mdl_namespace() == MDL_key::BACKUP || retire_fast_path()))
     mdl_locks.remove(pins, this);
   else
   {
@@ -1849,6 +2005,154 @@ void MDL_lock::remove_ticket(LF_PINS *pins, Ticket_list MDL_lock::*list,
 }
 
 
+/**
+  Grant an unobtrusive lock by adding the ticket to the fast path slot
+  of the requesting context.
+
+  @retval TRUE   Success.
+  @retval FALSE  The fast path is blocked by an obtrusive ticket.
+*/
+
+bool MDL_lock::fast_path_acquire(MDL_ticket *ticket, uint slot)
+{
+  Fast_path_slot *fast_path= &m_fast_path[slot];
+  bool res= FALSE;
+
+  DBUG_ASSERT(is_fast_path_type(ticket->get_type()));
+  mysql_mutex_lock(&fast_path->m_mutex);
+  if (!m_fast_path_blocked)
+  {
+    ticket->m_lock= this;
+    ticket->m_fast_path= TRUE;
+    fast_path->m_tickets.push_back(ticket);
+    m_fast_path_tickets++;
+    res= TRUE;
+  }
+  mysql_mutex_unlock(&fast_path->m_mutex);
+  return res;
+}
+
+
+/**
+  Release a ticket which was granted through the fast path.
+
+  @param[out] last  Set to TRUE if it was the last fast path ticket of
+                    the lock, which should then be removed with
+                    remove_if_unused().
+
+  @retval TRUE   The ticket was removed from its slot.
+  @retval FALSE  The ticket is in m_granted and must be released with
+                 remove_ticket().
+*/
+
+bool MDL_lock::fast_path_release(MDL_ticket *ticket, bool *last)
+{
+  Fast_path_slot *fast_path;
+  bool res;
+
+  if (!is_fast_path_type(ticket->get_type()))
+    return FALSE;
+  fast_path= &m_fast_path[ticket->get_ctx()->get_fast_path_slot()];
+  mysql_mutex_lock(&fast_path->m_mutex);
+  if ((res= ticket->m_fast_path))
+  {
+    fast_path->m_tickets.remove(ticket);
+    *last= !--m_fast_path_tickets;
+  }
+  mysql_mutex_unlock(&fast_path->m_mutex);
+  return res;
+}
+
+
+/**
+  Remove a lock from the hash after its last fast path ticket has been
+  released, unless it has got other tickets meanwhile. Locks released
+  through the slow path are removed by remove_ticket().
+
+  @pre The lock is pinned by the caller, so that the object is not
+       reused even if some other thread has removed it already.
+*/
+
+void MDL_lock::remove_if_unused(LF_PINS *pins)
+{
+  mysql_prlock_wrlock(&m_rwlock);
+  /* m_strategy is reset by MDL_map::remove() */
+  if (m_strategy && is_empty() && retire_fast_path())
+    mdl_locks.remove(pins, this);
+  else
+    mysql_prlock_unlock(&m_rwlock);
+}
+
+
+/**
+  Disable the fast path and move all tickets granted through it to
+  m_granted, so that an obtrusive request sees every conflicting ticket
+  in there. Until unblock_fast_path() is called for the request, the
+  fast path stays blocked.
+
+  @pre m_rwlock is write-locked.
+*/
+
+void MDL_lock::block_fast_path()
+{
+  m_fast_path_blocked++;
+  for (uint i= 0; i < FAST_PATH_SLOTS; i++)
+  {
+    Fast_path_slot *fast_path= &m_fast_path[i];
+    MDL_ticket *ticket;
+
+    mysql_mutex_lock(&fast_path->m_mutex);
+    while ((ticket= fast_path->m_tickets.pop_front()))
+    {
+      ticket->m_fast_path= FALSE;
+      m_fast_path_tickets--;
+      m_granted.add_ticket(ticket);
+    }
+    mysql_mutex_unlock(&fast_path->m_mutex);
+  }
+}
+
+
+/** Check if there are no tickets granted through the fast path. */
+
+bool MDL_lock::fast_path_is_empty()
+{
+  for (uint i= 0; i < FAST_PATH_SLOTS; i++)
+  {
+    Fast_path_slot *fast_path= &m_fast_path[i];
+    bool empty;
+
+    mysql_mutex_lock(&fast_path->m_mutex);
+    empty= fast_path->m_tickets.is_empty();
+    mysql_mutex_unlock(&fast_path->m_mutex);
+    if (!empty)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+/**
+  Prepare an empty lock for removal from the hash. The fast path is
+  blocked for good, so that threads which still have a pointer to the
+  lock fall back to find_or_insert(), which will skip this lock object.
+
+  @pre m_rwlock is write-locked, m_granted and m_waiting are empty.
+
+  @retval TRUE   The lock can be removed.
+  @retval FALSE  Some tickets are still granted through the fast path.
+*/
+
+bool MDL_lock::retire_fast_path()
+{
+  m_fast_path_blocked++;
+  if (fast_path_is_empty())
+    return TRUE;
+  m_fast_path_blocked--;
+  return FALSE;
+}
+
+
 /**
   Check if we have any pending locks which conflict with existing
   shared lock.
@@ -2020,6 +2324,7 @@ MDL_context::try_acquire_lock(MDL_request *mdl_request)
       is no need to release it.
     */
     DBUG_ASSERT(! ticket->m_lock->is_empty());
+    ticket->m_lock->unblock_fast_path(ticket);
     mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
     MDL_ticket::destroy(ticket);
   }
@@ -2040,7 +2345,9 @@ MDL_context::try_acquire_lock(MDL_request *mdl_request)
                    lock exists. In this case "out_ticket" out parameter
                    points to ticket which was constructed for the request.
                    MDL_ticket::m_lock points to the corresponding MDL_lock
-                   object and MDL_lock::m_rwlock write-locked.
+                   object and MDL_lock::m_rwlock write-locked. The caller
+                   must call MDL_lock::unblock_fast_path() for the ticket
+                   before releasing MDL_lock::m_rwlock.
   @retval  TRUE    Out of resources, an error has been reported.
 */
 
@@ -2104,6 +2411,19 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
                                    )))
     return TRUE;
 
+  /*
+    Unobtrusive locks on objects which are already locked by somebody
+    else are normally granted without taking MDL_lock::m_rwlock.
+  */
+  if ((MDL_lock::fast_path_types(key->mdl_namespace()) &
+       MDL_BIT(mdl_request->type)) &&
+      mdl_locks.fast_path_acquire(m_pins, key, ticket, m_fast_path_slot))
+  {
+    m_tickets[mdl_request->duration].push_front(ticket);
+    mdl_request->ticket= ticket;
+    return FALSE;
+  }
+
   /* The below call implicitly locks MDL_lock::m_rwlock on success. */
   if (!(lock= mdl_locks.find_or_insert(m_pins, key)))
   {
@@ -2113,9 +2433,17 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
 
   ticket->m_lock= lock;
 
+  /*
+    Tickets granted through the fast path must be visible to the checks
+    below and to the deadlock detector.
+  */
+  if (!lock->is_fast_path_type(mdl_request->type))
+    lock->block_fast_path();
+
   if (lock->can_grant_lock(mdl_request->type, this, false))
   {
     lock->m_granted.add_ticket(ticket);
+    lock->unblock_fast_path(ticket);
 
     mysql_prlock_unlock(&lock->m_rwlock);
 
@@ -2284,6 +2612,7 @@ MDL_context::acquire_lock(MDL_request *mdl_request, double lock_wait_timeout)
 
   if (lock_wait_timeout == 0)
   {
+    lock->unblock_fast_path(ticket);
     mysql_prlock_unlock(&lock->m_rwlock);
     MDL_ticket::destroy(ticket);
     my_error(ER_LOCK_WAIT_TIMEOUT, MYF(0));
@@ -2291,6 +2620,7 @@ MDL_context::acquire_lock(MDL_request *mdl_request, double lock_wait_timeout)
   }
 
   lock->m_waiting.add_ticket(ticket);
+  lock->unblock_fast_path(ticket);
 
   /*
     Once we added a pending ticket to the waiting queue,
@@ -2543,6 +2873,12 @@ MDL_context::upgrade_shared_lock(MDL_ticket *mdl_ticket,
 
   /* Merge the acquired and the original lock. @todo: move to a method. */
   mysql_prlock_wrlock(&mdl_ticket->m_lock->m_rwlock);
+  /*
+    An upgrade to an unobtrusive type (MDL_BACKUP_DDL) may have granted
+    both tickets through the fast path. Move them to m_granted and don't
+    let the fast path in while the tickets are being merged.
+  */
+  mdl_ticket->m_lock->block_fast_path();
   if (is_new_ticket)
     mdl_ticket->m_lock->m_granted.remove_ticket(mdl_xlock_request.ticket);
   /*
@@ -2553,6 +2889,7 @@ MDL_context::upgrade_shared_lock(MDL_ticket *mdl_ticket,
   mdl_ticket->m_lock->m_granted.remove_ticket(mdl_ticket);
   mdl_ticket->m_type= new_type;
   mdl_ticket->m_lock->m_granted.add_ticket(mdl_ticket);
+  mdl_ticket->m_lock->m_fast_path_blocked--;
 
   mysql_prlock_unlock(&mdl_ticket->m_lock->m_rwlock);
 
@@ -2830,7 +3167,17 @@ void MDL_context::release_lock(enum_mdl_duration duration, MDL_ticket *ticket)
 
   DBUG_ASSERT(this == ticket->get_ctx());
 
-  lock->remove_ticket(m_pins, &MDL_lock::m_granted, ticket);
+  /*
+    Once the ticket is released, the lock may be removed and its memory
+    reused by any other thread. Pin it for remove_if_unused().
+  */
+  bool last= FALSE;
+  lf_pin(m_pins, 3, lock);
+  if (!lock->fast_path_release(ticket, &last))
+    lock->remove_ticket(m_pins, &MDL_lock::m_granted, ticket);
+  else if (last && lock->key.mdl_namespace() != MDL_key::BACKUP)
+    lock->remove_if_unused(m_pins);
+  lf_unpin(m_pins, 3);
 
   m_tickets[duration].remove(ticket);
   MDL_ticket::destroy(ticket);
@@ -2943,10 +3290,14 @@ void MDL_ticket::downgrade_lock(enum_mdl_type type)
   /*
     To update state of MDL_lock object correctly we need to temporarily
     exclude ticket from the granted queue and then include it back.
+    MDL_BACKUP_DDL may have been granted through the fast path, move it
+    to the granted queue first.
   */
+  m_lock->block_fast_path();
   m_lock->m_granted.remove_ticket(this);
   m_type= type;
   m_lock->m_granted.add_ticket(this);
+  m_lock->m_fast_path_blocked--;
   m_lock->reschedule_waiters();
   mysql_prlock_unlock(&m_lock->m_rwlock);
 }
@@ -710,6 +710,7 @@ class MDL_ticket : public MDL_wait_for_subgraph
   virtual uint get_deadlock_weight() const;
 private:
   friend class MDL_context;
+  friend class MDL_lock;
 
   MDL_ticket(MDL_context *ctx_arg, enum_mdl_type type_arg
 #ifndef DBUG_OFF
@@ -721,7 +722,8 @@ class MDL_ticket : public MDL_wait_for_subgraph
      m_duration(duration_arg),
 #endif
      m_ctx(ctx_arg),
-     m_lock(NULL)
+     m_lock(NULL),
+     m_fast_path(false)
   {}
 
   static MDL_ticket *create(MDL_context *ctx_arg, enum_mdl_type type_arg
@@ -750,6 +752,13 @@ class MDL_ticket : public MDL_wait_for_subgraph
   */
   MDL_lock *m_lock;
 
+  /**
+    TRUE if the ticket is stored in one of the fast path slots of the
+    lock rather than in MDL_lock::m_granted. Protected by the mutex of
+    the slot.
+  */
+  bool m_fast_path;
+
 private:
   MDL_ticket(const MDL_ticket &);               /* not implemented */
   MDL_ticket &operator=(const MDL_ticket &);    /* not implemented */
@@ -1014,6 +1023,12 @@ class MDL_context
    */
   MDL_wait_for_subgraph *m_waiting_for;
   LF_PINS *m_pins;
+  /**
+    Fast path slot used by this context in every MDL_lock. Contexts are
+    spread over the slots round-robin, so that unrelated connections
+    locking the same object do not contend on one mutex.
+  */
+  uint m_fast_path_slot;
 private:
   MDL_ticket *find_ticket(MDL_request *mdl_req,
                           enum_mdl_duration *duration);
@@ -1029,6 +1044,7 @@ class MDL_context
   void find_deadlock();
 
   ulong get_thread_id() const { return thd_get_thread_id(get_thd()); }
+  uint get_fast_path_slot() const { return m_fast_path_slot; }
 
   bool visit_subgraph(MDL_wait_for_graph_visitor *dvisitor);
 
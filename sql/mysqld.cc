@@ -49,6 +49,7 @@
 #include "des_key_file.h" // load_des_key_file
 #include "sql_manager.h"  // stop_handle_manager, start_handle_manager
 #include "sql_expression_cache.h" // subquery_cache_miss, subquery_cache_hit
+#include "sql_statistics.h" // init_statistics_changes
 #include "sys_vars_shared.h"
 
 #include <m_ctype.h>
@@ -425,6 +426,8 @@ my_bool opt_skip_slave_start = 0; ///< If set, slave is not autostarted
 my_bool opt_reckless_slave = 0;
 my_bool opt_enable_named_pipe= 0;
 my_bool opt_local_infile, opt_slave_compressed_protocol;
+ulong opt_slave_compression_algorithm= MY_COMPRESS_ZLIB;
+uint opt_slave_zstd_compression_level= 3;
 my_bool opt_safe_user_create = 0;
 my_bool opt_show_slave_auth_info;
 my_bool opt_log_slave_updates= 0;
@@ -549,6 +552,14 @@ uint max_prepared_stmt_count;
   statements.
 */
 uint prepared_stmt_count=0;
+/**
+  Limit and current total number of statements in the text statement
+  caches of all connections, see Text_statement_cache. Kept apart from
+  prepared_stmt_count so that the caches do not take the slots of
+  prepared statements.
+*/
+uint max_text_statement_cache_count;
+uint text_statement_cache_count= 0;
 my_thread_id global_thread_id= 0;
 ulong current_pid;
 ulong slow_launch_threads = 0;
@@ -709,7 +720,7 @@ MY_LOCALE *my_default_lc_time_names;
 
 SHOW_COMP_OPTION have_ssl, have_symlink, have_dlopen, have_query_cache;
 SHOW_COMP_OPTION have_geometry, have_rtree_keys;
-SHOW_COMP_OPTION have_crypt, have_compress;
+SHOW_COMP_OPTION have_crypt, have_compress, have_zstd;
 SHOW_COMP_OPTION have_profiling;
 SHOW_COMP_OPTION have_openssl;
 
@@ -765,6 +776,8 @@ mysql_mutex_t LOCK_thread_id;
   set the limit and hold the current total number of prepared statements
   in the server, respectively. As PREPARE/DEALLOCATE rate in a loaded
   server may be fairly high, we need a dedicated lock.
+  It also protects max_text_statement_cache_count and
+  text_statement_cache_count.
 */
 mysql_mutex_t LOCK_prepared_stmt_count;
 #ifdef HAVE_OPENSSL
@@ -2081,6 +2094,7 @@ static void mysqld_exit(int exit_code)
   shutdown_performance_schema();        // we do it as late as possible
 #endif
   set_malloc_size_cb(NULL);
+  set_mem_root_block_cache_cb(NULL);
   if (opt_endinfo && global_status_var.global_memory_used)
     fprintf(stderr, "Warning: Memory not freed: %ld\n",
             (long) global_status_var.global_memory_used);
@@ -2144,6 +2158,7 @@ void clean_up(bool print_message)
     tc_log->close();
   xid_cache_free();
   tdc_deinit();
+  free_statistics_changes();
   mdl_destroy();
   dflt_key_cache= 0;
   key_caches.delete_elements((void (*)(const char*, uchar*)) free_key_cache);
@@ -2922,6 +2937,78 @@ static bool cache_thread(THD *thd)
 }
 
 
+/*
+  Pool of THD objects of closed connections
+
+  A connection that ends without its thread being parked in the thread
+  cache (all connections of the thread pool, or when the thread cache
+  is full) leaves its THD here instead of destroying it.
+  CONNECT::create_thd() resets and reuses a pooled THD, which saves
+  constructing and destroying the THD with all its sub-objects, mutexes
+  and instrumentation for every short lived connection.
+
+  The pool holds at most thread_cache_size THDs and is protected by
+  LOCK_thread_cache. The THDs are unlinked from 'threads', so they are
+  not visible to SHOW PROCESSLIST or KILL. They still count in
+  thread_count until flush_thread_cache() destroys them.
+*/
+
+static I_List<THD> thd_pool;
+static uint thd_pool_count= 0;
+
+/*
+  Put the THD of a closed connection in the pool
+
+  RETURN
+    0  THD was not pooled, caller should delete it
+    1  THD is in the pool and may not be used by the caller anymore
+*/
+
+bool put_thd_in_pool(THD *thd)
+{
+  DBUG_ENTER("put_thd_in_pool");
+
+  mysql_mutex_lock(&LOCK_thread_cache);
+  if (thd_pool_count >= thread_cache_size || abort_loop ||
+      kill_cached_threads)
+  {
+    mysql_mutex_unlock(&LOCK_thread_cache);
+    DBUG_RETURN(0);
+  }
+  /* The mysys_var and the instrumentation belong to the ending thread */
+  thd->set_mysys_var(0);
+  if (current_thd == thd)
+    set_current_thd(0);
+  thd_pool.push_back(thd);
+  thd_pool_count++;
+  mysql_mutex_unlock(&LOCK_thread_cache);
+  DBUG_RETURN(1);
+}
+
+
+/* Take a THD from the pool. It has to be reset before it is used */
+
+THD *get_thd_from_pool()
+{
+  THD *thd;
+  if (!thd_pool_count)                          // Safe without the lock
+    return 0;
+  mysql_mutex_lock(&LOCK_thread_cache);
+  if ((thd= thd_pool.get()))
+    thd_pool_count--;
+  mysql_mutex_unlock(&LOCK_thread_cache);
+  return thd;
+}
+
+
+static void flush_thd_pool()
+{
+  THD *thd;
+  while ((thd= get_thd_from_pool()))
+    delete thd;
+}
+
+
 /*
   End thread for the current connection
 
@@ -2952,7 +3039,8 @@ bool one_thread_per_connection_end(THD *thd, bool put_in_cache)
     unlink_thd(thd);
     if (!wsrep_applier && put_in_cache && cache_thread(thd))
       DBUG_RETURN(0);                             // Thread is reused
-    delete thd;
+    if (wsrep_applier || !put_in_cache || !put_thd_in_pool(thd))
+      delete thd;
   }
 
   DBUG_PRINT("info", ("killing thread"));
@@ -2979,6 +3067,7 @@ void flush_thread_cache()
   }
   kill_cached_threads--;
   mysql_mutex_unlock(&LOCK_thread_cache);
+  flush_thd_pool();
   DBUG_VOID_RETURN;
 }
 
@@ -3916,6 +4005,12 @@ extern "C" my_thread_id mariadb_dbug_id()
 
 /* Thread Mem Usage By P.Linux */
 extern "C" {
+static MEM_ROOT_BLOCK_CACHE *mem_root_block_cache_cb_func(void)
+{
+  THD *thd= current_thd;
+  return thd ? &thd->mem_root_block_cache : 0;
+}
+
 static void my_malloc_size_cb_func(long long size, my_bool is_thread_specific)
 {
   THD *thd= current_thd;
@@ -4032,6 +4127,7 @@ static int init_early_variables()
   }
   set_current_thd(0);
   set_malloc_size_cb(my_malloc_size_cb_func);
+  set_mem_root_block_cache_cb(mem_root_block_cache_cb_func);
   global_status_var.global_memory_used= 0;
   return 0;
 }
@@ -5023,6 +5119,7 @@ static int init_server_components()
     all things are initialized so that unireg_abort() doesn't fail
   */
   mdl_init();
+  init_statistics_changes();
   if (tdc_init() || hostname_cache_init())
     unireg_abort(1);
 
@@ -7367,6 +7464,19 @@ static int show_net_compression(THD *thd, SHOW_VAR *var, char *buff,
   return 0;
 }
 
+static int show_net_compression_algorithm(THD *thd, SHOW_VAR *var, char *buff,
+                                          enum enum_var_type scope)
+{
+  var->type= SHOW_CHAR;
+  if (!thd->net.compress)
+    var->value= const_cast<char*>("");
+  else if (thd->net.compress_algorithm == MY_COMPRESS_ZSTD)
+    var->value= const_cast<char*>("zstd");
+  else
+    var->value= const_cast<char*>("zlib");
+  return 0;
+}
+
 static int show_starttime(THD *thd, SHOW_VAR *var, char *buff,
                           enum enum_var_type scope)
 {
@@ -7512,6 +7622,18 @@ static int show_prepared_stmt_count(THD *thd, SHOW_VAR *var, char *buff,
   return 0;
 }
 
+static int show_text_statement_cache_count(THD *thd, SHOW_VAR *var,
+                                           char *buff,
+                                           enum enum_var_type scope)
+{
+  var->type= SHOW_LONG;
+  var->value= buff;
+  mysql_mutex_lock(&LOCK_prepared_stmt_count);
+  *((long *)buff)= (long)text_statement_cache_count;
+  mysql_mutex_unlock(&LOCK_prepared_stmt_count);
+  return 0;
+}
+
 static int show_table_definitions(THD *thd, SHOW_VAR *var, char *buff,
                                   enum enum_var_type scope)
 {
@@ -7887,6 +8009,7 @@ SHOW_VAR status_vars[]= {
   {"Column_decompressions",    (char*) offsetof(STATUS_VAR, column_decompressions), SHOW_LONG_STATUS},
   {"Com",                      (char*) com_status_vars, SHOW_ARRAY},
   {"Compression",              (char*) &show_net_compression, SHOW_SIMPLE_FUNC},
+  {"Compression_algorithm",    (char*) &show_net_compression_algorithm, SHOW_SIMPLE_FUNC},
   {"Connections",              (char*) &global_thread_id,         SHOW_LONG_NOFLUSH},
   {"Connection_errors_accept", (char*) &connection_errors_accept, SHOW_LONG},
   {"Connection_errors_internal", (char*) &connection_errors_internal, SHOW_LONG},
@@ -7958,6 +8081,8 @@ SHOW_VAR status_vars[]= {
   {"Master_gtid_wait_timeouts", (char*) offsetof(STATUS_VAR, master_gtid_wait_timeouts), SHOW_LONGLONG_STATUS},
   {"Master_gtid_wait_time",    (char*) offsetof(STATUS_VAR, master_gtid_wait_time), SHOW_LONGLONG_STATUS},
   {"Max_used_connections",     (char*) &max_used_connections,  SHOW_LONG},
+  {"Mem_root_blocks_allocated", (char*) offsetof(STATUS_VAR, mem_root_blocks_allocated), SHOW_LONG_STATUS},
+  {"Mem_root_blocks_reused",   (char*) offsetof(STATUS_VAR, mem_root_blocks_reused), SHOW_LONG_STATUS},
   {"Memory_used",              (char*) &show_memory_used, SHOW_SIMPLE_FUNC},
   {"Memory_used_initial",      (char*) &start_memory_used, SHOW_LONGLONG},
   {"Not_flushed_delayed_rows", (char*) &delayed_rows_in_use,    SHOW_LONG_NOFLUSH},
@@ -8061,6 +8186,8 @@ SHOW_VAR status_vars[]= {
   {"Ssl_version",              (char*) &show_ssl_get_version, SHOW_SIMPLE_FUNC},
 #endif
 #endif /* HAVE_OPENSSL */
+  {"Stored_routine_shared_cache_hits", (char*) offsetof(STATUS_VAR, sp_shared_cache_hits), SHOW_LONG_STATUS},
+  {"Stored_routine_shared_cache_misses", (char*) offsetof(STATUS_VAR, sp_shared_cache_misses), SHOW_LONG_STATUS},
   {"Syncs",                    (char*) &my_sync_count,          SHOW_LONG_NOFLUSH},
   /*
     Expression cache used only for caching subqueries now, so its statistic
@@ -8074,6 +8201,9 @@ SHOW_VAR status_vars[]= {
   {"Table_open_cache_hits",    (char*) offsetof(STATUS_VAR, table_open_cache_hits), SHOW_LONGLONG_STATUS},
   {"Table_open_cache_misses",  (char*) offsetof(STATUS_VAR, table_open_cache_misses), SHOW_LONGLONG_STATUS},
   {"Table_open_cache_overflows", (char*) offsetof(STATUS_VAR, table_open_cache_overflows), SHOW_LONGLONG_STATUS},
+  {"Text_statement_cache_count", (char*) &show_text_statement_cache_count, SHOW_SIMPLE_FUNC},
+  {"Text_statement_cache_hits", (char*) offsetof(STATUS_VAR, text_stmt_cache_hits), SHOW_LONG_STATUS},
+  {"Text_statement_cache_misses", (char*) offsetof(STATUS_VAR, text_stmt_cache_misses), SHOW_LONG_STATUS},
 #ifdef HAVE_MMAP
   {"Tc_log_max_pages_used",    (char*) &tc_log_max_pages_used,  SHOW_LONG},
   {"Tc_log_page_size",         (char*) &tc_log_page_size,       SHOW_LONG_NOFLUSH},
@@ -8280,6 +8410,7 @@ static int mysql_init_variables(void)
   max_used_connections= slow_launch_threads = 0;
   mysqld_user= mysqld_chroot= opt_init_file= opt_bin_logname = 0;
   prepared_stmt_count= 0;
+  text_statement_cache_count= 0;
   mysqld_unix_port= opt_mysql_tmpdir= my_bind_addr_str= NullS;
   bzero((uchar*) &mysql_tmpdir_list, sizeof(mysql_tmpdir_list));
   /* Clear all except global_memory_used */
@@ -8407,6 +8538,11 @@ static int mysql_init_variables(void)
 #else
   have_compress= SHOW_OPTION_NO;
 #endif
+#ifdef HAVE_ZSTD
+  have_zstd= SHOW_OPTION_YES;
+#else
+  have_zstd= SHOW_OPTION_NO;
+#endif
 #ifdef HAVE_LIBWRAP
   libwrapName= NullS;
 #endif
@@ -8910,6 +9046,7 @@ mysql_getopt_value(const char *name, uint length,
   case OPT_KEY_CACHE_DIVISION_LIMIT:
   case OPT_KEY_CACHE_AGE_THRESHOLD:
   case OPT_KEY_CACHE_PARTITIONS:
+  case OPT_KEY_CACHE_CLOCK:
   case OPT_KEY_CACHE_CHANGED_BLOCKS_HASH_SIZE:
   {
     KEY_CACHE *key_cache;
@@ -8930,6 +9067,8 @@ mysql_getopt_value(const char *name, uint length,
       return &key_cache->param_age_threshold;
     case OPT_KEY_CACHE_PARTITIONS:
       return (uchar**) &key_cache->param_partitions;
+    case OPT_KEY_CACHE_CLOCK:
+      return (uchar**) &key_cache->param_clock;
     case OPT_KEY_CACHE_CHANGED_BLOCKS_HASH_SIZE:
       return (uchar**) &key_cache->changed_blocks_hash_size;
     }
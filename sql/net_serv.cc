@@ -147,6 +147,7 @@ my_bool my_net_init(NET *net, Vio *vio, void *thd, uint my_flags)
   net->pkt_nr=net->compress_pkt_nr=0;
   net->last_error[0]=0;
   net->compress=0; net->reading_or_writing=0;
+  net->compress_algorithm= MY_COMPRESS_ZLIB; net->compress_level= 0;
   net->where_b = net->remain_in_buf=0;
   net->net_skip_rest_factor= 0;
   net->last_errno=0;
@@ -648,11 +649,17 @@ net_real_write(NET *net,const uchar *packet, size_t len)
       net->reading_or_writing= 0;
       DBUG_RETURN(1);
     }
-    memcpy(b+header_length,packet,len);
-
     /* Don't compress error packets (compress == 2) */
-    if (net->compress == 2 || my_compress(b+header_length, &len, &complen))
+    if (net->compress != 2 &&
+        (complen= my_compress_packet(net->compress_algorithm,
+                                     net->compress_level, packet, len,
+                                     b+header_length)))
+      swap_variables(size_t, len, complen);     /* len is compressed length */
+    else
+    {
+      memcpy(b+header_length,packet,len);
       complen=0;
+    }
     int3store(&b[NET_HEADER_SIZE],complen);
     int3store(b,len);
     b[3]=(uchar) (net->compress_pkt_nr++);
@@ -1353,8 +1360,9 @@ my_net_read_packet_reallen(NET *net, my_bool read_from_server, ulong* reallen)
 	return packet_error;
       }
       read_from_server= 0;
-      if (my_uncompress(net->buff + net->where_b, packet_len,
-			&complen))
+      if (my_uncompress_packet(net->compress_algorithm,
+                               net->buff + net->where_b, packet_len,
+                               &complen))
       {
 	net->error= 2;			/* caller will close socket */
         net->last_errno= ER_NET_UNCOMPRESS_ERROR;
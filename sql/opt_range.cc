@@ -7181,6 +7181,219 @@ SEL_TREE *Item_func_between::get_func_mm_tree(RANGE_OPT_PARAM *param,
 }
 
 
+/* Compare the left endpoints of two intervals, for my_qsort() */
+
+static int cmp_sel_arg_min(SEL_ARG **a, SEL_ARG **b)
+{
+  return (*a)->cmp_min_to_min(*b);
+}
+
+
+/*
+  Link the intervals points[0..count-1], sorted and disjoint, into a
+  balanced RB-tree.
+
+  Both subtrees of every node get the same number of intervals, give or
+  take one, so all the leaves are at the depths red_depth-1 and red_depth.
+  Coloring the nodes at red_depth red and all the others black satisfies
+  the RB-tree rules.
+*/
+
+static SEL_ARG *sel_arg_balanced_tree(SEL_ARG **points, uint count,
+                                      uint depth, uint red_depth,
+                                      SEL_ARG *parent)
+{
+  if (!count)
+    return &null_element;
+  uint mid= count / 2;
+  SEL_ARG *node= points[mid];
+  node->parent= parent;
+  node->color= depth == red_depth ? SEL_ARG::RED : SEL_ARG::BLACK;
+  node->left= sel_arg_balanced_tree(points, mid, depth + 1, red_depth, node);
+  node->right= sel_arg_balanced_tree(points + mid + 1, count - mid - 1,
+                                     depth + 1, red_depth, node);
+  return node;
+}
+
+
+/*
+  Build the SEL_TREE for "t.key IN (c1, ..., cN)" from the sorted array
+  of the constants.
+
+  SYNOPSIS
+    get_func_point_list_mm_tree()
+      param    PARAM from SQL_SELECT::test_quick_select
+      field    The field the IN predicate is on
+      handled  OUT: FALSE if the tree is to be built the generic way
+
+  DESCRIPTION
+    The generic way makes a SEL_TREE for every constant and ORs them in
+    one by one with tree_or(), each insertion walking the RB-trees that
+    have grown so far. For big lists this is the bulk of the range
+    analysis. Here the interval of every distinct constant is made for
+    every index over the field, the intervals of an index are sorted
+    once, and the RB-tree of the index is linked in a single pass.
+
+    If the intervals of an index overlap (i.e. the key image is not the
+    exact value, as for prefix keys) *handled is set to FALSE and key_or()
+    is left to merge them.
+
+  RETURN
+    The tree, or NULL if no index can be used
+*/
+
+SEL_TREE *Item_func_in::get_func_point_list_mm_tree(RANGE_OPT_PARAM *param,
+                                                    Field *field,
+                                                    bool *handled)
+{
+  DBUG_ENTER("Item_func_in::get_func_point_list_mm_tree");
+  KEY_PART *key_part;
+  SEL_ARG **points[MAX_KEY];
+  uint point_count[MAX_KEY];
+  SEL_ARG *leaf[MAX_KEY];
+  bool have_keys= false, possible= false;
+
+  *handled= true;
+  if (field->table != param->table)
+    DBUG_RETURN(0);
+
+  bzero(points, sizeof(points[0]) * param->keys);
+  for (key_part= param->key_parts; key_part != param->key_parts_end;
+       key_part++)
+  {
+    if (field->eq(key_part->field))
+    {
+      if (!(points[key_part->key]=
+            (SEL_ARG**) alloc_root(param->mem_root,
+                                   array->used_count * sizeof(SEL_ARG*))))
+        DBUG_RETURN(0);                         // OOM
+      point_count[key_part->key]= 0;
+      have_keys= true;
+    }
+  }
+  if (!have_keys)
+    DBUG_RETURN(0);
+
+  /* See the comment about value_item for NOT IN */
+  MEM_ROOT *tmp_root= param->mem_root;
+  param->thd->mem_root= param->old_root;
+  Item *value_item= array->create_item(param->thd);
+  if (!value_item)
+  {
+    param->thd->mem_root= tmp_root;
+    *handled= false;
+    DBUG_RETURN(0);
+  }
+
+  for (uint i= 0; i < array->used_count; i++)
+  {
+    if (i && !array->compare_elems(i, i - 1))
+      continue;                                 // A duplicate constant
+    array->value_to_item(i, value_item);
+
+    /*
+      As in get_mm_parts(): a constant that can not be stored in some
+      index has no rows, and an index without an interval for some
+      constant can not be used.
+    */
+    bool impossible= false;
+    for (key_part= param->key_parts; key_part != param->key_parts_end;
+         key_part++)
+    {
+      if (!points[key_part->key] || !field->eq(key_part->field))
+        continue;
+      SEL_ARG *sel_arg= get_mm_leaf(param, key_part->field, key_part,
+                                    Item_func::EQ_FUNC, value_item);
+      if (sel_arg && sel_arg->type == SEL_ARG::IMPOSSIBLE)
+        impossible= true;
+      else if (sel_arg &&
+               (sel_arg->type != SEL_ARG::KEY_RANGE ||
+                sel_arg->next_key_part || sel_arg->elements != 1))
+      {
+        param->thd->mem_root= tmp_root;
+        *handled= false;
+        DBUG_RETURN(0);
+      }
+      leaf[key_part->key]= sel_arg;
+    }
+    if (impossible)
+      continue;
+    possible= true;
+    for (key_part= param->key_parts; key_part != param->key_parts_end;
+         key_part++)
+    {
+      uint key= key_part->key;
+      if (!points[key] || !field->eq(key_part->field))
+        continue;
+      if (!leaf[key])
+      {
+        points[key]= 0;
+        continue;
+      }
+      leaf[key]->part= (uchar) key_part->part;
+      leaf[key]->max_part_no= leaf[key]->part + 1;
+      points[key][point_count[key]++]= leaf[key];
+    }
+  }
+  param->thd->mem_root= tmp_root;
+
+  SEL_TREE *tree;
+  if (!possible)
+    DBUG_RETURN(new (param->mem_root) SEL_TREE(SEL_TREE::IMPOSSIBLE,
+                                               param->mem_root, param->keys));
+  if (!(tree= new (param->mem_root) SEL_TREE(param->mem_root, param->keys)))
+    DBUG_RETURN(0);                             // OOM
+
+  for (uint key= 0; key < param->keys; key++)
+  {
+    SEL_ARG **key_points= points[key];
+    uint count= 0;
+    if (!key_points)
+      continue;
+
+    my_qsort(key_points, point_count[key], sizeof(SEL_ARG*),
+             (qsort_cmp) cmp_sel_arg_min);
+    uint8 maybe_flag= 0;
+    for (uint j= 0; j < point_count[key]; j++)
+    {
+      SEL_ARG *point= key_points[j];
+      maybe_flag|= point->maybe_flag;
+      if (count)
+      {
+        SEL_ARG *last= key_points[count - 1];
+        if (last->is_same(point))
+          continue;                             // e.g. 1 and 1.0
+        if (last->cmp_max_to_min(point) != -1)
+        {
+          *handled= false;
+          DBUG_RETURN(0);
+        }
+        last->next= point;
+        point->prev= last;
+      }
+      else
+        point->prev= 0;
+      point->next= 0;
+      key_points[count++]= point;
+    }
+
+    uint red_depth= 0;
+    while ((2U << red_depth) <= count + 1)
+      red_depth++;
+    SEL_ARG *root= sel_arg_balanced_tree(key_points, count, 0, red_depth, 0);
+    root->use_count= 1;
+    root->elements= count;
+    root->maybe_flag= maybe_flag;
+    tree->keys[key]= root;
+    tree->keys_map.set_bit(key);
+  }
+
+  if (tree->keys_map.is_clear_all())
+    DBUG_RETURN(0);
+  DBUG_RETURN(tree);
+}
+
+
 SEL_TREE *Item_func_in::get_func_mm_tree(RANGE_OPT_PARAM *param,
                                          Field *field, Item *value)
 {
@@ -7346,6 +7559,15 @@ SEL_TREE *Item_func_in::get_func_mm_tree(RANGE_OPT_PARAM *param,
   }
   else
   {
+#define IN_POINT_LIST_MIN_ELEMENTS 32
+    if (array && array->type_handler()->result_type() != ROW_RESULT &&
+        array->used_count >= IN_POINT_LIST_MIN_ELEMENTS)
+    {
+      bool handled;
+      tree= get_func_point_list_mm_tree(param, field, &handled);
+      if (handled)
+        DBUG_RETURN(tree);
+    }
     tree= get_mm_parts(param, field, Item_func::EQ_FUNC, args[1]);
     if (tree)
     {
@@ -35,6 +35,7 @@
 */
 #include "sql_class.h"                          // set_var.h: THD
 #include "set_var.h"                            /* Item */
+#include "sql_expr_program.h"                   /* Compiled_cond */
 
 class JOIN;
 class Item_sum;
@@ -1636,6 +1637,7 @@ class SQL_SELECT :public Sql_alloc {
   /* See PARAM::possible_keys */
   key_map possible_keys;
   bool	free_cond; /* Currently not used and always FALSE */
+  Compiled_cond compiled_cond;  /* cond, as skip_record() evaluates it */
 
   SQL_SELECT();
   ~SQL_SELECT();
@@ -1655,7 +1657,7 @@ class SQL_SELECT :public Sql_alloc {
   */   
   inline int skip_record(THD *thd)
   {
-    int rc= MY_TEST(!cond || cond->val_int());
+    int rc= MY_TEST(!cond || compiled_cond.val_int(thd, cond));
     if (thd->is_error())
       rc= -1;
     return rc;
@@ -1225,6 +1225,40 @@ bool Protocol_text::store(double from, uint32 decimals, String *buffer)
 }
 
 
+/**
+  Store the text that Field::val_text() prints, without a String and
+  character set conversion in between.
+
+  @retval 0   stored
+  @retval 1   out of memory
+  @retval -1  the field has no val_text(), val_str() is to be used
+*/
+
+int Protocol_text::store_field_text(Field *field)
+{
+#ifndef EMBEDDED_LIBRARY
+  /* The text is shorter than 251 bytes, its length takes one byte */
+  size_t packet_length= packet->length();
+  size_t new_length= packet_length + 1 + FIELD_TEXT_BUFFER_LENGTH;
+  if (new_length > packet->alloced_length() && packet->realloc(new_length))
+    return 1;
+  char *length_pos= (char*) packet->ptr() + packet_length;
+  char *end= field->val_text(length_pos + 1);
+  if (!end)
+    return -1;
+  *length_pos= (char) (end - length_pos - 1);
+  packet->length((uint32) (end - packet->ptr()));
+  return 0;
+#else
+  char buff[FIELD_TEXT_BUFFER_LENGTH];
+  char *end= field->val_text(buff);
+  if (!end)
+    return -1;
+  return net_store_data((uchar*) buff, (size_t) (end - buff));
+#endif
+}
+
+
 bool Protocol_text::store(Field *field)
 {
   if (field->is_null())
@@ -1235,6 +1269,7 @@ bool Protocol_text::store(Field *field)
   char buff[MAX_FIELD_WIDTH];
   String str(buff,sizeof(buff), &my_charset_bin);
   CHARSET_INFO *tocs= this->thd->variables.character_set_results;
+  int res= -1;
 #ifdef DBUG_ASSERT_EXISTS
   TABLE *table= field->table;
   my_bitmap_map *old_map= 0;
@@ -1242,12 +1277,22 @@ bool Protocol_text::store(Field *field)
     old_map= dbug_tmp_use_all_columns(table, table->read_set);
 #endif
 
-  field->val_str(&str);
+  /*
+    Numbers and temporal values are printed straight into the packet,
+    their ASCII text needs no conversion unless the client wants
+    results in UCS2, UTF16 or UTF32.
+  */
+  if (!tocs || tocs->mbminlen == 1)
+    res= store_field_text(field);
+  if (res < 0)
+    field->val_str(&str);
 #ifdef DBUG_ASSERT_EXISTS
   if (old_map)
     dbug_tmp_restore_column_map(table->read_set, old_map);
 #endif
 
+  if (res >= 0)
+    return res;
   return store_string_aux(str.ptr(), str.length(), str.charset(), tocs);
 }
 
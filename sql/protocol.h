@@ -149,6 +149,7 @@ class Protocol
 
 class Protocol_text :public Protocol
 {
+  int store_field_text(Field *field);
 public:
   Protocol_text(THD *thd_arg) :Protocol(thd_arg) {}
   virtual void prepare_for_resend();
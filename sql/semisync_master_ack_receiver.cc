@@ -127,6 +127,11 @@ bool Ack_receiver::add_slave(THD *thd)
     DBUG_RETURN(true);
 
   slave->thd= thd;
+  /*
+    The replies are read from a copy of the Vio, and poll() would not see
+    the ones left in its read buffer.
+  */
+  vio_set_buffered_read(thd->net.vio, FALSE);
   slave->vio= *thd->net.vio;
   slave->vio.mysql_socket.m_psi= NULL;
   slave->vio.read_timeout= 1;
@@ -7150,7 +7150,15 @@ static int connect_to_master(THD* thd, MYSQL* mysql, Master_info* mi,
 #endif
   ulong client_flag= CLIENT_REMEMBER_OPTIONS;
   if (opt_slave_compressed_protocol)
+  {
     client_flag|= CLIENT_COMPRESS;                /* We will use compression */
+    if (opt_slave_compression_algorithm == MY_COMPRESS_ZSTD)
+    {
+      mysql_options(mysql, MYSQL_OPT_COMPRESSION_ALGORITHM, "zstd");
+      mysql_options(mysql, MYSQL_OPT_ZSTD_COMPRESSION_LEVEL,
+                    &opt_slave_zstd_compression_level);
+    }
+  }
 
   mysql_options(mysql, MYSQL_OPT_CONNECT_TIMEOUT, (char *) &slave_net_timeout);
   mysql_options(mysql, MYSQL_OPT_READ_TIMEOUT, (char *) &slave_net_timeout);
@@ -2790,6 +2790,17 @@ int Sp_handler::sp_cache_routine(THD *thd,
       DBUG_RETURN(SP_OK);
   }
 
+  /* Procedures and functions released by other connections are reused */
+  if (type() == TYPE_ENUM_PROCEDURE || type() == TYPE_ENUM_FUNCTION)
+  {
+    if ((*sp= sp_cache_lookup_shared(thd, this, name)))
+    {
+      status_var_increment(thd->status_var.sp_shared_cache_hits);
+      DBUG_RETURN(SP_OK);
+    }
+    status_var_increment(thd->status_var.sp_shared_cache_misses);
+  }
+
   switch ((ret= db_find_and_cache_routine(thd, name, sp)))
   {
     case SP_OK:
@@ -25,6 +25,56 @@
 static mysql_mutex_t Cversion_lock;
 static ulong volatile Cversion= 1;
 
+/*
+  Server wide cache of routines which no connection uses any more.
+
+  When a connection ends, its routine caches are kept here. A connection
+  which doesn't find a procedure or function in its own caches takes over
+  the caches of a finished connection holding an up to date instance of
+  it, instead of loading and parsing the routine from mysql.proc again.
+
+  The caches of a connection are handed over as a whole, as the statements
+  of a routine remember the routines they used at their first execution
+  and later on only look them up in the caches of the connection, and
+  package routines point to their package body.
+
+  The procedures and functions of the released caches are found through
+  the hash shared_routines, keyed by the qualified routine name. A name
+  may be in several released caches, each instance has its own element.
+*/
+
+/* Number of routine caches of a connection */
+#define SP_CACHE_COUNT 4
+/* Number of caches looked up by sp_cache_lookup_shared() */
+#define SP_SHARED_CACHE_COUNT 2
+
+struct sp_released_caches;
+
+/* A procedure or function in the released caches */
+struct sp_shared_routine
+{
+  sp_head *sp;
+  sp_released_caches *rc;
+  uint type;                                    // Index of the cache
+};
+
+struct sp_released_caches
+{
+  sp_released_caches *next, *prev;
+  /* In the order of get_thd_caches() */
+  sp_cache *caches[SP_CACHE_COUNT];
+  ulong records;
+  /* The procedures and functions, in shared_routines */
+  sp_shared_routine *routines;
+  ulong routine_count;
+};
+
+static mysql_mutex_t LOCK_shared_cache;
+/* Most recently released caches first */
+static sp_released_caches *shared_caches, *shared_caches_last;
+static ulong shared_cache_records;
+static HASH shared_routines;
+
 
 /*
   Cache of stored routines. 
@@ -48,7 +98,7 @@ class sp_cache
     return my_hash_insert(&m_hashtable, (const uchar *)sp);
   }
 
-  inline sp_head *lookup(char *name, size_t namelen)
+  inline sp_head *lookup(const char *name, size_t namelen)
   {
     return (sp_head *) my_hash_search(&m_hashtable, (const uchar *)name,
                                       namelen);
@@ -59,6 +109,18 @@ class sp_cache
     my_hash_delete(&m_hashtable, (uchar *)sp);
   }
 
+  inline ulong records() const
+  {
+    return m_hashtable.records;
+  }
+
+  inline sp_head *element(ulong idx)
+  {
+    return (sp_head *) my_hash_element(&m_hashtable, idx);
+  }
+
+  void move_to(sp_cache *to);
+
   /**
     Remove all elements from a stored routine cache if the current
     number of elements exceeds the argument value.
@@ -81,11 +143,12 @@ class sp_cache
 }; // class sp_cache
 
 #ifdef HAVE_PSI_INTERFACE
-static PSI_mutex_key key_Cversion_lock;
+static PSI_mutex_key key_Cversion_lock, key_LOCK_shared_cache;
 
 static PSI_mutex_info all_sp_cache_mutexes[]=
 {
-  { &key_Cversion_lock, "Cversion_lock", PSI_FLAG_GLOBAL}
+  { &key_Cversion_lock, "Cversion_lock", PSI_FLAG_GLOBAL},
+  { &key_LOCK_shared_cache, "LOCK_sp_shared_cache", PSI_FLAG_GLOBAL}
 };
 
 static void init_sp_cache_psi_keys(void)
@@ -101,6 +164,10 @@ static void init_sp_cache_psi_keys(void)
 }
 #endif
 
+extern "C" uchar *hash_get_key_for_shared_routine(const uchar *ptr,
+                                                  size_t *plen,
+                                                  my_bool first);
+
 /* Initialize the SP caching once at startup */
 
 void sp_cache_init()
@@ -110,6 +177,10 @@ void sp_cache_init()
 #endif
 
   mysql_mutex_init(key_Cversion_lock, &Cversion_lock, MY_MUTEX_INIT_FAST);
+  mysql_mutex_init(key_LOCK_shared_cache, &LOCK_shared_cache,
+                   MY_MUTEX_INIT_FAST);
+  my_hash_init(&shared_routines, system_charset_info, 0, 0, 0,
+               hash_get_key_for_shared_routine, 0, 0);
 }
 
 
@@ -136,8 +207,151 @@ void sp_cache_clear(sp_cache **cp)
 }
 
 
+static void get_thd_caches(THD *thd, sp_cache **cp[SP_CACHE_COUNT])
+{
+  cp[0]= &thd->sp_proc_cache;
+  cp[1]= &thd->sp_func_cache;
+  cp[2]= &thd->sp_package_spec_cache;
+  cp[3]= &thd->sp_package_body_cache;
+}
+
+
+static void free_released_caches(sp_released_caches *rc)
+{
+  while (rc)
+  {
+    sp_released_caches *next= rc->next;
+    for (uint i= 0; i < SP_CACHE_COUNT; i++)
+      delete rc->caches[i];
+    my_free(rc->routines);
+    delete rc;
+    rc= next;
+  }
+}
+
+
+/*
+  Remove released caches from the server wide cache. Their routines can
+  not be found any more.
+*/
+
+static void unlink_released_caches(sp_released_caches *rc)
+{
+  mysql_mutex_assert_owner(&LOCK_shared_cache);
+  for (ulong i= 0; i < rc->routine_count; i++)
+    my_hash_delete(&shared_routines, (uchar *) (rc->routines + i));
+  if (rc->prev)
+    rc->prev->next= rc->next;
+  else
+    shared_caches= rc->next;
+  if (rc->next)
+    rc->next->prev= rc->prev;
+  else
+    shared_caches_last= rc->prev;
+  rc->next= rc->prev= NULL;
+  shared_cache_records-= rc->records;
+}
+
+
+/*
+  Release the routine caches of a connection to the server wide cache and
+  set them to NULL. The caches released longest ago are deleted to stay
+  within the size limit.
+
+  SYNOPSIS
+    sp_cache_release()
+    thd                       Thread handler
+    upper_limit_for_elements  Max number of routines in the server wide
+                              cache
+
+  NOTE
+    The connection must not use any of the routines any more.
+*/
+
+void sp_cache_release(THD *thd, ulong upper_limit_for_elements)
+{
+  sp_cache **cp[SP_CACHE_COUNT];
+  sp_released_caches *rc, *old= NULL;
+  sp_shared_routine *routine;
+  ulong records= 0, routines= 0;
+  uint i;
+
+  get_thd_caches(thd, cp);
+  for (i= 0; i < SP_CACHE_COUNT; i++)
+  {
+    if (*cp[i])
+    {
+      records+= (*cp[i])->records();
+      if (i < SP_SHARED_CACHE_COUNT)
+        routines+= (*cp[i])->records();
+    }
+  }
+  if (!routines || records > upper_limit_for_elements ||
+      !(rc= new sp_released_caches))
+  {
+    for (i= 0; i < SP_CACHE_COUNT; i++)
+      sp_cache_clear(cp[i]);
+    return;
+  }
+  if (!(rc->routines= (sp_shared_routine *)
+        my_malloc(routines * sizeof(sp_shared_routine), MYF(0))))
+  {
+    delete rc;
+    for (i= 0; i < SP_CACHE_COUNT; i++)
+      sp_cache_clear(cp[i]);
+    return;
+  }
+  routine= rc->routines;
+  for (i= 0; i < SP_CACHE_COUNT; i++)
+  {
+    rc->caches[i]= *cp[i];
+    *cp[i]= NULL;
+    if (i < SP_SHARED_CACHE_COUNT && rc->caches[i])
+    {
+      for (ulong j= 0; j < rc->caches[i]->records(); j++, routine++)
+      {
+        routine->sp= rc->caches[i]->element(j);
+        routine->rc= rc;
+        routine->type= i;
+      }
+    }
+  }
+  rc->records= records;
+  rc->routine_count= 0;
+  rc->prev= NULL;
+
+  mysql_mutex_lock(&LOCK_shared_cache);
+  /* A routine which can't be added to the hash is not found, no harm */
+  while (rc->routine_count < routines &&
+         !my_hash_insert(&shared_routines,
+                         (uchar *) (rc->routines + rc->routine_count)))
+    rc->routine_count++;
+  if ((rc->next= shared_caches))
+    shared_caches->prev= rc;
+  else
+    shared_caches_last= rc;
+  shared_caches= rc;
+  shared_cache_records+= records;
+  while (shared_cache_records > upper_limit_for_elements)
+  {
+    sp_released_caches *last= shared_caches_last;
+    unlink_released_caches(last);
+    last->next= old;
+    old= last;
+  }
+  mysql_mutex_unlock(&LOCK_shared_cache);
+
+  free_released_caches(old);
+}
+
+
 void sp_cache_end()
 {
+  my_hash_free(&shared_routines);
+  free_released_caches(shared_caches);
+  shared_caches= shared_caches_last= NULL;
+  shared_cache_records= 0;
+  mysql_mutex_destroy(&LOCK_shared_cache);
   mysql_mutex_destroy(&Cversion_lock);
 }
 
@@ -199,6 +413,100 @@ sp_head *sp_cache_lookup(sp_cache **cp, const Database_qualified_name *name)
 }
 
 
+/*
+  Move the routines of the cache from into the cache *to, and delete from.
+*/
+
+static void merge_cache(sp_cache **to, sp_cache *from)
+{
+  if (!from)
+    return;
+  if (!*to)
+  {
+    *to= from;
+    return;
+  }
+  from->move_to(*to);
+  delete from;
+}
+
+
+/*
+  Take over the caches released by a finished connection, which hold an
+  up to date instance of the routine.
+
+  SYNOPSIS
+    sp_cache_lookup_shared()
+      thd   Thread handler
+      sph   Handler of the routine type
+      name  Name of rutine to find
+
+  NOTE
+    The routine must not be in the cache of the connection. All routines
+    of the released caches are added to the caches of the connection,
+    unless it already has an instance of them. Released caches holding
+    packages are only taken over by a connection with no cached packages.
+
+  RETURN
+    The routine or
+    NULL if no up to date instance of the routine was found.
+*/
+
+sp_head *sp_cache_lookup_shared(THD *thd, const Sp_handler *sph,
+                                const Database_qualified_name *name)
+{
+  char buf[NAME_LEN * 2 + 2];
+  size_t length= name->make_qname(buf, sizeof(buf));
+  sp_cache **cp[SP_CACHE_COUNT];
+  sp_cache **spc= sph->get_cache(thd);
+  sp_released_caches *rc= NULL;
+  sp_shared_routine *routine;
+  HASH_SEARCH_STATE state;
+  sp_head *sp= NULL;
+  bool has_packages;
+  uint i;
+
+  /* Reading the number of records with no lock, a miss is harmless */
+  if (!shared_cache_records)
+    return NULL;
+
+  get_thd_caches(thd, cp);
+  i= spc == cp[0] ? 0 : 1;
+  DBUG_ASSERT(spc == cp[i]);
+  has_packages= ((*cp[2] && (*cp[2])->records()) ||
+                 (*cp[3] && (*cp[3])->records()));
+
+  mysql_mutex_lock(&LOCK_shared_cache);
+  for (routine= (sp_shared_routine *)
+         my_hash_first(&shared_routines, (uchar *) buf, length, &state);
+       routine;
+       routine= (sp_shared_routine *)
+         my_hash_next(&shared_routines, (uchar *) buf, length, &state))
+  {
+    if (routine->type == i &&
+        routine->sp->sp_cache_version() >= Cversion &&
+        !(has_packages && (routine->rc->caches[2] || routine->rc->caches[3])))
+    {
+      sp= routine->sp;
+      rc= routine->rc;
+      unlink_released_caches(rc);
+      break;
+    }
+  }
+  mysql_mutex_unlock(&LOCK_shared_cache);
+
+  if (!rc)
+    return NULL;
+  /* Keep the versions, the routines may be invalidated in between */
+  DBUG_PRINT("info",("sp_cache: reusing: %s", ErrConvDQName(sp).ptr()));
+  for (i= 0; i < SP_CACHE_COUNT; i++)
+    merge_cache(cp[i], rc->caches[i]);
+  my_free(rc->routines);
+  delete rc;
+  return sp;
+}
+
+
 /*
   Invalidate all routines in all caches.
 
@@ -280,6 +588,15 @@ uchar *hash_get_key_for_sp_head(const uchar *ptr, size_t *plen,
 }
 
 
+uchar *hash_get_key_for_shared_routine(const uchar *ptr, size_t *plen,
+                                       my_bool first)
+{
+  sp_head *sp= ((sp_shared_routine *) ptr)->sp;
+  *plen= sp->m_qname.length;
+  return (uchar*) sp->m_qname.str;
+}
+
+
 void hash_free_sp_head(void *p)
 {
   sp_head *sp= (sp_head *)p;
@@ -299,6 +616,26 @@ sp_cache::~sp_cache()
 }
 
 
+/**
+  Move the routines to another cache, unless it already has an instance
+  of them, and empty this cache.
+*/
+
+void
+sp_cache::move_to(sp_cache *to)
+{
+  for (ulong i= 0; i < m_hashtable.records; i++)
+  {
+    sp_head *sp= (sp_head *) my_hash_element(&m_hashtable, i);
+    if (to->lookup(sp->m_qname.str, sp->m_qname.length) || to->insert(sp))
+      delete sp;
+  }
+  /* All routines are moved or deleted, empty the hash without freeing them */
+  m_hashtable.free= 0;
+  my_hash_reset(&m_hashtable);
+}
+
+
 void
 sp_cache::init()
 {
@@ -25,12 +25,15 @@
   Stored procedures/functions cache. This is used as follows:
    * Each thread has its own cache.
    * Each sp_head object is put into its thread cache before it is used, and
-     then remains in the cache until deleted.
+     then remains in the cache until deleted, or until the thread ends and
+     releases it to the server wide cache of unused routines.
 */
 
 class sp_head;
 class sp_cache;
 class Database_qualified_name;
+class Sp_handler;
+class THD;
 
 /*
   Cache usage scenarios:
@@ -51,13 +54,22 @@ class Database_qualified_name;
   
   3. Before thread exit:
     sp_cache_clear();
+    // or hand the routines over to other threads
+    sp_cache_release();
+
+  A thread which doesn't find a routine in its own caches takes over the
+  released caches holding it with sp_cache_lookup_shared(), before loading
+  it from mysql.proc.
 */
 
 void sp_cache_init();
 void sp_cache_end();
 void sp_cache_clear(sp_cache **cp);
+void sp_cache_release(THD *thd, ulong upper_limit_for_elements);
 void sp_cache_insert(sp_cache **cp, sp_head *sp);
 sp_head *sp_cache_lookup(sp_cache **cp, const Database_qualified_name *name);
+sp_head *sp_cache_lookup_shared(THD *thd, const Sp_handler *sph,
+                                const Database_qualified_name *name);
 void sp_cache_invalidate();
 void sp_cache_flush_obsolete(sp_cache **cp, sp_head **sp);
 ulong sp_cache_version();
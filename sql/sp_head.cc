@@ -3236,6 +3236,9 @@ sp_lex_keeper::reset_lex_and_exec_core(THD *thd, uint *nextp,
   int res= 0;
   DBUG_ENTER("reset_lex_and_exec_core");
 
+  if (open_tables && is_table_free_expression())
+    DBUG_RETURN(reset_lex_and_exec_expression(thd, nextp, instr));
+
   /*
     The flag is saved at the entry to the following substatement.
     It's reset further in the common code part.
@@ -3380,6 +3383,56 @@ sp_lex_keeper::reset_lex_and_exec_core(THD *thd, uint *nextp,
 }
 
 
+/**
+  Execute an instruction which only evaluates table free expressions.
+
+  This is the part of reset_lex_and_exec_core() which is needed when
+  is_table_free_expression() is true. There are no tables to open, lock
+  and close, and no transaction, metadata locks or prelocking state
+  which the instruction could change, so the statement is not ended.
+  Procedures spend most instructions in such control flow and variable
+  assignments, e.g. in the loops over the rows of a cursor.
+
+  @param thd           thread context
+  @param nextp         out - next instruction
+  @param sp_instr      instruction to execute
+
+  @return
+    0/non-0 - Success/Failure
+*/
+
+int sp_lex_keeper::reset_lex_and_exec_expression(THD *thd, uint *nextp,
+                                                 sp_instr *instr)
+{
+  int res;
+  DBUG_ENTER("sp_lex_keeper::reset_lex_and_exec_expression");
+  DBUG_ASSERT(!thd->derived_tables);
+  DBUG_ASSERT(thd->Item_change_list::is_empty());
+  DBUG_ASSERT(!m_lex->query_tables_own_last);
+
+  bool parent_modified_non_trans_table= thd->transaction.stmt.modified_non_trans_table;
+  thd->transaction.stmt.modified_non_trans_table= FALSE;
+  thd->lex= m_lex;
+  thd->set_query_id(next_query_id());
+  /* A trigger body can be executed by different threads */
+  m_lex->thd= thd;
+  m_lex->unit.set_thd(thd);
+  /* As reinit_stmt_before_use() does, for name resolution and set functions */
+  m_lex->current_select= m_lex->first_select_lex();
+  m_lex->allow_sum_func.clear_all();
+  m_lex->in_sum_func= NULL;
+
+  res= instr->exec_core(thd, nextp);
+  DBUG_PRINT("info",("exec_core returned: %d", res));
+
+  thd->rollback_item_tree_changes();
+  thd->stmt_arena->state= Query_arena::STMT_EXECUTED;
+  thd->transaction.stmt.modified_non_trans_table |= parent_modified_non_trans_table;
+  thd->lex->restore_set_statement_var();
+  DBUG_RETURN(res || thd->is_error());
+}
+
+
 int sp_lex_keeper::cursor_reset_lex_and_exec_core(THD *thd, uint *nextp,
                                                   bool open_tables,
                                                   sp_instr *instr)
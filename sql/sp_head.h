@@ -1197,6 +1197,18 @@ class sp_lex_keeper
   int cursor_reset_lex_and_exec_core(THD *thd, uint *nextp, bool open_tables,
                                      sp_instr *instr);
 
+  /**
+    Check if the LEX only holds expressions which use no tables, call no
+    stored routines and have no subqueries, like most expressions of SET,
+    IF, WHILE, CASE and RETURN. Such instructions can be executed without
+    opening tables and ending a statement.
+  */
+  bool is_table_free_expression() const
+  {
+    return !m_lex->query_tables && !m_lex->uses_stored_routines() &&
+           !m_lex->all_selects_list->next_select_in_list();
+  }
+
   inline uint sql_command() const
   {
     return (uint)m_lex->sql_command;
@@ -1209,6 +1221,8 @@ class sp_lex_keeper
 
 private:
 
+  int reset_lex_and_exec_expression(THD *thd, uint *nextp, sp_instr *instr);
+
   LEX *m_lex;
   /**
     Indicates whenever this sp_lex_keeper instance responsible
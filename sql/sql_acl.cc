@@ -616,7 +616,11 @@ static HASH acl_check_hosts, column_priv_hash, proc_priv_hash, func_priv_hash;
 static HASH package_spec_priv_hash, package_body_priv_hash;
 static DYNAMIC_ARRAY acl_wild_hosts;
 static Hash_filo<acl_entry> *acl_cache;
-static uint grant_version=0; /* Version of priv tables. incremented by acl_load */
+/*
+  Version of priv tables, incremented by acl_load() and whenever
+  LOCK_grant is write locked. Read without the lock by check_grant().
+*/
+static Atomic_counter<uint> grant_version(0);
 static ulong get_access(TABLE *form,uint fieldnr, uint *next_field=0);
 static int acl_compare(const ACL_ACCESS *a, const ACL_ACCESS *b);
 static int acl_user_compare(const ACL_USER *a, const ACL_USER *b);
@@ -2796,6 +2800,7 @@ int acl_setrole(THD *thd, const char *rolename, ulonglong access)
 {
   /* merge the privileges */
   Security_context *sctx= thd->security_ctx;
+  thd->grant_table_memo.reset();
   sctx->master_access= static_cast<ulong>(access);
   if (thd->db.str)
     sctx->db_access= acl_get(sctx->host, sctx->ip, sctx->user, thd->db.str, FALSE);
@@ -6644,6 +6649,7 @@ bool mysql_routine_grant(THD *thd, TABLE_LIST *table_list,
     create_new_users= test_if_create_new_users(thd);
   mysql_rwlock_wrlock(&LOCK_grant);
   mysql_mutex_lock(&acl_cache->lock);
+  grant_version++;
   MEM_ROOT *old_root= thd->mem_root;
   thd->mem_root= &grant_memroot;
 
@@ -6837,6 +6843,7 @@ bool mysql_grant_role(THD *thd, List <LEX_USER> &list, bool revoke)
 
   mysql_rwlock_wrlock(&LOCK_grant);
   mysql_mutex_lock(&acl_cache->lock);
+  grant_version++;
   if (!(role= find_acl_role(rolename.str)))
   {
     mysql_mutex_unlock(&acl_cache->lock);
@@ -7442,6 +7449,79 @@ bool grant_reload(THD *thd)
 }
 
 
+/*
+  Key of a table in Grant_table_memo: "db\0table_name\0"
+*/
+
+static uint grant_memo_key(char *key, const char *db, const char *table_name)
+{
+  char *end= strmake(strmake(key, db, NAME_LEN) + 1, table_name, NAME_LEN) + 1;
+  return (uint) (end - key);
+}
+
+
+/*
+  Find the grants of a table in the memo of the current thread
+
+  The entry is only returned if no grants have changed since it was
+  added. This is checked without LOCK_grant: a concurrent change that
+  has not bumped grant_version yet is ordered after this statement.
+*/
+
+static Grant_table_memo::Entry *
+grant_memo_find(Grant_table_memo *memo, const char *key, uint key_length)
+{
+  uint version= grant_version;
+  for (uint i= 0; i < memo->used; i++)
+  {
+    Grant_table_memo::Entry *entry= &memo->entries[i];
+    if (entry->version == version && entry->key_length == key_length &&
+        !memcmp(entry->key, key, key_length))
+      return entry;
+  }
+  return 0;
+}
+
+
+/*
+  Remember the grants of a table, looked up under LOCK_grant
+
+  An outdated entry for the same table is replaced, otherwise the
+  oldest entry.
+*/
+
+static void grant_memo_add(Grant_table_memo *memo, const char *key,
+                           uint key_length, GRANT_TABLE *grant_table,
+                           GRANT_TABLE *grant_table_role,
+                           ulong privs, ulong cols, uint version)
+{
+  Grant_table_memo::Entry *entry= 0;
+  for (uint i= 0; i < memo->used; i++)
+  {
+    if (memo->entries[i].key_length == key_length &&
+        !memcmp(memo->entries[i].key, key, key_length))
+    {
+      entry= &memo->entries[i];
+      break;
+    }
+  }
+  if (!entry)
+  {
+    entry= &memo->entries[memo->next];
+    memo->next= (memo->next + 1) % Grant_table_memo::SIZE;
+    if (memo->used < Grant_table_memo::SIZE)
+      memo->used++;
+  }
+  entry->grant_table_user= grant_table;
+  entry->grant_table_role= grant_table_role;
+  entry->privs= privs;
+  entry->cols= cols;
+  entry->version= version;
+  entry->key_length= key_length;
+  memcpy(entry->key, key, key_length);
+}
+
+
 /**
   @brief Check table level grants
 
@@ -7495,7 +7575,11 @@ bool check_grant(THD *thd, ulong want_access, TABLE_LIST *tables,
   ulong original_want_access= want_access;
   bool locked= 0;
   GRANT_TABLE *grant_table;
-  GRANT_TABLE *grant_table_role= NULL;
+  GRANT_TABLE *grant_table_role;
+  ulong table_privs, table_cols;
+  uint version, memo_key_length;
+  Grant_table_memo::Entry *memo;
+  char memo_key[MAX_DBKEY_LENGTH];
   DBUG_ENTER("check_grant");
   DBUG_ASSERT(number > 0);
 
@@ -7615,22 +7699,56 @@ bool check_grant(THD *thd, ulong want_access, TABLE_LIST *tables,
       continue;
     }
 
-    if (!locked)
+    /*
+      The grants of the main security context are remembered in the THD,
+      so that statements using the same tables again don't need LOCK_grant.
+      The GRANT_TABLE objects are not dereferenced without the lock.
+    */
+    memo_key_length= 0;
+    memo= 0;
+    if (sctx == &thd->main_security_ctx)
     {
-      locked= 1;
-      mysql_rwlock_rdlock(&LOCK_grant);
+      memo_key_length= grant_memo_key(memo_key, t_ref->get_db_name(),
+                                      t_ref->get_table_name());
+      memo= grant_memo_find(&thd->grant_table_memo, memo_key, memo_key_length);
     }
+    if (memo)
+    {
+      grant_table= memo->grant_table_user;
+      grant_table_role= memo->grant_table_role;
+      table_privs= memo->privs;
+      table_cols= memo->cols;
+      version= memo->version;
+    }
+    else
+    {
+      if (!locked)
+      {
+        locked= 1;
+        mysql_rwlock_rdlock(&LOCK_grant);
+      }
 
-    grant_table= table_hash_search(sctx->host, sctx->ip,
-                                   t_ref->get_db_name(),
-                                   sctx->priv_user,
-                                   t_ref->get_table_name(),
-                                   FALSE);
-    if (sctx->priv_role[0])
-      grant_table_role= table_hash_search("", NULL, t_ref->get_db_name(),
-                                          sctx->priv_role,
-                                          t_ref->get_table_name(),
-                                          TRUE);
+      grant_table= table_hash_search(sctx->host, sctx->ip,
+                                     t_ref->get_db_name(),
+                                     sctx->priv_user,
+                                     t_ref->get_table_name(),
+                                     FALSE);
+      grant_table_role= NULL;
+      if (sctx->priv_role[0])
+        grant_table_role= table_hash_search("", NULL, t_ref->get_db_name(),
+                                            sctx->priv_role,
+                                            t_ref->get_table_name(),
+                                            TRUE);
+      table_privs= ((grant_table ? grant_table->privs : 0) |
+                    (grant_table_role ? grant_table_role->privs : 0));
+      table_cols= ((grant_table ? grant_table->cols : 0) |
+                   (grant_table_role ? grant_table_role->cols : 0));
+      version= grant_version;
+      if (memo_key_length)
+        grant_memo_add(&thd->grant_table_memo, memo_key, memo_key_length,
+                       grant_table, grant_table_role, table_privs, table_cols,
+                       version);
+    }
 
     if (!grant_table && !grant_table_role)
     {
@@ -7647,17 +7765,14 @@ bool check_grant(THD *thd, ulong want_access, TABLE_LIST *tables,
 
     t_ref->grant.grant_table_user= grant_table; // Remember for column test
     t_ref->grant.grant_table_role= grant_table_role;
-    t_ref->grant.version= grant_version;
-    t_ref->grant.privilege|= grant_table ? grant_table->privs : 0;
-    t_ref->grant.privilege|= grant_table_role ? grant_table_role->privs : 0;
+    t_ref->grant.version= version;
+    t_ref->grant.privilege|= table_privs;
     t_ref->grant.want_privilege= ((want_access & COL_ACLS) & ~t_ref->grant.privilege);
 
     if (!(~t_ref->grant.privilege & want_access))
       continue;
 
-    if ((want_access&= ~((grant_table ? grant_table->cols : 0) |
-                        (grant_table_role ? grant_table_role->cols : 0) |
-                        t_ref->grant.privilege)))
+    if ((want_access&= ~(table_cols | t_ref->grant.privilege)))
     {
       goto err;                                 // impossible
     }
@@ -10148,6 +10263,7 @@ bool mysql_create_user(THD *thd, List <LEX_USER> &list, bool handle_as_role)
 
   mysql_rwlock_wrlock(&LOCK_grant);
   mysql_mutex_lock(&acl_cache->lock);
+  grant_version++;
 
   while ((user_name= user_list++))
   {
@@ -10309,6 +10425,7 @@ bool mysql_drop_user(THD *thd, List <LEX_USER> &list, bool handle_as_role)
 
   mysql_rwlock_wrlock(&LOCK_grant);
   mysql_mutex_lock(&acl_cache->lock);
+  grant_version++;
 
   while ((tmp_user_name= user_list++))
   {
@@ -10419,6 +10536,7 @@ bool mysql_rename_user(THD *thd, List <LEX_USER> &list)
 
   mysql_rwlock_wrlock(&LOCK_grant);
   mysql_mutex_lock(&acl_cache->lock);
+  grant_version++;
 
   while ((tmp_user_from= user_list++))
   {
@@ -10505,6 +10623,7 @@ int mysql_alter_user(THD* thd, List<LEX_USER> &users_list)
   /* Lock ACL data structures until we finish altering all users. */
   mysql_rwlock_wrlock(&LOCK_grant);
   mysql_mutex_lock(&acl_cache->lock);
+  grant_version++;
 
   LEX_USER *tmp_lex_user;
   List_iterator<LEX_USER> users_list_iterator(users_list);
@@ -10620,6 +10739,7 @@ bool mysql_revoke_all(THD *thd,  List <LEX_USER> &list)
 
   mysql_rwlock_wrlock(&LOCK_grant);
   mysql_mutex_lock(&acl_cache->lock);
+  grant_version++;
 
   LEX_USER *lex_user, *tmp_lex_user;
   List_iterator <LEX_USER> user_list(list);
@@ -10911,6 +11031,7 @@ bool sp_revoke_privileges(THD *thd, const char *sp_db, const char *sp_name,
 
   mysql_rwlock_wrlock(&LOCK_grant);
   mysql_mutex_lock(&acl_cache->lock);
+  grant_version++;
 
   /* Remove procedure access */
   do
@@ -12135,6 +12256,7 @@ static bool send_server_handshake_packet(MPVIO_EXT *mpvio,
     thd->client_capabilities|= CLIENT_TRANSACTIONS;
 
   thd->client_capabilities|= CAN_CLIENT_COMPRESS;
+  thd->client_capabilities|= CAN_CLIENT_ZSTD_COMPRESSION;
 
   if (ssl_acceptor_fd)
   {
@@ -12471,6 +12593,7 @@ read_client_connect_attrs(char **ptr, char *end, CHARSET_INFO *from_cs)
       current_thd->variables.log_warnings)
     sql_print_warning("Connection attributes of length %llu were truncated",
                       length);
+  *ptr+= length;
   return false;
 }
 
@@ -12861,6 +12984,13 @@ static ulong parse_client_handshake_packet(MPVIO_EXT *mpvio,
                                 mpvio->auth_info.thd->charset()))
     return packet_error;
 
+  if (thd->client_capabilities & CLIENT_ZSTD_COMPRESSION_ALGORITHM)
+  {
+    if (next_field >= ((char *)net->read_pos) + pkt_len)
+      return packet_error;
+    net->compress_level= (uchar) *next_field++;
+  }
+
   /*
     if the acl_user needs a different plugin to authenticate
     (specified in GRANT ... AUTHENTICATED VIA plugin_name ..)
@@ -13276,6 +13406,7 @@ bool acl_authenticate(THD *thd, uint com_change_user_pkt_len)
                                                              : COM_CONNECT;
   DBUG_ENTER("acl_authenticate");
 
+  thd->grant_table_memo.reset();
   bzero(&mpvio, sizeof(mpvio));
   mpvio.read_packet= server_mpvio_read_packet;
   mpvio.write_packet= server_mpvio_write_packet;
@@ -805,6 +805,21 @@ static bool mysql_admin_table(THD* thd, TABLE_LIST* tables,
       DBUG_PRINT("admin", ("operator_func returned: %d", result_code));
     }
 
+    if (compl_result_code == HA_ADMIN_OK && collect_eis &&
+        !lex->with_persistent_for_clause &&
+        statistics_are_up_to_date(thd, table->table))
+    {
+      collect_eis= FALSE;
+      protocol->prepare_for_resend();
+      protocol->store(table_name, system_charset_info);
+      protocol->store(operator_name, system_charset_info);
+      protocol->store(STRING_WITH_LEN("status"), system_charset_info);
+      protocol->store(STRING_WITH_LEN("Engine-independent statistics are "
+                                      "up to date"), system_charset_info);
+      if (protocol->write())
+        goto err;
+    }
+
     if (compl_result_code == HA_ADMIN_OK && collect_eis)
     {
       /*
@@ -658,6 +658,13 @@ THD::THD(my_thread_id id, bool is_wsrep_applier, bool skip_global_sys_var_lock)
     variables that allocates memory for this THD
   */
   THD *old_THR_THD= current_thd;
+  /*
+    Keep up to 128K of freed MEM_ROOT blocks for the next statements.
+    The memory stays accounted to this THD until ~THD() frees it.
+  */
+  init_mem_root_block_cache(&mem_root_block_cache, 128*1024);
+  mem_root_block_cache.allocated= &status_var.mem_root_blocks_allocated;
+  mem_root_block_cache.reused= &status_var.mem_root_blocks_reused;
   set_current_thd(this);
   status_var.local_memory_used= sizeof(THD);
   status_var.max_local_memory_used= status_var.local_memory_used;
@@ -693,6 +700,7 @@ THD::THD(my_thread_id id, bool is_wsrep_applier, bool skip_global_sys_var_lock)
   catalog= (char*)"std"; // the only catalog we have for now
   main_security_ctx.init();
   security_ctx= &main_security_ctx;
+  grant_table_memo.reset();
   no_errors= 0;
   password= 0;
   query_start_sec_part_used= 0;
@@ -1370,6 +1378,7 @@ void THD::change_user(void)
     get_stmt_da()->clear_warning_info(0);
 
   init();
+  text_stmt_cache.reset();
   stmt_map.reset();
   my_hash_init(&user_vars, system_charset_info, USER_VARS_HASH_SIZE, 0, 0,
                (my_hash_get_key) get_var_key,
@@ -1377,10 +1386,7 @@ void THD::change_user(void)
   my_hash_init(&sequences, system_charset_info, SEQUENCES_HASH_SIZE, 0, 0,
                (my_hash_get_key) get_sequence_last_key,
                (my_hash_free_key) free_sequence_last, HASH_THREAD_SPECIFIC);
-  sp_cache_clear(&sp_proc_cache);
-  sp_cache_clear(&sp_func_cache);
-  sp_cache_clear(&sp_package_spec_cache);
-  sp_cache_clear(&sp_package_body_cache);
+  sp_cache_release(this, stored_program_cache_size);
 }
 
 /**
@@ -1509,10 +1515,7 @@ void THD::cleanup(void)
 
   my_hash_free(&user_vars);
   my_hash_free(&sequences);
-  sp_cache_clear(&sp_proc_cache);
-  sp_cache_clear(&sp_func_cache);
-  sp_cache_clear(&sp_package_spec_cache);
-  sp_cache_clear(&sp_package_body_cache);
+  sp_cache_release(this, stored_program_cache_size);
   auto_inc_intervals_forced.empty();
   auto_inc_intervals_in_cur_stmt_for_binlog.empty();
 
@@ -1551,6 +1554,7 @@ void THD::free_connection()
   mysql_audit_free_thd(this);
   main_security_ctx.destroy();
   /* close all prepared statements, to save memory */
+  text_stmt_cache.reset();
   stmt_map.reset();
   free_connection_done= 1;
 #if defined(ENABLED_PROFILING)
@@ -1572,6 +1576,7 @@ void THD::reset_for_reuse()
   change_user();                                // Calls cleanup() & init()
   get_stmt_da()->reset_diagnostics_area();
   main_security_ctx.init();  
+  grant_table_memo.reset();
   failed_com_change_user= 0;
   is_fatal_error= 0;
   client_capabilities= 0;
@@ -1655,6 +1660,7 @@ THD::~THD()
     lf_hash_put_pins(tdc_hash_pins);
   if (xid_hash_pins)
     lf_hash_put_pins(xid_hash_pins);
+  free_mem_root_block_cache(&mem_root_block_cache);
   /* Ensure everything is freed */
   status_var.local_memory_used-= sizeof(THD);
 
@@ -4017,6 +4023,119 @@ Statement_map::~Statement_map()
   my_hash_free(&st_hash);
 }
 
+
+C_MODE_START
+
+static uchar *get_stmt_query_hash_key(Statement *entry, size_t *length,
+                                      my_bool not_used __attribute__((unused)))
+{
+  *length= entry->query_length();
+  return (uchar*) entry->query();
+}
+
+C_MODE_END
+
+
+Text_statement_cache::Text_statement_cache()
+{
+  enum
+  {
+    START_STMT_HASH_SIZE = 16
+  };
+  my_hash_init(&st_hash, &my_charset_bin, START_STMT_HASH_SIZE, 0, 0,
+               (my_hash_get_key) get_stmt_query_hash_key,
+               delete_statement_as_hash_key, MYF(0));
+}
+
+
+/*
+  Insert a new statement to the connection-local text statement cache.
+
+  DESCRIPTION
+    Cached statements of all connections are accounted in
+    text_statement_cache_count, separately from prepared_stmt_count.
+    If max_text_statement_cache_count is reached, the least recently used
+    statement of this cache gives up its slot; if the cache is empty,
+    the statement is not cached.
+
+  RETURN VALUE
+    0  success
+    1  error: out of memory or max_text_statement_cache_count limit has
+       been reached. No error is sent to the client, the statement is
+       deleted.
+*/
+
+bool Text_statement_cache::insert(Statement *statement, ulong max_elements)
+{
+  enforce_limit(max_elements ? max_elements - 1 : 0);
+  mysql_mutex_lock(&LOCK_prepared_stmt_count);
+  if (text_statement_cache_count >= max_text_statement_cache_count && lru_list.head())
+  {
+    mysql_mutex_unlock(&LOCK_prepared_stmt_count);
+    erase(lru_list.head());
+    mysql_mutex_lock(&LOCK_prepared_stmt_count);
+  }
+  if (text_statement_cache_count >= max_text_statement_cache_count)
+  {
+    mysql_mutex_unlock(&LOCK_prepared_stmt_count);
+    delete statement;
+    return 1;
+  }
+  text_statement_cache_count++;
+  mysql_mutex_unlock(&LOCK_prepared_stmt_count);
+
+  if (my_hash_insert(&st_hash, (uchar*) statement))
+  {
+    delete statement;
+    release_count(1);
+    return 1;
+  }
+  lru_list.push_back(statement);
+  return 0;
+}
+
+
+void Text_statement_cache::release_count(ulong count)
+{
+  mysql_mutex_lock(&LOCK_prepared_stmt_count);
+  DBUG_ASSERT(text_statement_cache_count >= count);
+  text_statement_cache_count-= count;
+  mysql_mutex_unlock(&LOCK_prepared_stmt_count);
+}
+
+
+void Text_statement_cache::erase(Statement *statement)
+{
+  /* Unlinks the statement from lru_list in ~ilink() */
+  my_hash_delete(&st_hash, (uchar *) statement);
+  release_count(1);
+}
+
+
+void Text_statement_cache::enforce_limit(ulong max_elements)
+{
+  Statement *stmt;
+  while (st_hash.records > max_elements && (stmt= lru_list.head()))
+    erase(stmt);
+}
+
+
+void Text_statement_cache::reset()
+{
+  /* Must be first, hash_reset will reset st_hash.records */
+  if (st_hash.records)
+    release_count(st_hash.records);
+  my_hash_reset(&st_hash);
+}
+
+
+Text_statement_cache::~Text_statement_cache()
+{
+  if (st_hash.records)
+    release_count(st_hash.records);
+  my_hash_free(&st_hash);
+}
+
 bool my_var_user::set(THD *thd, Item *item)
 {
   Item_func_set_user_var *suv= new (thd->mem_root) Item_func_set_user_var(thd, &name, item);
@@ -613,6 +613,8 @@ typedef struct system_variables
   ulong use_stat_tables;
   ulong histogram_size;
   ulong histogram_type;
+  double sample_percentage;
+  ulong analyze_refresh_percentage;
   ulong preload_buff_size;
   ulong profiling_history_size;
   ulong read_buff_size;
@@ -637,6 +639,7 @@ typedef struct system_variables
   ulong progress_report_time;
   ulong completion_type;
   ulong query_cache_type;
+  ulong text_statement_cache_size;
   ulong tx_isolation;
   ulong updatable_views_with_limit;
   ulong alter_algorithm;
@@ -820,6 +823,12 @@ typedef struct system_status_var
   ulong filesort_rows_;
   ulong filesort_scan_count_;
   ulong filesort_pq_sorts_;
+  ulong text_stmt_cache_hits;
+  ulong text_stmt_cache_misses;
+  ulong mem_root_blocks_allocated;
+  ulong mem_root_blocks_reused;
+  ulong sp_shared_cache_hits;
+  ulong sp_shared_cache_misses;
 
   /* Features used */
   ulong feature_custom_aggregate_functions; /* +1 when custom aggregate
@@ -1235,6 +1244,49 @@ class Statement_map
   Statement *last_found_statement;
 };
 
+
+/**
+  Connection-local cache of prepared forms of text protocol statements.
+
+  Statements are looked up by their query text with literals replaced by
+  parameter markers, see mysql_text_stmt_cache_execute().
+  The least recently used statement is evicted when the cache is full.
+  Cached statements are not visible through Statement_map and are
+  accounted in text_statement_cache_count, not in prepared_stmt_count.
+*/
+
+class Text_statement_cache
+{
+public:
+  Text_statement_cache();
+
+  Statement *find(const char *key, size_t key_length)
+  {
+    Statement *stmt;
+    if ((stmt= (Statement *) my_hash_search(&st_hash, (uchar *) key,
+                                            key_length)))
+    {
+      /* Move to the most recently used end */
+      stmt->unlink();
+      lru_list.push_back(stmt);
+    }
+    return stmt;
+  }
+  /* Insert a statement, evicting old ones to fit in max_elements */
+  bool insert(Statement *statement, ulong max_elements);
+  void erase(Statement *statement);
+  /* Evict the least recently used statements down to max_elements */
+  void enforce_limit(ulong max_elements);
+  /* Erase all statements (calls Statement destructor) */
+  void reset();
+  ulong records() const { return st_hash.records; }
+  ~Text_statement_cache();
+private:
+  void release_count(ulong count);
+  HASH st_hash;
+  I_List<Statement> lru_list;
+};
+
 struct st_savepoint {
   struct st_savepoint *prev;
   char                *name;
@@ -1343,6 +1395,35 @@ class Security_context {
 };
 
 
+/**
+  Table level grants looked up for the main security context of a THD.
+
+  An entry stays valid as long as the grant version it was read with is
+  current, so repeated checks of the same tables need neither LOCK_grant
+  nor a column_priv_hash lookup. Entries are only read and written by the
+  owning thread. @see check_grant()
+*/
+
+struct Grant_table_memo
+{
+  static const uint SIZE= 8;
+  struct Entry
+  {
+    GRANT_TABLE *grant_table_user;
+    GRANT_TABLE *grant_table_role;
+    ulong privs;                                /* Table privileges */
+    ulong cols;                                 /* Column privileges */
+    uint version;                               /* grant_version */
+    uint key_length;
+    char key[MAX_DBKEY_LENGTH];                 /* db\0table_name\0 */
+  } entries[SIZE];
+  uint used, next;
+
+  /* Must be called whenever the main security context changes */
+  void reset() { used= next= 0; }
+};
+
+
 /**
   A registry for item tree transformations performed during
   query optimization. We register only those changes which require
@@ -2227,6 +2308,8 @@ class THD :public Statement,
   struct  system_status_var status_var; // Per thread statistic vars
   struct  system_status_var org_status_var; // For user statistics
   struct  system_status_var *initial_status_var; /* used by show status */
+  /* Free blocks of thread specific MEM_ROOTs, reused by this thread */
+  MEM_ROOT_BLOCK_CACHE mem_root_block_cache;
   THR_LOCK_INFO lock_info;              // Locking info of this thread
   /**
     Protects THD data accessed from other threads:
@@ -2247,6 +2330,9 @@ class THD :public Statement,
   /* all prepared statements and cursors of this connection */
   Statement_map stmt_map;
 
+  /* prepared forms of text protocol statements, see text_statement_cache_size */
+  Text_statement_cache text_stmt_cache;
+
   /* Last created prepared statement */
   Statement *last_stmt;
   inline void set_last_stmt(Statement *stmt)
@@ -2279,6 +2365,8 @@ class THD :public Statement,
 
   Security_context main_security_ctx;
   Security_context *security_ctx;
+  /* Table grants of main_security_ctx, see check_grant() */
+  Grant_table_memo grant_table_memo;
 
   /*
     Points to info-string that we show in SHOW PROCESSLIST
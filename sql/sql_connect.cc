@@ -1228,6 +1228,18 @@ void prepare_new_connection_state(THD* thd)
 
   if (thd->client_capabilities & CLIENT_COMPRESS)
     thd->net.compress=1;				// Use compression
+  else if (thd->client_capabilities & CLIENT_ZSTD_COMPRESSION_ALGORITHM)
+  {
+    thd->net.compress=1;
+    thd->net.compress_algorithm= MY_COMPRESS_ZSTD;
+  }
+
+  /*
+    A client may pipeline its commands, sending the next ones before the
+    results of the previous ones arrive. Read them ahead, do_command()
+    then gets them from the buffer without a recv() per command.
+  */
+  vio_set_buffered_read(thd->net.vio, TRUE);
 
   /*
     Much of this is duplicated in create_embedded_thd() for the
@@ -1492,9 +1504,15 @@ THD *CONNECT::create_thd(THD *thd)
 
   DBUG_EXECUTE_IF("simulate_failed_connection_2", DBUG_RETURN(0); );
 
+  if (!thd && (thd= get_thd_from_pool()))      // Deleted on failure
+  {
+    /* put_thd_in_pool() has detached the mysys_var of the old thread */
+    thd->set_mysys_var(my_thread_var);
+  }
   if (thd)
   {
     /* reuse old thd */
+    set_current_thd(thd);                       // For memory accounting
     thd->reset_for_reuse();
     /*
       reset tread_id's, but not thread_dbug_id's as the later isn't allowed
@@ -722,6 +722,8 @@ bool Explain_node::print_explain_json_cache(Json_writer *writer,
         double hit_ratio= double(cache_tracker->hit) / cache_reads * 100.0;
         writer->add_member("r_hit_ratio").add_double(hit_ratio);
       }
+      if (cache_tracker->evictions)
+        writer->add_member("r_evictions").add_ll(cache_tracker->evictions);
     }
     return true;
   }
@@ -0,0 +1,1038 @@
+/* Copyright (c) 2019, MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#include "mariadb.h"
+#include "sql_priv.h"
+#include "sql_class.h"
+#include "sql_select.h"                         // optimizer_flag
+#include "sql_expr_program.h"
+
+#define NO_JUMP UINT_MAX
+
+
+static inline void set_null(Expr_register *res)
+{
+  res->int_value= 0;                            /* also real_value= 0.0 */
+  res->null_value= true;
+}
+
+
+/* Reads the NULL flag of a column, the value too is 0 for a NULL */
+static inline bool field_is_null(Expr_register *res, const Field *field)
+{
+  if ((res->null_value= field->is_null()))
+    res->int_value= 0;
+  return res->null_value;
+}
+
+
+/* The TRUE/FALSE result of a comparison that gave cmp (-1, 0 or 1) */
+static inline void set_cmp_result(Expr_register *res, uint outcomes, int cmp)
+{
+  res->int_value= (outcomes >> (cmp + 1)) & 1;
+  res->null_value= false;
+}
+
+
+/* See Item_func_between::val_int_cmp_int_finalize() */
+static inline void set_between_result(Expr_register *res, uint flags,
+                                      bool min_null, bool max_null,
+                                      bool ge_min, bool le_max)
+{
+  bool negated= MY_TEST(flags & Expr_program::NEGATED);
+  if (!min_null && !max_null)
+  {
+    res->int_value= (ge_min && le_max) != negated;
+    res->null_value= false;
+    return;
+  }
+  if (min_null && max_null)
+    res->null_value= true;
+  else if (min_null)
+    res->null_value= le_max;                    // not null if false range.
+  else
+    res->null_value= ge_min;
+  res->int_value= !res->null_value && negated;
+}
+
+
+static inline int cmp_longlong(longlong a, longlong b)
+{
+  return a < b ? -1 : a == b ? 0 : 1;
+}
+
+
+static inline int cmp_ulonglong(ulonglong a, ulonglong b)
+{
+  return a < b ? -1 : a == b ? 0 : 1;
+}
+
+
+/* a * b, and true if it does not fit into a longlong */
+static inline bool mul_overflow(longlong a, longlong b, longlong *res)
+{
+  if (a == (int32) a && b == (int32) b)
+  {
+    *res= a * b;
+    return false;
+  }
+  *res= (longlong) ((ulonglong) a * (ulonglong) b);
+  if ((a == -1 && b == LONGLONG_MIN) || (b == -1 && a == LONGLONG_MIN))
+    return true;
+  return a != 0 && *res / a != b;
+}
+
+
+/**
+  Evaluate the program.
+
+  @return the same as val_int() of the item the program is built from
+*/
+
+longlong Expr_program::val_int()
+{
+  Expr_register *reg= registers;
+  const Expr_instr *ins= code, *end= code + code_length;
+
+  while (ins < end)
+  {
+    Expr_register *res= reg + ins->result;
+    const Expr_register *a= reg + ins->arg1, *b= reg + ins->arg2;
+
+    switch ((Opcode) ins->code) {
+    case FIELD_TINY:
+      if (!field_is_null(res, ins->field))
+        res->int_value= (longlong) ((signed char*) ins->field->ptr)[0];
+      break;
+    case FIELD_UTINY:
+      if (!field_is_null(res, ins->field))
+        res->int_value= (longlong) ins->field->ptr[0];
+      break;
+    case FIELD_SHORT:
+      if (!field_is_null(res, ins->field))
+        res->int_value= (longlong) sint2korr(ins->field->ptr);
+      break;
+    case FIELD_USHORT:
+      if (!field_is_null(res, ins->field))
+        res->int_value= (longlong) uint2korr(ins->field->ptr);
+      break;
+    case FIELD_INT24:
+      if (!field_is_null(res, ins->field))
+        res->int_value= (longlong) sint3korr(ins->field->ptr);
+      break;
+    case FIELD_UINT24:
+      if (!field_is_null(res, ins->field))
+        res->int_value= (longlong) uint3korr(ins->field->ptr);
+      break;
+    case FIELD_LONG:
+      if (!field_is_null(res, ins->field))
+        res->int_value= (longlong) sint4korr(ins->field->ptr);
+      break;
+    case FIELD_ULONG:
+      if (!field_is_null(res, ins->field))
+        res->int_value= (longlong) uint4korr(ins->field->ptr);
+      break;
+    case FIELD_LONGLONG:
+      if (!field_is_null(res, ins->field))
+        res->int_value= sint8korr(ins->field->ptr);
+      break;
+    case FIELD_FLOAT:
+      if (!field_is_null(res, ins->field))
+      {
+        float nr;
+        float4get(nr, ins->field->ptr);
+        res->real_value= (double) nr;
+      }
+      break;
+    case FIELD_DOUBLE:
+      if (!field_is_null(res, ins->field))
+        float8get(res->real_value, ins->field->ptr);
+      break;
+    case FIELD_IS_NULL:
+      res->int_value= ins->field->is_null();
+      res->null_value= false;
+      break;
+    case FIELD_IS_NOT_NULL:
+      res->int_value= !ins->field->is_null();
+      res->null_value= false;
+      break;
+
+    case ITEM_INT:
+      res->int_value= ins->item->val_int();
+      res->null_value= ins->item->null_value;
+      break;
+    case ITEM_REAL:
+      res->real_value= ins->item->val_real();
+      res->null_value= ins->item->null_value;
+      break;
+    case ITEM_BOOL:
+      res->int_value= ins->item->val_bool();
+      res->null_value= ins->item->null_value;
+      break;
+
+    case INT_TO_REAL:
+      res->real_value= (double) a->int_value;
+      res->null_value= a->null_value;
+      break;
+    case UINT_TO_REAL:
+      res->real_value= ulonglong2double((ulonglong) a->int_value);
+      res->null_value= a->null_value;
+      break;
+    case REAL_TO_BOOL:
+      res->int_value= a->real_value != 0.0;
+      res->null_value= a->null_value;
+      break;
+
+    case CMP_INT:
+      if (a->null_value || b->null_value)
+        set_null(res);
+      else
+        set_cmp_result(res, ins->flags,
+                       cmp_longlong(a->int_value, b->int_value));
+      break;
+    case CMP_UINT:
+      if (a->null_value || b->null_value)
+        set_null(res);
+      else
+        set_cmp_result(res, ins->flags,
+                       cmp_ulonglong((ulonglong) a->int_value,
+                                     (ulonglong) b->int_value));
+      break;
+    case CMP_INT_UINT:
+      if (a->null_value || b->null_value)
+        set_null(res);
+      else
+        set_cmp_result(res, ins->flags,
+                       a->int_value < 0 ? -1 :
+                       cmp_ulonglong((ulonglong) a->int_value,
+                                     (ulonglong) b->int_value));
+      break;
+    case CMP_UINT_INT:
+      if (a->null_value || b->null_value)
+        set_null(res);
+      else
+        set_cmp_result(res, ins->flags,
+                       b->int_value < 0 ? 1 :
+                       cmp_ulonglong((ulonglong) a->int_value,
+                                     (ulonglong) b->int_value));
+      break;
+    case CMP_REAL:
+      if (a->null_value || b->null_value)
+        set_null(res);
+      else
+        set_cmp_result(res, ins->flags,
+                       a->real_value < b->real_value ? -1 :
+                       a->real_value == b->real_value ? 0 : 1);
+      break;
+
+    case BETWEEN_INT:
+      if (a->null_value)
+        set_null(res);
+      else
+      {
+        const Expr_register *c= reg + ins->arg3;
+        Longlong_hybrid value(a->int_value,
+                              MY_TEST(ins->flags & UNSIGNED_ARG1));
+        Longlong_hybrid min(b->int_value, MY_TEST(ins->flags & UNSIGNED_ARG2));
+        Longlong_hybrid max(c->int_value, MY_TEST(ins->flags & UNSIGNED_ARG3));
+        set_between_result(res, ins->flags, b->null_value, c->null_value,
+                           value.cmp(min) >= 0, value.cmp(max) <= 0);
+      }
+      break;
+    case BETWEEN_REAL:
+      if (a->null_value)
+        set_null(res);
+      else
+      {
+        const Expr_register *c= reg + ins->arg3;
+        set_between_result(res, ins->flags, b->null_value, c->null_value,
+                           a->real_value >= b->real_value,
+                           a->real_value <= c->real_value);
+      }
+      break;
+    case IN_INT:
+    case IN_REAL:
+      /* See Item_func_in::val_int() */
+      if (a->null_value)
+        set_null(res);
+      else
+      {
+        bool found= ins->code == IN_INT ?
+          ((in_longlong*) ins->array)->
+            find_longlong(a->int_value,
+                          MY_TEST(ins->flags & UNSIGNED_ARG1)) :
+          ((in_double*) ins->array)->find_double(a->real_value);
+        res->null_value= !found && (ins->flags & HAVE_NULL);
+        res->int_value= !res->null_value &&
+                        found != MY_TEST(ins->flags & NEGATED);
+      }
+      break;
+
+    case NOT:
+      res->null_value= a->null_value;
+      res->int_value= !a->null_value && !a->int_value;
+      break;
+    case COND_INIT:
+      res->null_value= false;
+      break;
+    case AND_ARG:
+      /* See Item_cond_and::val_int() */
+      if (!a->int_value)
+      {
+        if ((ins->flags & ABORT_ON_NULL) || !a->null_value)
+        {
+          res->int_value= 0;
+          res->null_value= false;
+          ins= code + ins->jump;
+          continue;
+        }
+        res->null_value= true;
+      }
+      break;
+    case AND_END:
+      res->int_value= !res->null_value;
+      break;
+    case OR_ARG:
+      if (a->int_value)
+      {
+        res->int_value= 1;
+        res->null_value= false;
+        ins= code + ins->jump;
+        continue;
+      }
+      if (a->null_value)
+        res->null_value= true;
+      break;
+    case OR_END:
+      res->int_value= 0;
+      break;
+    case TRIG_COND:
+      if (!*ins->trig_var)
+      {
+        res->int_value= 1;
+        res->null_value= false;
+        ins= code + ins->jump;
+        continue;
+      }
+      break;
+    case TRIG_END:
+      /* Item_func_trig_cond::val_int() does not set null_value */
+      res->int_value= a->int_value;
+      res->null_value= false;
+      break;
+    case SKIP_IF_NULL:
+      if (a->null_value)
+      {
+        set_null(res);
+        ins= code + ins->jump;
+        continue;
+      }
+      break;
+
+    /*
+      The integer operations are done on signed values only, the rare
+      overflows are left to the item to report.
+    */
+    case PLUS_INT:
+      if (a->null_value || b->null_value)
+        set_null(res);
+      else
+      {
+        longlong nr= (longlong) ((ulonglong) a->int_value +
+                                 (ulonglong) b->int_value);
+        if (unlikely(((a->int_value ^ nr) & (b->int_value ^ nr)) < 0))
+          goto int_overflow;
+        res->int_value= nr;
+        res->null_value= false;
+      }
+      break;
+    case MINUS_INT:
+      if (a->null_value || b->null_value)
+        set_null(res);
+      else
+      {
+        longlong nr= (longlong) ((ulonglong) a->int_value -
+                                 (ulonglong) b->int_value);
+        if (unlikely(((a->int_value ^ b->int_value) &
+                      (a->int_value ^ nr)) < 0))
+          goto int_overflow;
+        res->int_value= nr;
+        res->null_value= false;
+      }
+      break;
+    case MUL_INT:
+      if (a->null_value || b->null_value)
+        set_null(res);
+      else
+      {
+        longlong nr;
+        if (unlikely(mul_overflow(a->int_value, b->int_value, &nr)))
+          goto int_overflow;
+        res->int_value= nr;
+        res->null_value= false;
+      }
+      break;
+    case NEG_INT:
+      if (a->null_value)
+        set_null(res);
+      else
+      {
+        if (unlikely(a->int_value == LONGLONG_MIN))
+          goto int_overflow;
+        res->int_value= -a->int_value;
+        res->null_value= false;
+      }
+      break;
+    int_overflow:
+      res->int_value= ins->func->val_int();
+      res->null_value= ins->func->null_value;
+      break;
+
+    case PLUS_REAL:
+    case MINUS_REAL:
+    case MUL_REAL:
+    case DIV_REAL:
+      if (a->null_value || b->null_value)
+        set_null(res);
+      else
+      {
+        double nr;
+        switch ((Opcode) ins->code) {
+        case PLUS_REAL:
+          nr= a->real_value + b->real_value;
+          break;
+        case MINUS_REAL:
+          nr= a->real_value - b->real_value;
+          break;
+        case MUL_REAL:
+          nr= a->real_value * b->real_value;
+          break;
+        default:
+          if (b->real_value == 0.0)
+          {
+            ins->func->signal_divide_by_null();
+            set_null(res);
+            goto next;
+          }
+          nr= a->real_value / b->real_value;
+          break;
+        }
+        res->real_value= std::isfinite(nr) ? nr :
+                         ins->func->raise_float_overflow();
+        res->null_value= false;
+      }
+      break;
+    case NEG_REAL:
+      res->real_value= -a->real_value;
+      res->null_value= a->null_value;
+      break;
+
+    case NO_OPCODE:
+      DBUG_ASSERT(0);
+      break;
+    }
+next:
+    ins++;
+  }
+  return reg[result].int_value;
+}
+
+
+Expr_program *Expr_program_builder::build(Item *item)
+{
+  uint result= add_int(item);
+  if (out_of_memory || !native_instructions)
+    return NULL;
+
+  Expr_instr *code_copy;
+  Expr_register *registers_copy;
+  if (!multi_alloc_root(thd->mem_root,
+                        &code_copy, sizeof(Expr_instr) * code.elements(),
+                        &registers_copy,
+                        sizeof(Expr_register) * registers.elements(),
+                        NullS))
+    return NULL;
+  memcpy(code_copy, code.front(), sizeof(Expr_instr) * code.elements());
+  memcpy(registers_copy, registers.front(),
+         sizeof(Expr_register) * registers.elements());
+  return new (thd->mem_root) Expr_program(code_copy, (uint) code.elements(),
+                                          registers_copy, result);
+}
+
+
+uint Expr_program_builder::new_register()
+{
+  Expr_register reg;
+  reg.int_value= 0;
+  reg.null_value= false;
+  if (registers.append(reg))
+  {
+    out_of_memory= true;
+    return 0;
+  }
+  return (uint) registers.elements() - 1;
+}
+
+
+Expr_instr *Expr_program_builder::add_instr(Expr_program::Opcode opcode,
+                                            uint result)
+{
+  Expr_instr ins;
+  bzero(&ins, sizeof(ins));
+  ins.code= opcode;
+  ins.result= result;
+  if (code.append(ins))
+  {
+    out_of_memory= true;
+    return &oom_instr;
+  }
+  return code.back();
+}
+
+
+uint Expr_program_builder::add_leaf(Item *item, Expr_program::Opcode opcode)
+{
+  uint result= new_register();
+  add_instr(opcode, result)->item= item;
+  return result;
+}
+
+
+/*
+  The register with the value of the item, in the type of its cmp_type(),
+  or -1 if there are no native instructions for it
+*/
+
+int Expr_program_builder::add_native(Item *item)
+{
+  if ((item->type() == Item::CONST_ITEM || item->type() == Item::NULL_ITEM) &&
+      item->basic_const_item() && !item->get_settable_routine_parameter())
+  {
+    /*
+      Literals, not parameters or SP variables, are evaluated once into a
+      register that no instruction writes
+    */
+    uint reg= new_register();
+    if (out_of_memory)
+      return -1;
+    Expr_register *value= &registers.at(reg);
+    if (item->cmp_type() == REAL_RESULT)
+      value->real_value= item->val_real();
+    else
+      value->int_value= item->val_int();
+    value->null_value= item->null_value;
+    return (int) reg;
+  }
+  return item->expr_program_add(this);
+}
+
+
+uint Expr_program_builder::add_int(Item *item)
+{
+  int reg;
+  if ((item->cmp_type() == INT_RESULT || item->type() == Item::NULL_ITEM) &&
+      (reg= add_native(item)) >= 0)
+    return (uint) reg;
+  return add_leaf(item, Expr_program::ITEM_INT);
+}
+
+
+uint Expr_program_builder::add_real(Item *item)
+{
+  int reg;
+  if (item->type() == Item::NULL_ITEM && (reg= add_native(item)) >= 0)
+    return (uint) reg;
+  switch (item->cmp_type()) {
+  case REAL_RESULT:
+    if ((reg= add_native(item)) >= 0)
+      return (uint) reg;
+    break;
+  case INT_RESULT:
+    /* Item::val_real() of an integer item */
+    if ((reg= add_native(item)) >= 0)
+    {
+      uint result= new_register();
+      add_instr(item->unsigned_flag ? Expr_program::UINT_TO_REAL :
+                                      Expr_program::INT_TO_REAL,
+                result)->arg1= (uint) reg;
+      return result;
+    }
+    break;
+  default:
+    break;
+  }
+  return add_leaf(item, Expr_program::ITEM_REAL);
+}
+
+
+uint Expr_program_builder::add_bool(Item *item)
+{
+  int reg;
+  /* Item::val_bool() */
+  switch (item->cmp_type()) {
+  case INT_RESULT:
+    if ((reg= add_native(item)) >= 0)
+      return (uint) reg;
+    break;
+  case REAL_RESULT:
+    if ((reg= add_native(item)) >= 0)
+    {
+      uint result= new_register();
+      add_instr(Expr_program::REAL_TO_BOOL, result)->arg1= (uint) reg;
+      return result;
+    }
+    break;
+  default:
+    break;
+  }
+  return add_leaf(item, Expr_program::ITEM_BOOL);
+}
+
+
+/*
+  Skips the evaluation of the second argument of a comparison when the
+  first one is NULL, as Arg_comparator does. Call skip_to_here() with
+  the result after the instruction of the comparison.
+*/
+
+uint Expr_program_builder::skip_if_null(Item *item, uint reg, uint result)
+{
+  if (!item->maybe_null)
+    return NO_JUMP;
+  Expr_instr *ins= add_instr(Expr_program::SKIP_IF_NULL, result);
+  ins->arg1= reg;
+  return (uint) code.elements() - 1;
+}
+
+
+void Expr_program_builder::skip_to_here(uint jump)
+{
+  if (jump != NO_JUMP && !out_of_memory)
+    code.at(jump).jump= (uint) code.elements();
+}
+
+
+int Expr_program_builder::add_field(Field *field)
+{
+  Expr_program::Opcode opcode;
+  bool unsigned_flag= field->flags & UNSIGNED_FLAG;
+  switch (field->type()) {
+  case MYSQL_TYPE_TINY:
+    opcode= unsigned_flag ? Expr_program::FIELD_UTINY :
+                            Expr_program::FIELD_TINY;
+    break;
+  case MYSQL_TYPE_SHORT:
+    opcode= unsigned_flag ? Expr_program::FIELD_USHORT :
+                            Expr_program::FIELD_SHORT;
+    break;
+  case MYSQL_TYPE_INT24:
+    opcode= unsigned_flag ? Expr_program::FIELD_UINT24 :
+                            Expr_program::FIELD_INT24;
+    break;
+  case MYSQL_TYPE_LONG:
+    opcode= unsigned_flag ? Expr_program::FIELD_ULONG :
+                            Expr_program::FIELD_LONG;
+    break;
+  case MYSQL_TYPE_LONGLONG:
+    opcode= Expr_program::FIELD_LONGLONG;
+    break;
+  case MYSQL_TYPE_FLOAT:
+    opcode= Expr_program::FIELD_FLOAT;
+    break;
+  case MYSQL_TYPE_DOUBLE:
+    opcode= Expr_program::FIELD_DOUBLE;
+    break;
+  default:
+    return -1;
+  }
+  uint result= new_register();
+  add_instr(opcode, result)->field= field;
+  native_instructions++;
+  return (int) result;
+}
+
+
+int Expr_program_builder::add_field_is_null(Field *field, bool negated)
+{
+  uint result= new_register();
+  add_instr(negated ? Expr_program::FIELD_IS_NOT_NULL :
+                      Expr_program::FIELD_IS_NULL, result)->field= field;
+  native_instructions++;
+  return (int) result;
+}
+
+
+int Expr_program_builder::add_compare(Expr_program::Opcode opcode,
+                                      uint outcomes, Item *a, Item *b)
+{
+  bool real= opcode == Expr_program::CMP_REAL;
+  uint result= new_register();
+  uint reg_a= real ? add_real(a) : add_int(a);
+  uint jump= skip_if_null(a, reg_a, result);
+  uint reg_b= real ? add_real(b) : add_int(b);
+  if (jump == code.elements() - 1)
+  {
+    /* Nothing to skip */
+    code.pop();
+    jump= NO_JUMP;
+  }
+  Expr_instr *ins= add_instr(opcode, result);
+  ins->flags= outcomes;
+  ins->arg1= reg_a;
+  ins->arg2= reg_b;
+  skip_to_here(jump);
+  native_instructions++;
+  return (int) result;
+}
+
+
+int Expr_program_builder::add_between(Expr_program::Opcode opcode,
+                                      Item **args, bool negated)
+{
+  bool real= opcode == Expr_program::BETWEEN_REAL;
+  uint result= new_register();
+  uint value= real ? add_real(args[0]) : add_int(args[0]);
+  uint jump= skip_if_null(args[0], value, result);
+  uint min= real ? add_real(args[1]) : add_int(args[1]);
+  uint max= real ? add_real(args[2]) : add_int(args[2]);
+  if (jump == code.elements() - 1)
+  {
+    code.pop();
+    jump= NO_JUMP;
+  }
+  Expr_instr *ins= add_instr(opcode, result);
+  ins->flags= (negated ? Expr_program::NEGATED : 0);
+  if (!real)
+    ins->flags|= (args[0]->unsigned_flag ? Expr_program::UNSIGNED_ARG1 : 0) |
+                 (args[1]->unsigned_flag ? Expr_program::UNSIGNED_ARG2 : 0) |
+                 (args[2]->unsigned_flag ? Expr_program::UNSIGNED_ARG3 : 0);
+  ins->arg1= value;
+  ins->arg2= min;
+  ins->arg3= max;
+  skip_to_here(jump);
+  native_instructions++;
+  return (int) result;
+}
+
+
+int Expr_program_builder::add_in(Expr_program::Opcode opcode,
+                                 in_vector *array, Item *value,
+                                 bool have_null, bool negated)
+{
+  uint reg= opcode == Expr_program::IN_INT ? add_int(value) :
+                                             add_real(value);
+  uint result= new_register();
+  Expr_instr *ins= add_instr(opcode, result);
+  ins->flags= (negated ? Expr_program::NEGATED : 0) |
+              (have_null ? Expr_program::HAVE_NULL : 0) |
+              (value->unsigned_flag ? Expr_program::UNSIGNED_ARG1 : 0);
+  ins->arg1= reg;
+  ins->array= array;
+  native_instructions++;
+  return (int) result;
+}
+
+
+int Expr_program_builder::add_not(Item *arg)
+{
+  uint reg= add_bool(arg);
+  uint result= new_register();
+  add_instr(Expr_program::NOT, result)->arg1= reg;
+  return (int) result;
+}
+
+
+int Expr_program_builder::add_and(List<Item> *args, bool abort_on_null)
+{
+  List_iterator_fast<Item> li(*args);
+  Item *item;
+  uint result= new_register();
+  size_t start= code.elements();
+  add_instr(Expr_program::COND_INIT, result);
+  while ((item= li++))
+  {
+    uint reg= add_bool(item);
+    Expr_instr *ins= add_instr(Expr_program::AND_ARG, result);
+    ins->arg1= reg;
+    ins->flags= abort_on_null ? Expr_program::ABORT_ON_NULL : 0;
+  }
+  add_instr(Expr_program::AND_END, result);
+  if (out_of_memory)
+    return -1;
+  /* The arguments that are FALSE go past AND_END */
+  for (size_t i= start; i < code.elements(); i++)
+  {
+    Expr_instr *ins= &code.at(i);
+    if (ins->code == Expr_program::AND_ARG && ins->result == result)
+      ins->jump= (uint) code.elements();
+  }
+  return (int) result;
+}
+
+
+int Expr_program_builder::add_or(List<Item> *args)
+{
+  List_iterator_fast<Item> li(*args);
+  Item *item;
+  uint result= new_register();
+  size_t start= code.elements();
+  add_instr(Expr_program::COND_INIT, result);
+  while ((item= li++))
+  {
+    uint reg= add_bool(item);
+    add_instr(Expr_program::OR_ARG, result)->arg1= reg;
+  }
+  add_instr(Expr_program::OR_END, result);
+  if (out_of_memory)
+    return -1;
+  for (size_t i= start; i < code.elements(); i++)
+  {
+    Expr_instr *ins= &code.at(i);
+    if (ins->code == Expr_program::OR_ARG && ins->result == result)
+      ins->jump= (uint) code.elements();
+  }
+  return (int) result;
+}
+
+
+int Expr_program_builder::add_trig_cond(bool *trig_var, Item *arg)
+{
+  uint result= new_register();
+  uint start= (uint) code.elements();
+  add_instr(Expr_program::TRIG_COND, result)->trig_var= trig_var;
+  uint reg= add_int(arg);
+  add_instr(Expr_program::TRIG_END, result)->arg1= reg;
+  if (out_of_memory)
+    return -1;
+  code.at(start).jump= (uint) code.elements();
+  return (int) result;
+}
+
+
+int Expr_program_builder::add_arithmetic(Item_func *func,
+                                         Expr_program::Opcode int_code,
+                                         Expr_program::Opcode real_code)
+{
+  Item **args= func->arguments();
+  uint arg_count= func->argument_count();
+  uint reg[2];
+  Expr_program::Opcode opcode;
+
+  switch (func->cmp_type()) {
+  case INT_RESULT:
+    /* The int_op() of the function, of signed values only */
+    if (int_code == Expr_program::NO_OPCODE || func->unsigned_flag)
+      return -1;
+    for (uint i= 0; i < arg_count; i++)
+    {
+      if (args[i]->unsigned_flag)
+        return -1;
+    }
+    for (uint i= 0; i < arg_count; i++)
+      reg[i]= add_int(args[i]);
+    opcode= int_code;
+    break;
+  case REAL_RESULT:
+    for (uint i= 0; i < arg_count; i++)
+      reg[i]= add_real(args[i]);
+    opcode= real_code;
+    break;
+  default:
+    return -1;
+  }
+  uint result= new_register();
+  Expr_instr *ins= add_instr(opcode, result);
+  ins->arg1= reg[0];
+  ins->arg2= reg[arg_count - 1];
+  ins->func= func;
+  native_instructions++;
+  return (int) result;
+}
+
+
+void Compiled_cond::compile(THD *thd, Item *item)
+{
+  cond= item;
+  program= NULL;
+  if (optimizer_flag(thd, OPTIMIZER_SWITCH_CONDITION_COMPILATION))
+  {
+    Expr_program_builder builder(thd);
+    program= builder.build(item);
+  }
+}
+
+
+/*
+  Item::expr_program_add() of the items with native instructions
+*/
+
+int Item_field::expr_program_add(Expr_program_builder *prog)
+{
+  /* Not of Item_default_value, Item_insert_value and the like */
+  if (type() != FIELD_ITEM)
+    return -1;
+  return prog->add_field(field);
+}
+
+
+int Item_bool_rowready_func2::expr_program_add(Expr_program_builder *prog)
+{
+  uint outcomes;
+  switch (functype()) {
+  case EQ_FUNC:
+    outcomes= Expr_program::CMP_EQ;
+    break;
+  case NE_FUNC:
+    outcomes= Expr_program::CMP_LT | Expr_program::CMP_GT;
+    break;
+  case LT_FUNC:
+    outcomes= Expr_program::CMP_LT;
+    break;
+  case LE_FUNC:
+    outcomes= Expr_program::CMP_LT | Expr_program::CMP_EQ;
+    break;
+  case GE_FUNC:
+    outcomes= Expr_program::CMP_GT | Expr_program::CMP_EQ;
+    break;
+  case GT_FUNC:
+    outcomes= Expr_program::CMP_GT;
+    break;
+  default:                                      // <=>
+    return -1;
+  }
+
+  Expr_program::Opcode opcode;
+  if (cmp.func == &Arg_comparator::compare_int_signed)
+    opcode= Expr_program::CMP_INT;
+  else if (cmp.func == &Arg_comparator::compare_int_unsigned)
+    opcode= Expr_program::CMP_UINT;
+  else if (cmp.func == &Arg_comparator::compare_int_signed_unsigned)
+    opcode= Expr_program::CMP_INT_UINT;
+  else if (cmp.func == &Arg_comparator::compare_int_unsigned_signed)
+    opcode= Expr_program::CMP_UINT_INT;
+  else if (cmp.func == &Arg_comparator::compare_real)
+    opcode= Expr_program::CMP_REAL;
+  else
+    return -1;
+  /* cmp.a and cmp.b may point to the converted constants */
+  return prog->add_compare(opcode, outcomes, *cmp.a, *cmp.b);
+}
+
+
+int Item_func_between::expr_program_add(Expr_program_builder *prog)
+{
+  switch (m_comparator.cmp_type()) {
+  case INT_RESULT:
+    return prog->add_between(Expr_program::BETWEEN_INT, args, negated);
+  case REAL_RESULT:
+    return prog->add_between(Expr_program::BETWEEN_REAL, args, negated);
+  default:
+    return -1;
+  }
+}
+
+
+int Item_func_in::expr_program_add(Expr_program_builder *prog)
+{
+  if (!array)
+    return -1;
+  if (array->type_handler() == &type_handler_longlong)
+    return prog->add_in(Expr_program::IN_INT, array, args[0], have_null,
+                        negated);
+  if (array->type_handler() == &type_handler_double)
+    return prog->add_in(Expr_program::IN_REAL, array, args[0], have_null,
+                        negated);
+  return -1;
+}
+
+
+int Item_func_not::expr_program_add(Expr_program_builder *prog)
+{
+  /* Not of Item_func_not_all */
+  if (functype() != NOT_FUNC)
+    return -1;
+  return prog->add_not(args[0]);
+}
+
+
+int Item_func_isnull::expr_program_add(Expr_program_builder *prog)
+{
+  /* Not of Item_is_not_null_test */
+  if (functype() != ISNULL_FUNC || const_item() ||
+      args[0]->type() != FIELD_ITEM)
+    return -1;
+  return prog->add_field_is_null(((Item_field*) args[0])->field, false);
+}
+
+
+int Item_func_isnotnull::expr_program_add(Expr_program_builder *prog)
+{
+  if (args[0]->type() != FIELD_ITEM)
+    return -1;
+  return prog->add_field_is_null(((Item_field*) args[0])->field, true);
+}
+
+
+int Item_cond_and::expr_program_add(Expr_program_builder *prog)
+{
+  return prog->add_and(argument_list(), abort_on_null);
+}
+
+
+int Item_cond_or::expr_program_add(Expr_program_builder *prog)
+{
+  return prog->add_or(argument_list());
+}
+
+
+int Item_func_trig_cond::expr_program_add(Expr_program_builder *prog)
+{
+  return prog->add_trig_cond(trig_var, args[0]);
+}
+
+
+int Item_func_plus::expr_program_add(Expr_program_builder *prog)
+{
+  return prog->add_arithmetic(this, Expr_program::PLUS_INT,
+                              Expr_program::PLUS_REAL);
+}
+
+
+int Item_func_minus::expr_program_add(Expr_program_builder *prog)
+{
+  return prog->add_arithmetic(this, Expr_program::MINUS_INT,
+                              Expr_program::MINUS_REAL);
+}
+
+
+int Item_func_mul::expr_program_add(Expr_program_builder *prog)
+{
+  return prog->add_arithmetic(this, Expr_program::MUL_INT,
+                              Expr_program::MUL_REAL);
+}
+
+
+int Item_func_div::expr_program_add(Expr_program_builder *prog)
+{
+  return prog->add_arithmetic(this, Expr_program::NO_OPCODE,
+                              Expr_program::DIV_REAL);
+}
+
+
+int Item_func_neg::expr_program_add(Expr_program_builder *prog)
+{
+  return prog->add_arithmetic(this, Expr_program::NEG_INT,
+                              Expr_program::NEG_REAL);
+}
@@ -0,0 +1,195 @@
+#ifndef SQL_EXPR_PROGRAM_INCLUDED
+#define SQL_EXPR_PROGRAM_INCLUDED
+/* Copyright (c) 2019, MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+
+/*
+  Conditions compiled into flat programs.
+
+  The condition attached to a table is evaluated for every row that the
+  table access method returns, and evaluating an Item tree costs a chain
+  of virtual val_*() calls, null_value stores and Arg_comparator
+  dispatch for every node. Expr_program_builder walks the tree once and
+  lowers the nodes that Item::expr_program_add() knows into a flat array
+  of type specialized instructions over a register file: columns of the
+  INT and DOUBLE types, numeric constants, comparisons, BETWEEN and IN
+  lists of numbers, AND, OR, NOT, IS [NOT] NULL and + - * / of INT and
+  DOUBLE values. Everything else becomes a leaf instruction that calls
+  the Item, so that every condition can be compiled and gives exactly
+  what Item::val_int() gives, with the same warnings and errors.
+*/
+
+#include "item.h"
+#include "sql_array.h"
+
+class in_vector;
+
+
+/* A value in an Expr_program, an int or a double depending on the register */
+struct Expr_register
+{
+  union
+  {
+    longlong int_value;
+    double real_value;
+  };
+  bool null_value;
+};
+
+
+struct Expr_instr
+{
+  uint code;                                    /* Expr_program::Opcode */
+  uint flags;
+  uint result, arg1, arg2, arg3;                /* Register numbers */
+  uint jump;                                    /* Instruction number */
+  union
+  {
+    Field *field;
+    Item *item;
+    Item_func *func;
+    bool *trig_var;
+    in_vector *array;
+  };
+};
+
+
+class Expr_program :public Sql_alloc
+{
+public:
+  enum Opcode
+  {
+    /* Columns, the values are read directly from the record */
+    FIELD_TINY, FIELD_UTINY, FIELD_SHORT, FIELD_USHORT, FIELD_INT24,
+    FIELD_UINT24, FIELD_LONG, FIELD_ULONG, FIELD_LONGLONG, FIELD_FLOAT,
+    FIELD_DOUBLE, FIELD_IS_NULL, FIELD_IS_NOT_NULL,
+    /* Everything else, val_int(), val_real() or val_bool() of the item */
+    ITEM_INT, ITEM_REAL, ITEM_BOOL,
+    INT_TO_REAL, UINT_TO_REAL, REAL_TO_BOOL,
+    /* Comparisons of two values, as the Arg_comparator::compare_* do */
+    CMP_INT, CMP_UINT, CMP_INT_UINT, CMP_UINT_INT, CMP_REAL,
+    BETWEEN_INT, BETWEEN_REAL, IN_INT, IN_REAL,
+    NOT, COND_INIT, AND_ARG, AND_END, OR_ARG, OR_END, TRIG_COND, TRIG_END,
+    /* Goes to jump with a NULL result if arg1 is NULL */
+    SKIP_IF_NULL,
+    /* Arithmetics, func raises the overflow errors */
+    PLUS_INT, MINUS_INT, MUL_INT, NEG_INT,
+    PLUS_REAL, MINUS_REAL, MUL_REAL, DIV_REAL, NEG_REAL,
+    NO_OPCODE
+  };
+
+  /* flags of the CMP_* instructions: the outcomes that give TRUE */
+  static const uint CMP_LT= 1, CMP_EQ= 2, CMP_GT= 4;
+  /* flags of BETWEEN, IN, AND and of the register signedness */
+  static const uint NEGATED= 1, ABORT_ON_NULL= 2, HAVE_NULL= 4;
+  static const uint UNSIGNED_ARG1= 8, UNSIGNED_ARG2= 16, UNSIGNED_ARG3= 32;
+
+  Expr_program(Expr_instr *code_arg, uint length_arg,
+               Expr_register *registers_arg, uint result_arg)
+    :code(code_arg), code_length(length_arg), registers(registers_arg),
+     result(result_arg)
+  {}
+  longlong val_int();
+
+private:
+  Expr_instr *code;
+  uint code_length;
+  Expr_register *registers;
+  uint result;
+};
+
+
+/*
+  Builds an Expr_program from an Item tree.
+
+  The add_*() functions return the register that holds the value of the
+  item when the instructions added for it have run: the value of the
+  native instructions if item->expr_program_add() lowers the item, or
+  of a leaf that calls the item.
+*/
+
+class Expr_program_builder
+{
+public:
+  Expr_program_builder(THD *thd_arg)
+    :thd(thd_arg), native_instructions(0), out_of_memory(false)
+  {}
+  /* NULL if the item is not worth a program, it is then used as it is */
+  Expr_program *build(Item *item);
+
+  /* The value of the item as an int, a double, or as val_bool() gives it */
+  uint add_int(Item *item);
+  uint add_real(Item *item);
+  uint add_bool(Item *item);
+
+  /* Used by Item::expr_program_add() */
+  int add_field(Field *field);
+  int add_field_is_null(Field *field, bool negated);
+  int add_compare(Expr_program::Opcode code, uint outcomes, Item *a, Item *b);
+  int add_between(Expr_program::Opcode code, Item **args, bool negated);
+  int add_in(Expr_program::Opcode code, in_vector *array, Item *value,
+             bool have_null, bool negated);
+  int add_not(Item *arg);
+  int add_and(List<Item> *args, bool abort_on_null);
+  int add_or(List<Item> *args);
+  int add_trig_cond(bool *trig_var, Item *arg);
+  int add_arithmetic(Item_func *func, Expr_program::Opcode int_code,
+                     Expr_program::Opcode real_code);
+
+private:
+  THD *thd;
+  Dynamic_array<Expr_instr> code;
+  Dynamic_array<Expr_register> registers;
+  uint native_instructions;
+  bool out_of_memory;
+  Expr_instr oom_instr;                 /* Written when code.append() fails */
+
+  uint new_register();
+  Expr_instr *add_instr(Expr_program::Opcode opcode, uint result);
+  uint add_leaf(Item *item, Expr_program::Opcode opcode);
+  int add_native(Item *item);
+  uint skip_if_null(Item *item, uint reg, uint result);
+  void skip_to_here(uint jump);
+};
+
+
+/*
+  The program of a condition that is evaluated row by row. It is compiled
+  when the condition is first evaluated, and again when the condition has
+  been replaced. An all zero Compiled_cond is valid, as JOIN_TABs are
+  bzero()ed rather than constructed. Without
+  optimizer_switch='condition_compilation=on' the condition is evaluated
+  with Item::val_int() as it is.
+*/
+
+class Compiled_cond
+{
+  Item *cond;                           /* The item program is for */
+  Expr_program *program;                /* NULL: evaluate cond as it is */
+  void compile(THD *thd, Item *item);
+public:
+  Compiled_cond(): cond(0), program(0) {}
+  void reset() { cond= 0; program= 0; }
+  /* item->val_int() */
+  longlong val_int(THD *thd, Item *item)
+  {
+    if (unlikely(item != cond))
+      compile(thd, item);
+    return program ? program->val_int() : item->val_int();
+  }
+};
+
+#endif /* SQL_EXPR_PROGRAM_INCLUDED */
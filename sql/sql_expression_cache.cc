@@ -44,7 +44,7 @@ Expression_cache_tmptable::Expression_cache_tmptable(THD *thd,
                                                      List<Item> &dependants,
                                                      Item *value)
   :cache_table(NULL), table_thd(thd), tracker(NULL), items(dependants), val(value),
-   hit(0), miss(0), inited (0)
+   hit(0), miss(0), evictions(0), inited (0), hash_table(NULL)
 {
   DBUG_ENTER("Expression_cache_tmptable::Expression_cache_tmptable");
   DBUG_VOID_RETURN;
@@ -57,16 +57,163 @@ Expression_cache_tmptable::Expression_cache_tmptable(THD *thd,
 
 void Expression_cache_tmptable::disable_cache()
 {
-  if (cache_table->file->inited)
-    cache_table->file->ha_index_end();
-  free_tmp_table(table_thd, cache_table);
-  cache_table= NULL;
+  if (hash_table)
+  {
+    delete hash_table;
+    hash_table= NULL;
+  }
+  if (cache_table)
+  {
+    if (cache_table->file->inited)
+      cache_table->file->ha_index_end();
+    free_tmp_table(table_thd, cache_table);
+    cache_table= NULL;
+  }
   update_tracker();
   if (tracker)
     tracker->cache= NULL;
 }
 
 
+Expression_cache_hash_table::
+Expression_cache_hash_table(uint key_parts_arg, size_t max_memory)
+  :entries(NULL), key_parts(key_parts_arg), buckets(16), max_buckets(1),
+   clock_hand(0)
+{
+  DBUG_ASSERT(key_parts <= MAX_KEY_PARTS);
+  size_t limit= max_memory / (BUCKET_SIZE * sizeof(Entry));
+  set_if_smaller(limit, MAX_BUCKETS);
+  /* The largest power of two that fits, the hash masks with buckets - 1 */
+  while (max_buckets * 2 <= limit)
+    max_buckets*= 2;
+  set_if_smaller(buckets, max_buckets);
+}
+
+
+Expression_cache_hash_table::~Expression_cache_hash_table()
+{
+  my_free(entries);
+}
+
+
+bool Expression_cache_hash_table::init()
+{
+  return !(entries= (Entry *) my_malloc(buckets * BUCKET_SIZE * sizeof(Entry),
+                                        MYF(MY_ZEROFILL | MY_THREAD_SPECIFIC)));
+}
+
+
+ulong Expression_cache_hash_table::hash(const longlong *key) const
+{
+  ulonglong nr= key_parts;
+  for (uint i= 0; i < key_parts; i++)
+  {
+    nr^= (ulonglong) key[i];
+    nr*= 0x9E3779B97F4A7C15ULL;
+    nr^= nr >> 29;
+  }
+  return (ulong) (nr ^ (nr >> 32));
+}
+
+
+Expression_cache_hash_table::Entry *
+Expression_cache_hash_table::find(const longlong *key)
+{
+  Entry *entry= get_bucket(key);
+  for (Entry *end= entry + BUCKET_SIZE; entry < end; entry++)
+  {
+    if (entry->used && !memcmp(entry->key, key, key_parts * sizeof(longlong)))
+    {
+      entry->referenced= true;
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+
+Expression_cache_hash_table::Entry *
+Expression_cache_hash_table::find_free(Entry *bucket)
+{
+  for (Entry *entry= bucket, *end= bucket + BUCKET_SIZE; entry < end; entry++)
+  {
+    if (!entry->used)
+      return entry;
+  }
+  return NULL;
+}
+
+
+/**
+  Double the number of buckets and move the entries to the new buckets
+
+  @note
+  An entry that does not fit in its new bucket is dropped.
+
+  @retval FALSE OK
+  @retval TRUE  Out of memory, the table is not changed
+*/
+
+bool Expression_cache_hash_table::grow()
+{
+  Entry *old_entries= entries;
+  Entry *old_end= entries + buckets * BUCKET_SIZE;
+  Entry *new_entries;
+  if (!(new_entries= (Entry *) my_malloc(2 * buckets * BUCKET_SIZE *
+                                         sizeof(Entry),
+                                         MYF(MY_ZEROFILL |
+                                             MY_THREAD_SPECIFIC))))
+    return TRUE;
+  entries= new_entries;
+  buckets*= 2;
+  for (Entry *entry= old_entries; entry < old_end; entry++)
+  {
+    Entry *to;
+    if (entry->used && (to= find_free(get_bucket(entry->key))))
+      *to= *entry;
+  }
+  my_free(old_entries);
+  return FALSE;
+}
+
+
+/**
+  Get an entry for a new key
+
+  @param key          parameter values
+  @param [out] evicted  set to TRUE if the entry replaced another one
+
+  @details
+  The caller must fill in the result value of the returned entry.
+*/
+
+Expression_cache_hash_table::Entry *
+Expression_cache_hash_table::insert(const longlong *key, bool *evicted)
+{
+  Entry *bucket= get_bucket(key);
+  Entry *entry= find_free(bucket);
+  *evicted= FALSE;
+  if (!entry && buckets < max_buckets && !grow())
+    entry= find_free(bucket= get_bucket(key));
+  if (!entry)
+  {
+    for (;;)
+    {
+      entry= bucket + clock_hand;
+      clock_hand= (clock_hand + 1) % BUCKET_SIZE;
+      if (!entry->referenced)
+        break;
+      entry->referenced= false;
+    }
+    *evicted= TRUE;
+  }
+  memcpy(entry->key, key, key_parts * sizeof(longlong));
+  entry->used= true;
+  entry->referenced= false;
+  return entry;
+}
+
+
 /**
   Field enumerator for TABLE::add_tmp_key
 
@@ -112,6 +259,12 @@ void Expression_cache_tmptable::init()
   /* add result field */
   items.push_front(val);
 
+  if (init_hash_table())
+  {
+    update_tracker();
+    DBUG_VOID_RETURN;
+  }
+
   cache_table_param.init();
   /* dependent items and result */
   cache_table_param.field_count= items.elements;
@@ -178,13 +331,57 @@ void Expression_cache_tmptable::init()
 }
 
 
+/**
+  Create the hash table for the cache if the expression suits it
+
+  @details
+  The hash table is used when there are a few parameters, and they and the
+  result are integer or real values that can be stored without conversion.
+
+  @retval TRUE  the hash table is used
+  @retval FALSE the cache needs a temporary table
+*/
+
+bool Expression_cache_tmptable::init_hash_table()
+{
+  List_iterator_fast<Item> li(items);
+  Item *item;
+  size_t max_memory;
+  DBUG_ENTER("Expression_cache_tmptable::init_hash_table");
+
+  if (items.elements - 1 > Expression_cache_hash_table::MAX_KEY_PARTS ||
+      (val->cmp_type() != INT_RESULT && val->cmp_type() != REAL_RESULT))
+    DBUG_RETURN(FALSE);
+  li++; // skip result field
+  while ((item= li++))
+  {
+    if (item->cmp_type() != INT_RESULT)
+      DBUG_RETURN(FALSE);
+  }
+
+  max_memory= (size_t) MY_MIN(table_thd->variables.tmp_memory_table_size,
+                              table_thd->variables.max_heap_table_size);
+  if (!(hash_table= new (table_thd->mem_root)
+        Expression_cache_hash_table(items.elements - 1, max_memory)) ||
+      hash_table->init())
+  {
+    delete hash_table;
+    hash_table= NULL;
+    DBUG_RETURN(FALSE);
+  }
+  hash_result_is_real= val->cmp_type() == REAL_RESULT;
+  DBUG_PRINT("info", ("Using hash table"));
+  DBUG_RETURN(TRUE);
+}
+
+
 Expression_cache_tmptable::~Expression_cache_tmptable()
 {
   /* Add accumulated statistics */
   statistic_add(subquery_cache_miss, miss, &LOCK_status);
   statistic_add(subquery_cache_hit, hit, &LOCK_status);
 
-  if (cache_table)
+  if (cache_table || hash_table)
     disable_cache();
   else
   {
@@ -214,6 +411,9 @@ Expression_cache::result Expression_cache_tmptable::check_value(Item **value)
   int res;
   DBUG_ENTER("Expression_cache_tmptable::check_value");
 
+  if (hash_table)
+    DBUG_RETURN(check_value_in_hash_table(value));
+
   if (cache_table)
   {
     DBUG_PRINT("info", ("status: %u  has_record %u",
@@ -243,6 +443,81 @@ Expression_cache::result Expression_cache_tmptable::check_value(Item **value)
 }
 
 
+/**
+  Check if the current parameters of the expression are in hash_table
+
+  @details
+  The parameter values are remembered for put_value(). As with the index
+  lookup of the temporary table, a NULL parameter is never found.
+*/
+
+Expression_cache::result
+Expression_cache_tmptable::check_value_in_hash_table(Item **value)
+{
+  List_iterator_fast<Item> li(items);
+  Expression_cache_hash_table::Entry *entry;
+  Item *item;
+  uint i= 0;
+  DBUG_ENTER("Expression_cache_tmptable::check_value_in_hash_table");
+
+  hash_key_is_null= FALSE;
+  li++; // skip result field
+  while ((item= li++))
+  {
+    hash_key[i++]= item->val_int();
+    if (unlikely(table_thd->is_error()))
+      DBUG_RETURN(ERROR);
+    if (item->null_value)
+    {
+      hash_key_is_null= TRUE;
+      miss++;
+      DBUG_RETURN(MISS);
+    }
+  }
+
+  if (!(entry= hash_table->find(hash_key)))
+  {
+    miss++;
+    DBUG_RETURN(MISS);
+  }
+
+  hit++;
+  if (hash_result_is_real)
+    ((Item_cache_real *) val)->set_value(entry->real_value,
+                                         entry->null_value);
+  else
+    ((Item_cache_int *) val)->set_value(entry->int_value, entry->null_value);
+  *value= val;
+  DBUG_RETURN(HIT);
+}
+
+
+/**
+  Put the value of the expression for the parameters of the last
+  check_value() call into hash_table
+*/
+
+void Expression_cache_tmptable::put_value_into_hash_table(Item *value)
+{
+  Expression_cache_hash_table::Entry *entry;
+  bool evicted;
+  DBUG_ENTER("Expression_cache_tmptable::put_value_into_hash_table");
+
+  if (hash_key_is_null)
+    DBUG_VOID_RETURN;
+
+  entry= hash_table->insert(hash_key, &evicted);
+  if (evicted)
+    evictions++;
+  if (hash_result_is_real)
+    entry->real_value= value->val_real();
+  else
+    entry->int_value= value->val_int();
+  entry->null_value= value->null_value;
+  DBUG_VOID_RETURN;
+}
+
+
 /**
   Put a new entry into the expression cache
 
@@ -262,6 +537,12 @@ my_bool Expression_cache_tmptable::put_value(Item *value)
   DBUG_ENTER("Expression_cache_tmptable::put_value");
   DBUG_ASSERT(inited);
 
+  if (hash_table)
+  {
+    put_value_into_hash_table(value);
+    DBUG_RETURN(FALSE);
+  }
+
   if (!cache_table)
   {
     DBUG_PRINT("info", ("No table so behave as we successfully put value"));
@@ -80,16 +80,16 @@ class Expression_cache_tracker :public Sql_alloc
 public:
   enum expr_cache_state {UNINITED, STOPPED, OK};
   Expression_cache_tracker(Expression_cache *c) :
-    cache(c), hit(0), miss(0), state(UNINITED)
+    cache(c), hit(0), miss(0), evictions(0), state(UNINITED)
   {}
 
   Expression_cache *cache;
-  ulong hit, miss;
+  ulong hit, miss, evictions;
   enum expr_cache_state state;
 
   static const char* state_str[3];
-  void set(ulong h, ulong m, enum expr_cache_state s)
-  {hit= h; miss= m; state= s;}
+  void set(ulong h, ulong m, ulong e, enum expr_cache_state s)
+  {hit= h; miss= m; evictions= e; state= s;}
 
   void fetch_current_stats()
   {
@@ -99,8 +99,70 @@ class Expression_cache_tracker :public Sql_alloc
 };
 
 
+/**
+  In-memory hash table for an expression cache with integer parameters
+
+  @details
+  The table is set associative: the hash value of the parameters selects
+  a bucket of BUCKET_SIZE entries. The table doubles its number of buckets
+  when a bucket is full until it reaches the memory limit. After that a new
+  entry replaces one in its bucket, chosen with the CLOCK algorithm: every
+  hit marks the entry as referenced, and the replacement skips referenced
+  entries once, clearing the mark.
+*/
+
+class Expression_cache_hash_table :public Sql_alloc
+{
+public:
+  /* Maximum number of expression parameters */
+  static const uint MAX_KEY_PARTS= 4;
+  static const uint BUCKET_SIZE= 8;
+  /* Upper bound of the number of buckets, whatever the memory limit */
+  static const ulong MAX_BUCKETS= 1UL << 20;
+
+  struct Entry
+  {
+    longlong key[MAX_KEY_PARTS];
+    union
+    {
+      longlong int_value;
+      double real_value;
+    };
+    bool used;
+    bool referenced;
+    bool null_value;
+  };
+
+  Expression_cache_hash_table(uint key_parts_arg, size_t max_memory);
+  ~Expression_cache_hash_table();
+  bool init();
+  Entry *find(const longlong *key);
+  Entry *insert(const longlong *key, bool *evicted);
+
+private:
+  ulong hash(const longlong *key) const;
+  Entry *get_bucket(const longlong *key) const
+  {
+    return entries + (hash(key) & (buckets - 1)) * BUCKET_SIZE;
+  }
+  Entry *find_free(Entry *bucket);
+  bool grow();
+
+  Entry *entries;
+  uint key_parts;
+  /* Number of buckets, a power of two */
+  ulong buckets;
+  ulong max_buckets;
+  uint clock_hand;
+};
+
+
 /**
   Implementation of expression cache over a temporary table
+
+  @note
+  If all the parameters and the result are integer or real values, the
+  cache uses an Expression_cache_hash_table instead of the table.
 */
 
 class Expression_cache_tmptable :public Expression_cache
@@ -124,15 +186,19 @@ class Expression_cache_tmptable :public Expression_cache
   {
     if (tracker)
     {
-      tracker->set(hit, miss, (inited ? (cache_table ?
-                                         Expression_cache_tracker::OK :
-                                         Expression_cache_tracker::STOPPED) :
-                               Expression_cache_tracker::UNINITED));
+      tracker->set(hit, miss, evictions,
+                   (inited ? ((cache_table || hash_table) ?
+                              Expression_cache_tracker::OK :
+                              Expression_cache_tracker::STOPPED) :
+                    Expression_cache_tracker::UNINITED));
     }
   }
 
 private:
   void disable_cache();
+  bool init_hash_table();
+  result check_value_in_hash_table(Item **value);
+  void put_value_into_hash_table(Item *value);
 
   /* tmp table parameters */
   TMP_TABLE_PARAM cache_table_param;
@@ -152,8 +218,16 @@ class Expression_cache_tmptable :public Expression_cache
   Item *val;
   /* hit/miss counters */
   ulong hit, miss;
+  /* Number of entries replaced in hash_table */
+  ulong evictions;
   /* Set on if the object has been succesfully initialized with init() */
   bool inited;
+  /* The hash table used instead of cache_table, or NULL */
+  Expression_cache_hash_table *hash_table;
+  /* Parameter values of the last check_value() call for hash_table */
+  longlong hash_key[Expression_cache_hash_table::MAX_KEY_PARTS];
+  bool hash_key_is_null;
+  bool hash_result_is_real;
 };
 
 #endif /* SQL_EXPRESSION_CACHE_INCLUDED */
@@ -8066,9 +8066,9 @@ void mysql_parse(THD *thd, char *rawbuf, uint length,
   {
     LEX *lex= thd->lex;
 
-    bool err= parse_sql(thd, parser_state, NULL, true);
-
-    if (likely(!err))
+    if (mysql_text_stmt_cache_execute(thd, rawbuf, length))
+      DBUG_PRINT("info", ("Executed from the text statement cache"));
+    else if (likely(!parse_sql(thd, parser_state, NULL, true)))
     {
       thd->m_statement_psi=
         MYSQL_REFINE_STATEMENT(thd->m_statement_psi,
@@ -8135,6 +8135,7 @@ void mysql_parse(THD *thd, char *rawbuf, uint length,
     sp_cache_enforce_limit(thd->sp_func_cache, stored_program_cache_size);
     sp_cache_enforce_limit(thd->sp_package_spec_cache, stored_program_cache_size);
     sp_cache_enforce_limit(thd->sp_package_body_cache, stored_program_cache_size);
+    thd->text_stmt_cache.enforce_limit(thd->variables.text_statement_cache_size);
     thd->end_statement();
     thd->cleanup_after_query();
     DBUG_ASSERT(thd->Item_change_list::is_empty());
@@ -3168,6 +3168,25 @@ void plugin_thdvar_init(THD *thd)
   thd->variables.dynamic_variables_size= 0;
   thd->variables.dynamic_variables_ptr= 0;
 
+  /*
+    On COM_CHANGE_USER and COM_RESET_CONNECTION the session normally
+    already holds references to the plugins of the global variables.
+    Keep them instead of unlocking and locking them again.
+  */
+  if (old_table_plugin &&
+      plugin_ref_to_int(old_table_plugin) ==
+      plugin_ref_to_int(global_system_variables.table_plugin) &&
+      plugin_ref_to_int(old_tmp_table_plugin) ==
+      plugin_ref_to_int(global_system_variables.tmp_table_plugin) &&
+      plugin_ref_to_int(old_enforced_table_plugin) ==
+      plugin_ref_to_int(global_system_variables.enforced_table_plugin))
+  {
+    thd->variables.table_plugin= old_table_plugin;
+    thd->variables.tmp_table_plugin= old_tmp_table_plugin;
+    thd->variables.enforced_table_plugin= old_enforced_table_plugin;
+    DBUG_VOID_RETURN;
+  }
+
   mysql_mutex_lock(&LOCK_plugin);
   thd->variables.table_plugin=
       intern_plugin_lock(NULL, global_system_variables.table_plugin);
@@ -3209,26 +3228,30 @@ static void cleanup_variables(struct system_variables *vars)
   st_bookmark *v;
   uint idx;
 
-  mysql_prlock_rdlock(&LOCK_system_variables_hash);
-  for (idx= 0; idx < bookmark_hash.records; idx++)
+  /* Plugin variables are copied on first use, nothing to free if unused */
+  if (vars->dynamic_variables_ptr)
   {
-    v= (st_bookmark*) my_hash_element(&bookmark_hash, idx);
+    mysql_prlock_rdlock(&LOCK_system_variables_hash);
+    for (idx= 0; idx < bookmark_hash.records; idx++)
+    {
+      v= (st_bookmark*) my_hash_element(&bookmark_hash, idx);
 
-    if (v->version > vars->dynamic_variables_version)
-      continue; /* not in vars */
+      if (v->version > vars->dynamic_variables_version)
+        continue; /* not in vars */
 
-    DBUG_ASSERT((uint)v->offset <= vars->dynamic_variables_head);
+      DBUG_ASSERT((uint)v->offset <= vars->dynamic_variables_head);
 
-    /* free allocated strings (PLUGIN_VAR_STR | PLUGIN_VAR_MEMALLOC) */
-    if ((v->key[0] & PLUGIN_VAR_TYPEMASK) == PLUGIN_VAR_STR &&
-         v->key[0] & BOOKMARK_MEMALLOC)
-    {
-      char **ptr= (char**)(vars->dynamic_variables_ptr + v->offset);
-      my_free(*ptr);
-      *ptr= NULL;
+      /* free allocated strings (PLUGIN_VAR_STR | PLUGIN_VAR_MEMALLOC) */
+      if ((v->key[0] & PLUGIN_VAR_TYPEMASK) == PLUGIN_VAR_STR &&
+           v->key[0] & BOOKMARK_MEMALLOC)
+      {
+        char **ptr= (char**)(vars->dynamic_variables_ptr + v->offset);
+        my_free(*ptr);
+        *ptr= NULL;
+      }
     }
+    mysql_prlock_unlock(&LOCK_system_variables_hash);
   }
-  mysql_prlock_unlock(&LOCK_system_variables_hash);
 
   DBUG_ASSERT(vars->table_plugin == NULL);
   DBUG_ASSERT(vars->tmp_table_plugin == NULL);
@@ -155,7 +155,11 @@ class Prepared_statement: public Statement
   enum flag_values
   {
     IS_IN_USE= 1,
-    IS_SQL_PREPARE= 2
+    IS_SQL_PREPARE= 2,
+    /* Owned by THD::text_stmt_cache, see mysql_text_stmt_cache_execute() */
+    IS_TEXT_CACHED= 4,
+    /* Cached text statement which can not be executed as prepared */
+    IS_TEXT_CACHE_BYPASS= 8
   };
 
   THD *thd;
@@ -194,6 +198,8 @@ class Prepared_statement: public Statement
   inline bool is_in_use() { return flags & (uint) IS_IN_USE; }
   inline bool is_sql_prepare() const { return flags & (uint) IS_SQL_PREPARE; }
   void set_sql_prepare() { flags|= (uint) IS_SQL_PREPARE; }
+  inline bool is_text_cached() const { return flags & (uint) IS_TEXT_CACHED; }
+  bool is_text_cache_valid(THD *thd) const;
   bool prepare(const char *packet, uint packet_length);
   bool execute_loop(String *expanded_query,
                     bool open_cursor,
@@ -214,6 +220,9 @@ class Prepared_statement: public Statement
   */
   MEM_ROOT main_mem_root;
   sql_mode_t m_sql_mode;
+  /* Character set environment the statement text was parsed in */
+  CHARSET_INFO *m_character_set_client;
+  CHARSET_INFO *m_collation_connection;
 private:
   bool set_db(const LEX_CSTRING *db);
   bool set_parameters(String *expanded_query,
@@ -3336,6 +3345,586 @@ void mysql_sql_stmt_execute(THD *thd)
   DBUG_VOID_RETURN;
 }
 
+/***************************************************************************
+ Text statement cache
+****************************************************************************/
+
+/*
+  Tokens of a text protocol statement, as far as
+  text_stmt_parameterize() needs to know about them.
+*/
+
+struct Text_stmt_token
+{
+  enum enum_type
+  {
+    END, WORD, NUMBER, STRING, QUOTED, OPERATOR, LPAREN, RPAREN, COMMA,
+    UNSUPPORTED
+  };
+  enum_type type;
+  const char *str;
+  size_t length;
+  /*
+    NUMBER: a plain decimal integer literal.
+    STRING: a single quoted string literal without escape sequences.
+  */
+  bool simple;
+
+  bool is_keyword(const char *keyword, size_t keyword_length) const
+  {
+    if (type != WORD || length != keyword_length)
+      return false;
+    for (size_t i= 0; i < length; i++)
+    {
+      if (my_toupper(&my_charset_latin1, (uchar) str[i]) != keyword[i])
+        return false;
+    }
+    return true;
+  }
+  bool is_operator(const char *op) const
+  {
+    return type == OPERATOR && length == strlen(op) &&
+           !memcmp(str, op, length);
+  }
+};
+
+
+/*
+  A minimal tokenizer for text_stmt_parameterize().
+
+  It only splits the statement into tokens, so that literals can be found.
+  Everything it does not understand (parameter markers, statement
+  delimiters, executable comments) is returned as UNSUPPORTED, and
+  the statement is then handled by the regular parser.
+*/
+
+class Text_stmt_tokenizer
+{
+  const char *m_ptr;
+  const char *m_end;
+  bool m_backslash_escapes;
+
+  static bool is_ident_char(char c)
+  {
+    return my_isalnum(&my_charset_latin1, c) || c == '_' || c == '$' ||
+           (uchar) c >= 0x80;
+  }
+  bool skip_space_and_comments();
+  void scan_quoted(Text_stmt_token *tok, char quote);
+
+public:
+  Text_stmt_tokenizer(const char *str, size_t length, bool backslash_escapes)
+   :m_ptr(str), m_end(str + length), m_backslash_escapes(backslash_escapes)
+  {}
+  void next(Text_stmt_token *tok);
+};
+
+
+/*
+  @retval false  success
+  @retval true   an unterminated or an executable comment
+*/
+
+bool Text_stmt_tokenizer::skip_space_and_comments()
+{
+  for (;;)
+  {
+    while (m_ptr < m_end && my_isspace(&my_charset_latin1, *m_ptr))
+      m_ptr++;
+    if (m_ptr + 1 < m_end && m_ptr[0] == '/' && m_ptr[1] == '*')
+    {
+      if (m_ptr + 2 < m_end && (m_ptr[2] == '!' || m_ptr[2] == 'M'))
+        return true;
+      const char *comment_end= m_ptr + 2;
+      for (; comment_end + 1 < m_end; comment_end++)
+      {
+        if (comment_end[0] == '*' && comment_end[1] == '/')
+          break;
+      }
+      if (comment_end + 1 >= m_end)
+        return true;
+      m_ptr= comment_end + 2;
+    }
+    else if (m_ptr < m_end &&
+             (*m_ptr == '#' ||
+              (m_ptr + 1 < m_end && m_ptr[0] == '-' && m_ptr[1] == '-' &&
+               (m_ptr + 2 == m_end || (uchar) m_ptr[2] <= ' '))))
+    {
+      while (m_ptr < m_end && *m_ptr != '\n')
+        m_ptr++;
+    }
+    else
+      return false;
+  }
+}
+
+
+void Text_stmt_tokenizer::scan_quoted(Text_stmt_token *tok, char quote)
+{
+  tok->simple= true;
+  for (m_ptr++; m_ptr < m_end; m_ptr++)
+  {
+    if (*m_ptr == '\\' && m_backslash_escapes && quote != '`')
+    {
+      tok->simple= false;
+      m_ptr++;
+    }
+    else if (*m_ptr == quote)
+    {
+      if (m_ptr + 1 < m_end && m_ptr[1] == quote)
+      {
+        tok->simple= false;
+        m_ptr++;
+      }
+      else
+      {
+        m_ptr++;
+        tok->length= m_ptr - tok->str;
+        return;
+      }
+    }
+  }
+  tok->type= Text_stmt_token::UNSUPPORTED;
+}
+
+
+void Text_stmt_tokenizer::next(Text_stmt_token *tok)
+{
+  static const char *operators[]=
+  { "<=>", "<=", ">=", "<>", "!=", "<<", ">>", "||", "&&", ":=", NULL };
+
+  tok->simple= false;
+  if (skip_space_and_comments())
+  {
+    tok->type= Text_stmt_token::UNSUPPORTED;
+    return;
+  }
+  tok->str= m_ptr;
+  tok->length= 1;
+  if (m_ptr == m_end)
+  {
+    tok->type= Text_stmt_token::END;
+    tok->length= 0;
+    return;
+  }
+
+  char c= *m_ptr;
+  if (c == '\'')
+  {
+    tok->type= Text_stmt_token::STRING;
+    scan_quoted(tok, c);
+  }
+  else if (c == '"' || c == '`')
+  {
+    tok->type= Text_stmt_token::QUOTED;
+    scan_quoted(tok, c);
+    tok->simple= false;
+  }
+  else if (my_isdigit(&my_charset_latin1, c))
+  {
+    tok->type= Text_stmt_token::NUMBER;
+    tok->simple= true;
+    while (m_ptr < m_end && my_isdigit(&my_charset_latin1, *m_ptr))
+      m_ptr++;
+    /* Decimals, exponents, hex literals and identifiers like 1a */
+    while (m_ptr < m_end && (is_ident_char(*m_ptr) || *m_ptr == '.'))
+    {
+      tok->simple= false;
+      m_ptr++;
+    }
+    tok->length= m_ptr - tok->str;
+  }
+  else if (is_ident_char(c))
+  {
+    tok->type= Text_stmt_token::WORD;
+    while (m_ptr < m_end && is_ident_char(*m_ptr))
+      m_ptr++;
+    tok->length= m_ptr - tok->str;
+  }
+  else if (c == '(' || c == ')' || c == ',')
+  {
+    tok->type= c == '(' ? Text_stmt_token::LPAREN :
+               c == ')' ? Text_stmt_token::RPAREN : Text_stmt_token::COMMA;
+    m_ptr++;
+  }
+  else if (c == '?' || c == ';' || c == '\0')
+    tok->type= Text_stmt_token::UNSUPPORTED;
+  else
+  {
+    tok->type= Text_stmt_token::OPERATOR;
+    for (const char **op= operators; *op; op++)
+    {
+      size_t op_length= strlen(*op);
+      if ((size_t) (m_end - m_ptr) >= op_length &&
+          !memcmp(m_ptr, *op, op_length))
+      {
+        tok->length= op_length;
+        break;
+      }
+    }
+    m_ptr+= tok->length;
+  }
+}
+
+
+#define TEXT_STMT_MAX_DEPTH 32
+
+/*
+  Parenthesis nesting level state of text_stmt_parameterize().
+*/
+
+struct Text_stmt_level
+{
+  /* IN (...) list or a VALUES row */
+  bool value_list;
+  /* After VALUES, parentheses open a row */
+  bool values_rows;
+  /* Inside a select list, literals determine the result set metadata */
+  bool select_list;
+  /* After BETWEEN, before its AND */
+  bool between;
+  /* Inside the LIMIT clause */
+  bool limit;
+};
+
+
+/**
+  Replace literals of a text protocol statement with parameter markers.
+
+  Only literals which can be replaced without changing the semantics or
+  the result set metadata of the statement are replaced: plain integers
+  and strings which are compared to something, are elements of an IN list
+  or of a VALUES row, or are LIMIT clause values.
+  Literals in select lists are never replaced, as they are used to name
+  the result set columns.
+
+  @param       thd     thread handle
+  @param       query   statement text
+  @param       length  length of the statement text
+  @param[out]  key     statement text with literals replaced by '?'
+  @param[out]  params  constant Items with the replaced literal values,
+                       allocated in thd->mem_root
+
+  @retval false  success
+  @retval true   the statement is not suitable for the text statement cache
+*/
+
+static bool
+text_stmt_parameterize(THD *thd, const char *query, size_t length,
+                       String *key, List<Item> *params)
+{
+  static const char *comparison_operators[]=
+  { "=", "<=>", "<=", ">=", "<>", "!=", "<", ">", NULL };
+  /* Keywords which may follow a replaced literal */
+  static const LEX_CSTRING terminators[]=
+  {
+    { STRING_WITH_LEN("AND") }, { STRING_WITH_LEN("OR") },
+    { STRING_WITH_LEN("WHERE") }, { STRING_WITH_LEN("ON") },
+    { STRING_WITH_LEN("JOIN") }, { STRING_WITH_LEN("INNER") },
+    { STRING_WITH_LEN("LEFT") }, { STRING_WITH_LEN("RIGHT") },
+    { STRING_WITH_LEN("CROSS") }, { STRING_WITH_LEN("GROUP") },
+    { STRING_WITH_LEN("HAVING") }, { STRING_WITH_LEN("ORDER") },
+    { STRING_WITH_LEN("LIMIT") }, { STRING_WITH_LEN("OFFSET") },
+    { STRING_WITH_LEN("UNION") }, { STRING_WITH_LEN("FOR") },
+    { STRING_WITH_LEN("LOCK") }, { STRING_WITH_LEN("INTO") },
+    { STRING_WITH_LEN("THEN") }, { STRING_WITH_LEN("ELSE") },
+    { STRING_WITH_LEN("WHEN") }, { STRING_WITH_LEN("END") },
+    { STRING_WITH_LEN("RETURNING") }, { NULL, 0 }
+  };
+  Text_stmt_tokenizer tokenizer(query, length,
+                                !(thd->variables.sql_mode &
+                                  MODE_NO_BACKSLASH_ESCAPES));
+  Text_stmt_level levels[TEXT_STMT_MAX_DEPTH];
+  Text_stmt_level *level= levels;
+  Text_stmt_token prev, tok, next;
+  const char *copied= query;
+  bool between_and= false;
+
+  bzero(levels, sizeof(levels));
+  tokenizer.next(&tok);
+  if (!tok.is_keyword(STRING_WITH_LEN("SELECT")) &&
+      !tok.is_keyword(STRING_WITH_LEN("INSERT")) &&
+      !tok.is_keyword(STRING_WITH_LEN("REPLACE")) &&
+      !tok.is_keyword(STRING_WITH_LEN("UPDATE")) &&
+      !tok.is_keyword(STRING_WITH_LEN("DELETE")))
+    return true;
+  prev.type= Text_stmt_token::END;
+  tokenizer.next(&next);
+
+  for (; tok.type != Text_stmt_token::END; prev= tok, tok= next,
+                                           tokenizer.next(&next))
+  {
+    bool after_between_and= between_and;
+    between_and= false;
+    switch (tok.type) {
+    case Text_stmt_token::END:
+    case Text_stmt_token::UNSUPPORTED:
+      return true;
+    case Text_stmt_token::WORD:
+      if (tok.is_keyword(STRING_WITH_LEN("SELECT")) ||
+          tok.is_keyword(STRING_WITH_LEN("RETURNING")))
+        level->select_list= true;
+      else if (tok.is_keyword(STRING_WITH_LEN("FROM")))
+        level->select_list= false;
+      else if (tok.is_keyword(STRING_WITH_LEN("BETWEEN")))
+        level->between= true;
+      else if (tok.is_keyword(STRING_WITH_LEN("AND")) && level->between)
+      {
+        level->between= false;
+        between_and= true;
+      }
+      level->values_rows= tok.is_keyword(STRING_WITH_LEN("VALUES")) ||
+                          tok.is_keyword(STRING_WITH_LEN("VALUE"));
+      level->limit= tok.is_keyword(STRING_WITH_LEN("LIMIT")) ||
+                    (level->limit && tok.is_keyword(STRING_WITH_LEN("OFFSET")));
+      break;
+    case Text_stmt_token::LPAREN:
+    {
+      bool value_list= prev.is_keyword(STRING_WITH_LEN("IN")) ||
+                       (level->values_rows &&
+                        (prev.type == Text_stmt_token::WORD ||
+                         prev.type == Text_stmt_token::COMMA));
+      if (++level == levels + TEXT_STMT_MAX_DEPTH)
+        return true;
+      bzero(level, sizeof(*level));
+      level->value_list= value_list;
+      break;
+    }
+    case Text_stmt_token::RPAREN:
+      if (level-- == levels)
+        return true;
+      level->limit= false;
+      break;
+    case Text_stmt_token::COMMA:
+      break;
+    case Text_stmt_token::OPERATOR:
+    case Text_stmt_token::QUOTED:
+      level->values_rows= level->limit= false;
+      break;
+    case Text_stmt_token::NUMBER:
+    case Text_stmt_token::STRING:
+    {
+      bool replace= false;
+      bool terminated= next.type == Text_stmt_token::END ||
+                       next.type == Text_stmt_token::RPAREN ||
+                       next.type == Text_stmt_token::COMMA;
+      for (const LEX_CSTRING *kw= terminators; !terminated && kw->str; kw++)
+        terminated= next.is_keyword(kw->str, kw->length);
+      if (tok.simple && terminated &&
+          (tok.type == Text_stmt_token::STRING || tok.length <= 18))
+      {
+        if (prev.type == Text_stmt_token::OPERATOR)
+        {
+          for (const char **op= comparison_operators; *op; op++)
+            replace|= prev.is_operator(*op);
+        }
+        else if (prev.type == Text_stmt_token::WORD)
+          replace= after_between_and ||
+                   prev.is_keyword(STRING_WITH_LEN("LIKE")) ||
+                   (prev.is_keyword(STRING_WITH_LEN("BETWEEN")) &&
+                    next.is_keyword(STRING_WITH_LEN("AND"))) ||
+                   (level->limit && tok.type == Text_stmt_token::NUMBER);
+        else if (prev.type == Text_stmt_token::LPAREN)
+          replace= level->value_list;
+        else if (prev.type == Text_stmt_token::COMMA)
+          replace= level->value_list ||
+                   (level->limit && tok.type == Text_stmt_token::NUMBER);
+        for (Text_stmt_level *lv= levels; replace && lv <= level; lv++)
+          replace= !lv->select_list;
+      }
+      level->values_rows= false;
+      if (!replace)
+        break;
+
+      Item *item;
+      if (tok.type == Text_stmt_token::NUMBER)
+      {
+        int error;
+        item= new (thd->mem_root)
+          Item_int(thd, tok.str, my_strtoll10(tok.str, NULL, &error),
+                   tok.length);
+      }
+      else
+      {
+        const char *str= tok.str + 1;
+        size_t str_length= tok.length - 2;
+        CHARSET_INFO *cs= thd->variables.character_set_client;
+        item= thd->make_string_literal(str, str_length,
+                                       my_string_repertoire(cs, str,
+                                                            str_length));
+      }
+      if (!item || params->push_back(item, thd->mem_root) ||
+          key->append(copied, tok.str - copied) || key->append('?'))
+        return true;
+      copied= tok.str + tok.length;
+      break;
+    }
+    }
+  }
+  if (level != levels)
+    return true;
+  return key->append(copied, query + length - copied);
+}
+
+
+bool Prepared_statement::is_text_cache_valid(THD *thd) const
+{
+  return m_sql_mode == thd->variables.sql_mode &&
+         m_character_set_client == thd->variables.character_set_client &&
+         m_collation_connection == thd->variables.collation_connection &&
+         db.length == thd->db.length &&
+         (!db.length || !memcmp(db.str, thd->db.str, db.length));
+}
+
+
+static bool text_stmt_cacheable_command(enum_sql_command sql_command)
+{
+  switch (sql_command) {
+  case SQLCOM_SELECT:
+  case SQLCOM_INSERT:
+  case SQLCOM_INSERT_SELECT:
+  case SQLCOM_REPLACE:
+  case SQLCOM_REPLACE_SELECT:
+  case SQLCOM_UPDATE:
+  case SQLCOM_UPDATE_MULTI:
+  case SQLCOM_DELETE:
+  case SQLCOM_DELETE_MULTI:
+    return true;
+  default:
+    return false;
+  }
+}
+
+
+/**
+  Execute a text protocol statement from the text statement cache.
+
+    Statements which differ only in literal values share one prepared
+    form in THD::text_stmt_cache, which is executed with the literal
+    values as parameters, the same way as EXECUTE ... USING does.
+    This saves parsing and context analysis of the statement, which are
+    done only once per connection and statement form.
+    Metadata changes of the used tables are detected by the usual
+    prepared statement validation and cause a re-prepare.
+
+    The cached statement is bound to the connection, as the prepared
+    statement tree is allocated in and refers to the THD it was
+    prepared in.
+
+  @param thd           thread handle
+  @param query         statement text
+  @param query_length  length of the statement text
+
+  @retval true   the statement was executed (or failed in the
+                 prepare step), the result is in thd->get_stmt_da()
+  @retval false  the statement must be parsed and executed as usual
+*/
+
+bool mysql_text_stmt_cache_execute(THD *thd, const char *query,
+                                   uint query_length)
+{
+  ulong cache_size= thd->variables.text_statement_cache_size;
+  LEX *lex= thd->lex;
+  Prepared_statement *stmt;
+  List<Item> params;
+  StringBuffer<1024> key(&my_charset_bin);
+  DBUG_ENTER("mysql_text_stmt_cache_execute");
+
+  if (!cache_size || thd->spcont || thd->in_sub_stmt || thd->slave_thread ||
+      (mqh_used && thd->user_connect) ||
+      thd->variables.character_set_client->escape_with_backslash_is_dangerous ||
+      text_stmt_parameterize(thd, query, query_length, &key, &params))
+    DBUG_RETURN(false);
+
+  if ((stmt= (Prepared_statement *) thd->text_stmt_cache.find(key.ptr(),
+                                                              key.length())) &&
+      !stmt->is_text_cache_valid(thd))
+  {
+    thd->text_stmt_cache.erase(stmt);
+    stmt= NULL;
+  }
+
+  if (!stmt)
+  {
+    status_var_increment(thd->status_var.text_stmt_cache_misses);
+    if (!(stmt= new Prepared_statement(thd)))
+      DBUG_RETURN(false);
+    stmt->set_sql_prepare();
+    stmt->flags|= (uint) Prepared_statement::IS_TEXT_CACHED;
+
+    /*
+      The prepare step frees thd->free_list in cleanup_after_query(),
+      keep the parameter values out of its reach.
+    */
+    Item *free_list_backup= thd->free_list;
+    thd->free_list= NULL;
+    Item_change_list_savepoint change_list_savepoint(thd);
+    bool error= stmt->prepare(key.ptr(), key.length());
+    change_list_savepoint.rollback(thd);
+    thd->free_items();
+    thd->free_list= free_list_backup;
+    if (error)
+    {
+      uint sql_errno= thd->get_stmt_da()->sql_errno();
+      /*
+        Report errors which the regular execution would not recover from
+        or which have already rolled the transaction back.
+      */
+      if (thd->is_fatal_error || thd->killed ||
+          sql_errno == ER_LOCK_DEADLOCK || sql_errno == ER_LOCK_WAIT_TIMEOUT)
+      {
+        delete stmt;
+        DBUG_RETURN(true);
+      }
+      thd->clear_error();
+      thd->get_stmt_da()->clear_warning_info(thd->query_id);
+      /*
+        A syntax error is caused by a parameter marker in a place where
+        the literal was allowed, and will not change on the next attempt.
+        Other errors (e.g. a missing table) are reported by the regular
+        execution and are not cached.
+      */
+      if (sql_errno != ER_PARSE_ERROR)
+      {
+        delete stmt;
+        DBUG_RETURN(false);
+      }
+    }
+    if (error || !text_stmt_cacheable_command(stmt->lex->sql_command))
+      stmt->flags|= (uint) Prepared_statement::IS_TEXT_CACHE_BYPASS;
+    if (thd->text_stmt_cache.insert(stmt, cache_size))
+      DBUG_RETURN(false);
+  }
+  else
+    status_var_increment(thd->status_var.text_stmt_cache_hits);
+
+  if ((stmt->flags & (uint) Prepared_statement::IS_TEXT_CACHE_BYPASS) ||
+      stmt->param_count != params.elements)
+  {
+    DBUG_ASSERT(stmt->param_count == params.elements);
+    DBUG_RETURN(false);
+  }
+
+  /* The rest is the same as EXECUTE stmt USING ... */
+  lex->sql_command= SQLCOM_EXECUTE;
+  lex->prepared_stmt_params= params;
+  if (lex->prepared_stmt_params_fix_fields(thd))
+    DBUG_RETURN(true);
+
+  String expanded_query;
+  /* See comments on thd->free_list in mysql_sql_stmt_execute() */
+  Item *free_list_backup= thd->free_list;
+  thd->free_list= NULL;
+  Item_change_list_savepoint change_list_savepoint(thd);
+  (void) stmt->execute_loop(&expanded_query, FALSE, NULL, NULL);
+  change_list_savepoint.rollback(thd);
+  thd->free_items();
+  thd->free_list= free_list_backup;
+
+  stmt->lex->restore_set_statement_var();
+  DBUG_RETURN(true);
+}
+
 
 /**
   COM_STMT_FETCH handler: fetches requested amount of rows from cursor.
@@ -3752,7 +4341,9 @@ Prepared_statement::Prepared_statement(THD *thd_arg)
   iterations(0),
   start_param(0),
   read_types(0),
-  m_sql_mode(thd->variables.sql_mode)
+  m_sql_mode(thd->variables.sql_mode),
+  m_character_set_client(thd->variables.character_set_client),
+  m_collation_connection(thd->variables.collation_connection)
 {
   init_sql_alloc(&main_mem_root, "Prepared_statement",
                  thd_arg->variables.query_alloc_block_size,
@@ -3931,8 +4522,10 @@ bool Prepared_statement::prepare(const char *packet, uint packet_len)
     If this is an SQLCOM_PREPARE, we also increase Com_prepare_sql.
     However, it seems handy if com_stmt_prepare is increased always,
     no matter what kind of prepare is processed.
+    Statements of the text statement cache have their own counters.
   */
-  status_var_increment(thd->status_var.com_stmt_prepare);
+  if (!is_text_cached())
+    status_var_increment(thd->status_var.com_stmt_prepare);
 
   if (! (lex= new (mem_root) st_lex_local))
     DBUG_RETURN(TRUE);
@@ -4071,7 +4664,7 @@ bool Prepared_statement::prepare(const char *packet, uint packet_len)
       sub-statements inside stored procedures are not logged into
       the general log.
     */
-    if (thd->spcont == NULL)
+    if (thd->spcont == NULL && !is_text_cached())
       general_log_write(thd, COM_STMT_PREPARE, query(), query_length());
   }
   DBUG_RETURN(error);
@@ -4522,8 +5115,10 @@ Prepared_statement::reprepare()
   copy.m_sql_mode= m_sql_mode;
 
   copy.set_sql_prepare(); /* To suppress sending metadata to the client. */
+  copy.flags|= flags & (uint) IS_TEXT_CACHED;
 
-  status_var_increment(thd->status_var.com_stmt_reprepare);
+  if (!is_text_cached())
+    status_var_increment(thd->status_var.com_stmt_reprepare);
 
   if (unlikely(mysql_opt_change_db(thd, &stmt_db_name, &saved_cur_db_name,
                                    TRUE, &cur_db_changed)))
@@ -4682,7 +5277,8 @@ bool Prepared_statement::execute(String *expanded_query, bool open_cursor)
 
   LEX_CSTRING stmt_db_name= db;
 
-  status_var_increment(thd->status_var.com_stmt_execute);
+  if (!is_text_cached())
+    status_var_increment(thd->status_var.com_stmt_execute);
 
   if (flags & (uint) IS_IN_USE)
   {
@@ -4873,7 +5469,7 @@ bool Prepared_statement::execute(String *expanded_query, bool open_cursor)
     sub-statements inside stored procedures are not logged into
     the general log.
   */
-  if (likely(error == 0 && thd->spcont == NULL))
+  if (likely(error == 0 && thd->spcont == NULL && !is_text_cached()))
     general_log_write(thd, COM_STMT_EXECUTE, thd->query(), thd->query_length());
 
 error:
@@ -19482,7 +19482,8 @@ evaluate_join_record(JOIN *join, JOIN_TAB *join_tab,
 
   if (select_cond)
   {
-    select_cond_result= MY_TEST(select_cond->val_int());
+    select_cond_result=
+      MY_TEST(join_tab->compiled_select_cond.val_int(join->thd, select_cond));
 
     /* check for errors evaluating the condition */
     if (unlikely(join->thd->is_error()))
@@ -19540,7 +19541,8 @@ evaluate_join_record(JOIN *join, JOIN_TAB *join_tab,
           will be re-evaluated again. It could be fixed, but, probably,
           it's not worth doing now.
         */
-        if (tab->select_cond && !tab->select_cond->val_int())
+        if (tab->select_cond &&
+            !tab->compiled_select_cond.val_int(join->thd, tab->select_cond))
         {
           /* The condition attached to table tab is false */
           if (tab == join_tab)
@@ -249,6 +249,7 @@ typedef struct st_join_table {
 				    not supported by any index                 */
   SQL_SELECT	*select;
   COND		*select_cond;
+  Compiled_cond compiled_select_cond; /**< select_cond, as evaluated per row */
   COND          *on_precond;    /**< part of on condition to check before
 				     accessing the first inner table           */  
   QUICK_SELECT_I *quick;
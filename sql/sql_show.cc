@@ -2699,7 +2699,13 @@ class thread_info :public ilink {
   uint   command;
   const char *user,*host,*db,*proc_info,*state_info;
   CSET_STRING query_string;
-  double progress;
+  char host_buff[LIST_PROCESS_HOST_LEN+1];
+  /* Progress report, copied under LOCK_thd_data */
+  uint progress_stage, progress_max_stage;
+  ulonglong progress_counter, progress_max_counter;
+  longlong memory_used, max_memory_used;
+  ha_rows examined_rows;
+  query_id_t query_id;
 };
 
 static const char *thread_state_info(THD *tmp)
@@ -2734,6 +2740,142 @@ static const char *thread_state_info(THD *tmp)
 }
 
 
+/*
+  Copy the process list information of all threads
+
+  SYNOPSIS
+    list_thread_infos()
+    thd               Thread handler, the copies are allocated in its mem_root
+    user              Only list threads of this user if not 0
+    max_query_length  Copy at most this much of the queries, 0 if the
+                      queries are not needed
+    schema_table      Copy for INFORMATION_SCHEMA.PROCESSLIST rather than
+                      for SHOW PROCESSLIST
+    thread_infos      Store the copies here
+
+  NOTES
+    LOCK_thread_count is only held while the values are copied, not while
+    the result is sent to the client or written to the temporary table of
+    the I_S table, so that monitoring does not stall connects and
+    disconnects. The copies are allocated before the lock is taken, only
+    the strings are allocated under it. LOCK_thd_data of the listed
+    threads is only tried, never waited for: a thread that holds it is
+    reported as "Busy".
+*/
+
+static void list_thread_infos(THD *thd, const char *user,
+                              size_t max_query_length, bool schema_table,
+                              I_List<thread_info> *thread_infos)
+{
+  I_List<thread_info> spare;
+  thread_info *thd_info;
+
+  /* Reading thread_count with no lock, more copies are allocated if needed */
+  for (int32 count= thread_count; count > 0; count--)
+  {
+    if (!(thd_info= new (thd->mem_root) thread_info))
+      return;
+    spare.append(thd_info);
+  }
+
+  mysql_mutex_lock(&LOCK_thread_count); // For unlink from list
+  I_List_iterator<THD> it(threads);
+  THD *tmp;
+  while ((tmp=it++))
+  {
+    Security_context *tmp_sctx= tmp->security_ctx;
+
+    if ((!tmp->vio_ok() && !tmp->system_thread) ||
+        (user && (tmp->system_thread || !tmp_sctx->user ||
+                  strcmp(tmp_sctx->user, user))))
+      continue;
+    if (!(thd_info= spare.get()) &&
+        !(thd_info= new (thd->mem_root) thread_info))
+      break;
+
+    thd_info->thread_id=tmp->thread_id;
+    thd_info->os_thread_id=tmp->os_thread_id;
+    thd_info->user= thd->strdup(tmp_sctx->user ? tmp_sctx->user :
+                                (tmp->system_thread ?
+                                 "system user" : "unauthenticated user"));
+    if (tmp->peer_port && (tmp_sctx->host || tmp_sctx->ip) &&
+        thd->security_ctx->host_or_ip[0])
+    {
+      my_snprintf(thd_info->host_buff, LIST_PROCESS_HOST_LEN,
+                  "%s:%u", tmp_sctx->host_or_ip, tmp->peer_port);
+      thd_info->host= thd_info->host_buff;
+    }
+    else if (schema_table)
+      thd_info->host= thd->strdup(tmp_sctx->host_or_ip);
+    else
+      thd_info->host= thd->strdup(tmp_sctx->host_or_ip[0] ?
+                                  tmp_sctx->host_or_ip :
+                                  tmp_sctx->host ? tmp_sctx->host : "");
+    thd_info->command=(int) tmp->get_command();
+    thd_info->db= 0;
+    thd_info->progress_max_counter= 0;
+
+    if (!trylock_short(&tmp->LOCK_thd_data))
+    {
+      /* This is an approximation */
+      thd_info->proc_info= (char*) (tmp->killed >= KILL_QUERY ?
+                                    "Killed" : 0);
+      /*
+        The following variables are only safe to access under a lock
+      */
+
+      if (tmp->db.str)
+        thd_info->db= thd->strmake(tmp->db.str, tmp->db.length);
+
+      if (max_query_length && tmp->query())
+      {
+        size_t length= MY_MIN(max_query_length, tmp->query_length());
+        char *q= thd->strmake(tmp->query(),length);
+        /* Safety: in case strmake failed, we set length to 0. */
+        thd_info->query_string=
+          CSET_STRING(q, q ? length : 0, tmp->query_charset());
+      }
+
+      /*
+        Progress report. We need to do this under a lock to ensure that all
+        is from the same stage.
+      */
+      if ((thd_info->progress_max_counter= tmp->progress.max_counter))
+      {
+        thd_info->progress_stage= tmp->progress.stage;
+        thd_info->progress_max_stage= tmp->progress.max_stage;
+        thd_info->progress_counter= tmp->progress.counter;
+      }
+      mysql_mutex_unlock(&tmp->LOCK_thd_data);
+    }
+    else
+    {
+      thd_info->proc_info= "Busy";
+      if (!schema_table)
+        thd_info->db= "";
+    }
+
+    thd_info->state_info= thread_state_info(tmp);
+    thd_info->start_time= tmp->start_utime;
+    ulonglong utime_after_query_snapshot= tmp->utime_after_query;
+    if (thd_info->start_time < utime_after_query_snapshot)
+      thd_info->start_time= utime_after_query_snapshot; // COM_SLEEP
+
+    /*
+      This may become negative if we free a memory allocated by another
+      thread in this thread. However it's better that we notice it eventually
+      than hide it.
+    */
+    thd_info->memory_used= tmp->status_var.local_memory_used;
+    thd_info->max_memory_used= tmp->status_var.max_local_memory_used;
+    thd_info->examined_rows= tmp->get_examined_row_count();
+    thd_info->query_id= tmp->query_id;
+    thread_infos->append(thd_info);
+  }
+  mysql_mutex_unlock(&LOCK_thread_count);
+}
+
+
 void mysqld_list_processes(THD *thd,const char *user, bool verbose)
 {
   Item *field;
@@ -2790,95 +2932,7 @@ void mysqld_list_processes(THD *thd,const char *user, bool verbose)
   if (thd->killed)
     DBUG_VOID_RETURN;
 
-  mysql_mutex_lock(&LOCK_thread_count); // For unlink from list
-  I_List_iterator<THD> it(threads);
-  THD *tmp;
-  while ((tmp=it++))
-  {
-    Security_context *tmp_sctx= tmp->security_ctx;
-    bool got_thd_data;
-    if ((tmp->vio_ok() || tmp->system_thread) &&
-        (!user || (!tmp->system_thread &&
-                   tmp_sctx->user && !strcmp(tmp_sctx->user, user))))
-    {
-      thread_info *thd_info= new (thd->mem_root) thread_info;
-
-      thd_info->thread_id=tmp->thread_id;
-      thd_info->os_thread_id=tmp->os_thread_id;
-      thd_info->user= thd->strdup(tmp_sctx->user ? tmp_sctx->user :
-                                  (tmp->system_thread ?
-                                   "system user" : "unauthenticated user"));
-      if (tmp->peer_port && (tmp_sctx->host || tmp_sctx->ip) &&
-          thd->security_ctx->host_or_ip[0])
-      {
-        if ((thd_info->host= (char*) thd->alloc(LIST_PROCESS_HOST_LEN+1)))
-          my_snprintf((char *) thd_info->host, LIST_PROCESS_HOST_LEN,
-                      "%s:%u", tmp_sctx->host_or_ip, tmp->peer_port);
-      }
-      else
-        thd_info->host= thd->strdup(tmp_sctx->host_or_ip[0] ?
-                                    tmp_sctx->host_or_ip :
-                                    tmp_sctx->host ? tmp_sctx->host : "");
-      thd_info->command=(int) tmp->get_command();
-
-      if ((got_thd_data= !trylock_short(&tmp->LOCK_thd_data)))
-      {
-        /* This is an approximation */
-        thd_info->proc_info= (char*) (tmp->killed >= KILL_QUERY ?
-                                      "Killed" : 0);
-        /*
-          The following variables are only safe to access under a lock
-        */
-
-        thd_info->db= 0;
-        if (tmp->db.str)
-          thd_info->db= thd->strmake(tmp->db.str, tmp->db.length);
-
-        if (tmp->query())
-        {
-          uint length= MY_MIN(max_query_length, tmp->query_length());
-          char *q= thd->strmake(tmp->query(),length);
-          /* Safety: in case strmake failed, we set length to 0. */
-          thd_info->query_string=
-            CSET_STRING(q, q ? length : 0, tmp->query_charset());
-        }
-
-        /*
-          Progress report. We need to do this under a lock to ensure that all
-          is from the same stage.
-        */
-        if (tmp->progress.max_counter)
-        {
-          uint max_stage= MY_MAX(tmp->progress.max_stage, 1);
-          thd_info->progress= (((tmp->progress.stage / (double) max_stage) +
-                                ((tmp->progress.counter /
-                                  (double) tmp->progress.max_counter) /
-                                 (double) max_stage)) *
-                               100.0);
-          set_if_smaller(thd_info->progress, 100);
-        }
-        else
-          thd_info->progress= 0.0;
-      }
-      else
-      {
-        thd_info->proc_info= "Busy";
-        thd_info->progress= 0.0;
-        thd_info->db= "";
-      }
-
-      thd_info->state_info= thread_state_info(tmp);
-      thd_info->start_time= tmp->start_utime;
-      ulonglong utime_after_query_snapshot= tmp->utime_after_query;
-      if (thd_info->start_time < utime_after_query_snapshot)
-        thd_info->start_time= utime_after_query_snapshot; // COM_SLEEP
-
-      if (got_thd_data)
-        mysql_mutex_unlock(&tmp->LOCK_thd_data);
-      thread_infos.append(thd_info);
-    }
-  }
-  mysql_mutex_unlock(&LOCK_thread_count);
+  list_thread_infos(thd, user, max_query_length, false, &thread_infos);
 
   thread_info *thd_info;
   ulonglong now= microsecond_interval_timer();
@@ -2905,7 +2959,20 @@ void mysqld_list_processes(THD *thd,const char *user, bool verbose)
                     thd_info->query_string.charset());
     if (!thd->variables.old_mode &&
         !(thd->variables.old_behavior & OLD_MODE_NO_PROGRESS_INFO))
-      protocol->store(thd_info->progress, 3, &store_buffer);
+    {
+      double progress= 0.0;
+      if (thd_info->progress_max_counter)
+      {
+        uint max_stage= MY_MAX(thd_info->progress_max_stage, 1);
+        progress= (((thd_info->progress_stage / (double) max_stage) +
+                    ((thd_info->progress_counter /
+                      (double) thd_info->progress_max_counter) /
+                     (double) max_stage)) *
+                   100.0);
+        set_if_smaller(progress, 100);
+      }
+      protocol->store(progress, 3, &store_buffer);
+    }
     if (protocol->write())
       break; /* purecov: inspected */
   }
@@ -3182,139 +3249,92 @@ int fill_schema_processlist(THD* thd, TABLE_LIST* tables, COND* cond)
   user= thd->security_ctx->master_access & PROCESS_ACL ?
         NullS : thd->security_ctx->priv_user;
 
-  mysql_mutex_lock(&LOCK_thread_count);
-
-  if (!thd->killed)
-  {
-    I_List_iterator<THD> it(threads);
-    THD* tmp;
+  if (thd->killed)
+    DBUG_RETURN(0);
 
-    while ((tmp= it++))
-    {
-      Security_context *tmp_sctx= tmp->security_ctx;
-      const char *val;
-      ulonglong max_counter;
-      bool got_thd_data;
+  I_List<thread_info> thread_infos;
+  thread_info *thd_info;
+  /* Only copy the queries if INFO or INFO_BINARY is used */
+  size_t max_query_length=
+    (bitmap_is_set(table->read_set, 7) || bitmap_is_set(table->read_set, 16) ?
+     PROCESS_LIST_INFO_WIDTH : 0);
+  list_thread_infos(thd, user, max_query_length, true, &thread_infos);
 
-      if ((!tmp->vio_ok() && !tmp->system_thread) ||
-          (user && (tmp->system_thread || !tmp_sctx->user ||
-                    strcmp(tmp_sctx->user, user))))
-        continue;
+  while ((thd_info= thread_infos.get()))
+  {
+    const char *val;
 
-      restore_record(table, s->default_values);
-      /* ID */
-      table->field[0]->store((longlong) tmp->thread_id, TRUE);
-      /* USER */
-      val= tmp_sctx->user ? tmp_sctx->user :
-            (tmp->system_thread ? "system user" : "unauthenticated user");
-      table->field[1]->store(val, strlen(val), cs);
-      /* HOST */
-      if (tmp->peer_port && (tmp_sctx->host || tmp_sctx->ip) &&
-          thd->security_ctx->host_or_ip[0])
-      {
-        char host[LIST_PROCESS_HOST_LEN + 1];
-        my_snprintf(host, LIST_PROCESS_HOST_LEN, "%s:%u",
-                    tmp_sctx->host_or_ip, tmp->peer_port);
-        table->field[2]->store(host, strlen(host), cs);
-      }
-      else
-        table->field[2]->store(tmp_sctx->host_or_ip,
-                               strlen(tmp_sctx->host_or_ip), cs);
+    restore_record(table, s->default_values);
+    /* ID */
+    table->field[0]->store((longlong) thd_info->thread_id, TRUE);
+    /* USER */
+    table->field[1]->store(thd_info->user, strlen(thd_info->user), cs);
+    /* HOST */
+    table->field[2]->store(thd_info->host, strlen(thd_info->host), cs);
+    /* DB */
+    if (thd_info->db)
+    {
+      table->field[3]->store(thd_info->db, strlen(thd_info->db), cs);
+      table->field[3]->set_notnull();
+    }
 
-      if ((got_thd_data= !trylock_short(&tmp->LOCK_thd_data)))
-      {
-        /* DB */
-        if (tmp->db.str)
-        {
-          table->field[3]->store(tmp->db.str, tmp->db.length, cs);
-          table->field[3]->set_notnull();
-        }
-      }
+    /* COMMAND */
+    if ((val= thd_info->proc_info))
+      table->field[4]->store(val, strlen(val), cs);
+    else
+      table->field[4]->store(command_name[thd_info->command].str,
+                             command_name[thd_info->command].length, cs);
 
-      /* COMMAND */
-      if ((val= (char *) (!got_thd_data ? "Busy" :
-                          (tmp->killed >= KILL_QUERY ?
-                           "Killed" : 0))))
-        table->field[4]->store(val, strlen(val), cs);
-      else
-        table->field[4]->store(command_name[tmp->get_command()].str,
-                               command_name[tmp->get_command()].length, cs);
+    /* MYSQL_TIME */
+    ulonglong utime= thd_info->start_time;
+    utime= utime && utime < unow ? unow - utime : 0;
 
-      /* MYSQL_TIME */
-      ulonglong utime= tmp->start_utime;
-      ulonglong utime_after_query_snapshot= tmp->utime_after_query;
-      if (utime < utime_after_query_snapshot)
-        utime= utime_after_query_snapshot; // COM_SLEEP
-      utime= utime && utime < unow ? unow - utime : 0;
+    table->field[5]->store(utime / HRTIME_RESOLUTION, TRUE);
 
-      table->field[5]->store(utime / HRTIME_RESOLUTION, TRUE);
+    if (thd_info->query_string.str())
+    {
+      table->field[7]->store(thd_info->query_string.str(),
+                             thd_info->query_string.length(), cs);
+      table->field[7]->set_notnull();
 
-      if (got_thd_data)
-      {
-        if (tmp->query())
-        {
-          table->field[7]->store(tmp->query(),
-                                 MY_MIN(PROCESS_LIST_INFO_WIDTH,
-                                        tmp->query_length()), cs);
-          table->field[7]->set_notnull();
-
-          /* INFO_BINARY */
-          table->field[16]->store(tmp->query(),
-                                  MY_MIN(PROCESS_LIST_INFO_WIDTH,
-                                         tmp->query_length()),
-                                  &my_charset_bin);
-          table->field[16]->set_notnull();
-        }
+      /* INFO_BINARY */
+      table->field[16]->store(thd_info->query_string.str(),
+                              thd_info->query_string.length(),
+                              &my_charset_bin);
+      table->field[16]->set_notnull();
+    }
 
-        /*
-          Progress report. We need to do this under a lock to ensure that all
-          is from the same stage.
-        */
-        if ((max_counter= tmp->progress.max_counter))
-        {
-          table->field[9]->store((longlong) tmp->progress.stage + 1, 1);
-          table->field[10]->store((longlong) tmp->progress.max_stage, 1);
-          table->field[11]->store((double) tmp->progress.counter /
-                                  (double) max_counter*100.0);
-        }
-        mysql_mutex_unlock(&tmp->LOCK_thd_data);
-      }
+    /* Progress report */
+    if (thd_info->progress_max_counter)
+    {
+      table->field[9]->store((longlong) thd_info->progress_stage + 1, 1);
+      table->field[10]->store((longlong) thd_info->progress_max_stage, 1);
+      table->field[11]->store((double) thd_info->progress_counter /
+                              (double) thd_info->progress_max_counter*100.0);
+    }
 
-      /* STATE */
-      if ((val= thread_state_info(tmp)))
-      {
-        table->field[6]->store(val, strlen(val), cs);
-        table->field[6]->set_notnull();
-      }
+    /* STATE */
+    if ((val= thd_info->state_info))
+    {
+      table->field[6]->store(val, strlen(val), cs);
+      table->field[6]->set_notnull();
+    }
 
-      /* TIME_MS */
-      table->field[8]->store((double)(utime / (HRTIME_RESOLUTION / 1000.0)));
+    /* TIME_MS */
+    table->field[8]->store((double)(utime / (HRTIME_RESOLUTION / 1000.0)));
 
-      /*
-        This may become negative if we free a memory allocated by another
-        thread in this thread. However it's better that we notice it eventually
-        than hide it.
-      */
-      table->field[12]->store((longlong) tmp->status_var.local_memory_used,
-                              FALSE);
-      table->field[13]->store((longlong) tmp->status_var.max_local_memory_used,
-                              FALSE);
-      table->field[14]->store((longlong) tmp->get_examined_row_count(), TRUE);
+    table->field[12]->store(thd_info->memory_used, FALSE);
+    table->field[13]->store(thd_info->max_memory_used, FALSE);
+    table->field[14]->store((longlong) thd_info->examined_rows, TRUE);
 
-      /* QUERY_ID */
-      table->field[15]->store(tmp->query_id, TRUE);
+    /* QUERY_ID */
+    table->field[15]->store(thd_info->query_id, TRUE);
 
-      table->field[17]->store(tmp->os_thread_id);
+    table->field[17]->store(thd_info->os_thread_id);
 
-      if (schema_table_store_record(thd, table))
-      {
-        mysql_mutex_unlock(&LOCK_thread_count);
-        DBUG_RETURN(1);
-      }
-    }
+    if (schema_table_store_record(thd, table))
+      DBUG_RETURN(1);
   }
-
-  mysql_mutex_unlock(&LOCK_thread_count);
   DBUG_RETURN(0);
 }
 
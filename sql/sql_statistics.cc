@@ -31,6 +31,7 @@
 #include "uniques.h"
 #include "sql_show.h"
 #include "sql_partition.h"
+#include "table_cache.h"
 
 /*
   The system variable 'use_stat_tables' can take one of the
@@ -61,6 +62,11 @@
 /* Currently there are only 3 persistent statistical tables */
 static const uint STATISTICS_TABLES= 3;
 
+/*
+  The number of rows ANALYZE samples when analyze_sample_percentage is 0
+*/
+static const ha_rows ANALYZE_AUTO_SAMPLE_ROWS= 100000;
+
 /* 
   The names of the statistical tables in this array must correspond the
   definitions of the tables in the file ../scripts/mysql_system_tables.sql
@@ -200,7 +206,7 @@ TABLE_FIELD_TYPE column_stat_fields[COLUMN_STAT_N_FIELDS] =
   },
   {
     { STRING_WITH_LEN("hist_type") },
-    { STRING_WITH_LEN("enum('SINGLE_PREC_HB','DOUBLE_PREC_HB')") },
+    { STRING_WITH_LEN("enum('SINGLE_PREC_HB','DOUBLE_PREC_HB','DOUBLE_PREC_MCV_HB')") },
     { STRING_WITH_LEN("utf8") }
   },
   {
@@ -318,13 +324,14 @@ class Column_statistics_collected :public Column_statistics
   ulonglong column_total_length; /* To accumulate the size of column values */
   Count_distinct_field *count_distinct; /* The container for distinct 
                                            column values */
+  ha_rows sampled_values; /* Number of values put into count_distinct */
 
   bool is_single_pk_col; /* TRUE <-> the only column of the primary key */ 
 
 public:
 
   inline void init(THD *thd, Field * table_field);
-  inline bool add(ha_rows rowno);
+  inline bool add(ha_rows rowno, bool sampled);
   inline void finish(ha_rows rows); 
   inline void cleanup();
 };
@@ -1540,6 +1547,45 @@ class Histogram_builder
   uint curr_bucket;        /* number of the current bucket to be built     */
   ulonglong count;         /* number of values retrieved                   */
   ulonglong count_distinct;    /* number of distinct values retrieved      */
+  ulonglong count_single;  /* number of values retrieved exactly once      */
+
+  /* The most frequent values seen so far, in no particular order */
+  struct Mcv_candidate
+  {
+    double pos;
+    element_count count;
+  };
+  Mcv_candidate mcv[32];
+  uint max_mcv_count;      /* the number of MCV slots in the histogram     */
+  uint mcv_count;          /* the number of used elements of 'mcv'         */
+  uint min_mcv;            /* index of the least frequent element of 'mcv' */
+
+  void add_mcv_candidate(element_count elem_cnt)
+  {
+    if (elem_cnt < 2)
+      return;
+    if (mcv_count < max_mcv_count)
+      min_mcv= mcv_count++;
+    else if (elem_cnt <= mcv[min_mcv].count)
+      return;
+    mcv[min_mcv].pos= column->pos_in_interval(min_value, max_value);
+    mcv[min_mcv].count= elem_cnt;
+    if (mcv_count == max_mcv_count)
+    {
+      for (uint i= 0; i < mcv_count; i++)
+      {
+        if (mcv[i].count < mcv[min_mcv].count)
+          min_mcv= i;
+      }
+    }
+  }
+
+  static int mcv_pos_cmp(const void *a, const void *b)
+  {
+    double pos_a= ((const Mcv_candidate *) a)->pos;
+    double pos_b= ((const Mcv_candidate *) b)->pos;
+    return pos_a < pos_b ? -1 : pos_a > pos_b ? 1 : 0;
+  }
 
 public: 
   Histogram_builder(Field *col, uint col_len, ha_rows rows)
@@ -1554,14 +1600,27 @@ class Histogram_builder
     curr_bucket= 0;
     count= 0;
     count_distinct= 0;    
+    count_single= 0;
+    max_mcv_count= MY_MIN(histogram->get_max_mcv_count(), array_elements(mcv));
+    mcv_count= 0;
+    min_mcv= 0;
   }
 
   ulonglong get_count_distinct() { return count_distinct; }
 
+  ulonglong get_count_single() { return count_single; }
+
   int next(void *elem, element_count elem_cnt)
   {
     count_distinct++;
+    if (elem_cnt == 1)
+      count_single++;
     count+= elem_cnt;
+    if (max_mcv_count)
+    {
+      column->store_field_value((uchar *) elem, col_length);
+      add_mcv_candidate(elem_cnt);
+    }
     if (curr_bucket == hist_width)
       return 0;
     if (count > bucket_capacity * (curr_bucket + 1))
@@ -1579,6 +1638,28 @@ class Histogram_builder
     }
     return 0;
   }
+
+  /*
+    Store the most common values into the histogram. Only the values that
+    are noticeably more frequent than the average one are kept: the others
+    are estimated well enough from the average frequency.
+  */
+  void finish()
+  {
+    double pos[array_elements(mcv)], sel[array_elements(mcv)];
+    uint n= 0;
+    double min_count= 1.25 * records / MY_MAX(count_distinct, 1);
+    my_qsort(mcv, mcv_count, sizeof(Mcv_candidate), mcv_pos_cmp);
+    for (uint i= 0; i < mcv_count; i++)
+    {
+      if (mcv[i].count > min_count)
+      {
+        pos[n]= mcv[i].pos;
+        sel[n++]= (double) mcv[i].count / records;
+      }
+    }
+    histogram->set_mcv(n, pos, sel);
+  }
 };
 
 
@@ -1590,6 +1671,22 @@ int histogram_build_walk(void *elem, element_count elem_cnt, void *arg)
   return hist_builder->next(elem, elem_cnt);
 }
 
+
+/*
+  Count the distinct values and the values met exactly once, see
+  Count_distinct_field::get_value()
+*/
+
+static
+int count_single_walk(void *elem, element_count elem_cnt, void *arg)
+{
+  ulonglong *counts= (ulonglong *) arg;
+  counts[0]++;
+  if (elem_cnt == 1)
+    counts[1]++;
+  return 0;
+}
+
 C_MODE_END
 
 
@@ -1666,12 +1763,22 @@ class Count_distinct_field: public Sql_alloc
   /*
     @brief
     Calculate the number of elements accumulated in the container of 'tree'
+
+    @param single  If not NULL, the number of elements that were added
+                   exactly once is returned here
   */
-  ulonglong get_value()
+  ulonglong get_value(ulonglong *single= NULL)
   {
     ulonglong count;
-    if (tree->elements == 0)
+    if (tree->elements == 0 && !single)
       return (ulonglong) tree->elements_in_tree();
+    if (single)
+    {
+      ulonglong counts[2]= {0, 0};
+      tree->walk(table_field->table, count_single_walk, (void*) counts);
+      *single= counts[1];
+      return counts[0];
+    }
     count= 0;  
     tree->walk(table_field->table, count_distinct_walk, (void*) &count);
     return count;
@@ -1681,10 +1788,13 @@ class Count_distinct_field: public Sql_alloc
     @brief
     Build the histogram for the elements accumulated in the container of 'tree'
   */
-  ulonglong get_value_with_histogram(ha_rows rows)
+  ulonglong get_value_with_histogram(ha_rows rows, ulonglong *single= NULL)
   {
     Histogram_builder hist_builder(table_field, tree_key_length, rows);
     tree->walk(table_field->table,  histogram_build_walk, (void *) &hist_builder);
+    hist_builder.finish();
+    if (single)
+      *single= hist_builder.get_count_single();
     return hist_builder.get_count_distinct();
   }
 
@@ -2458,6 +2568,7 @@ void Column_statistics_collected::init(THD *thd, Field *table_field)
 
   nulls= 0;
   column_total_length= 0;
+  sampled_values= 0;
   if (is_single_pk_col)
     count_distinct= NULL;
   if (table_field->flags & BLOB_FLAG)
@@ -2480,10 +2591,13 @@ void Column_statistics_collected::init(THD *thd, Field *table_field)
 
   @param
   rowno     The order number of the row
+  @param
+  sampled   TRUE <-> the row belongs to the sample used to count distinct
+            values and to build histograms
 */
 
 inline
-bool Column_statistics_collected::add(ha_rows rowno)
+bool Column_statistics_collected::add(ha_rows rowno, bool sampled)
 {
 
   bool err= 0;
@@ -2496,8 +2610,11 @@ bool Column_statistics_collected::add(ha_rows rowno)
       set_not_null(COLUMN_STAT_MIN_VALUE);
     if (max_value && column->update_max(max_value, rowno == nulls))
       set_not_null(COLUMN_STAT_MAX_VALUE);
-    if (count_distinct)
+    if (count_distinct && sampled)
+    {
+      sampled_values++;
       err= count_distinct->add();
+    }
   } 
   return err;
 }
@@ -2530,15 +2647,40 @@ void Column_statistics_collected::finish(ha_rows rows)
   }
   if (count_distinct)
   {
-    ulonglong distincts;
+    ulonglong distincts, single;
+    ha_rows values= rows - nulls;
+    bool is_sample= sampled_values < values;
     uint hist_size= count_distinct->get_hist_size();
     if (hist_size == 0)
-      distincts= count_distinct->get_value();
+      distincts= count_distinct->get_value(is_sample ? &single : NULL);
     else
-      distincts= count_distinct->get_value_with_histogram(rows - nulls);
+      distincts= count_distinct->get_value_with_histogram(sampled_values,
+                                                          &single);
+    if (distincts && is_sample)
+    {
+      /*
+        Scale the number of distinct values found in the sample up to the
+        whole column with the Duj1 estimator of Haas and Stokes:
+          D = n*d / (n - f1 + f1*n/N)
+        where n is the sample size, N the number of values in the column,
+        d the number of distinct values in the sample and f1 the number of
+        values met in the sample exactly once.
+      */
+      double n= (double) sampled_values;
+      double d= n * distincts / (n - single + single * n / values);
+      set_if_bigger(d, (double) distincts);
+      set_if_smaller(d, (double) values);
+      distincts= (ulonglong) d;
+    }
+    else if (!sampled_values && values)
+    {
+      /* Nothing is known about the values: take them as distinct */
+      distincts= values;
+      hist_size= 0;
+    }
     if (distincts)
     {
-      val= (double) (rows - nulls) / distincts;
+      val= (double) values / distincts;
       set_avg_frequency(val); 
       set_not_null(COLUMN_STAT_AVG_FREQUENCY);
     }
@@ -2668,6 +2810,245 @@ int collect_statistics_for_index(THD *thd, TABLE *table, uint index)
 }
 
 
+/*
+  Tracking of the rows changed in the tables since ANALYZE collected
+  engine-independent statistics for them
+
+  Only the tables analyzed since the server start are tracked. The rows
+  changed by statements are counted in the used TABLE instance without any
+  locking, added to TABLE_SHARE::stats_cb.rows_changed when the instance
+  is closed, and moved into the entry of the table in stats_changes_hash
+  when the share is freed.
+*/
+
+struct Stats_changes
+{
+  ha_rows collected_rows;     /* Table cardinality at the collection   */
+  ulonglong rows_changed;     /* Rows changed by already freed shares  */
+  uint key_length;
+  uchar key[MAX_DBKEY_LENGTH];
+};
+
+static HASH stats_changes_hash;
+static mysql_mutex_t LOCK_stats_changes;
+
+#ifdef HAVE_PSI_INTERFACE
+static PSI_mutex_key key_LOCK_stats_changes;
+static PSI_mutex_info all_stats_changes_mutexes[]=
+{
+  { &key_LOCK_stats_changes, "LOCK_stats_changes", PSI_FLAG_GLOBAL }
+};
+#endif
+
+static uchar *get_stats_changes_key(const uchar *ptr, size_t *length,
+                                    my_bool not_used __attribute__((unused)))
+{
+  Stats_changes *entry= (Stats_changes *) ptr;
+  *length= entry->key_length;
+  return entry->key;
+}
+
+
+void init_statistics_changes()
+{
+#ifdef HAVE_PSI_INTERFACE
+  mysql_mutex_register("sql", all_stats_changes_mutexes,
+                       array_elements(all_stats_changes_mutexes));
+#endif
+  mysql_mutex_init(key_LOCK_stats_changes, &LOCK_stats_changes,
+                   MY_MUTEX_INIT_FAST);
+  my_hash_init(&stats_changes_hash, &my_charset_bin, 32, 0, 0,
+               get_stats_changes_key, my_free, 0);
+}
+
+
+void free_statistics_changes()
+{
+  if (my_hash_inited(&stats_changes_hash))
+  {
+    my_hash_free(&stats_changes_hash);
+    mysql_mutex_destroy(&LOCK_stats_changes);
+  }
+}
+
+
+/*
+  Move the rows changed through a table share that is being freed into
+  the entry of the table
+*/
+
+void flush_statistics_changes(TABLE_SHARE *share)
+{
+  ulonglong rows_changed=
+    (ulonglong) my_atomic_load64_explicit(&share->stats_cb.rows_changed,
+                                          MY_MEMORY_ORDER_RELAXED);
+  if (!rows_changed || !my_hash_inited(&stats_changes_hash))
+    return;
+  mysql_mutex_lock(&LOCK_stats_changes);
+  Stats_changes *entry=
+    (Stats_changes *) my_hash_search(&stats_changes_hash,
+                                     (uchar *) share->table_cache_key.str,
+                                     share->table_cache_key.length);
+  if (entry)
+    entry->rows_changed+= rows_changed;
+  mysql_mutex_unlock(&LOCK_stats_changes);
+}
+
+
+static void forget_statistics_changes(const char *key, uint key_length)
+{
+  mysql_mutex_lock(&LOCK_stats_changes);
+  if (uchar *entry= my_hash_search(&stats_changes_hash, (uchar *) key,
+                                   key_length))
+    my_hash_delete(&stats_changes_hash, entry);
+  mysql_mutex_unlock(&LOCK_stats_changes);
+}
+
+
+static void forget_statistics_changes(const LEX_CSTRING *db,
+                                      const LEX_CSTRING *tab)
+{
+  char key[MAX_DBKEY_LENGTH];
+  uint key_length= tdc_create_key(key, db->str, tab->str);
+  forget_statistics_changes(key, key_length);
+}
+
+
+/*
+  Get the rows changed through a table share and its open instances,
+  optionally starting to count them anew
+*/
+
+static ulonglong get_share_rows_changed(TABLE_SHARE *share, bool reset)
+{
+  ulonglong rows_changed;
+  if (reset)
+  {
+    rows_changed= 0;
+    (void) my_atomic_fas64_explicit(&share->stats_cb.rows_changed, 0,
+                                    MY_MEMORY_ORDER_RELAXED);
+  }
+  else
+    rows_changed= (ulonglong)
+      my_atomic_load64_explicit(&share->stats_cb.rows_changed,
+                                MY_MEMORY_ORDER_RELAXED);
+  if (share->tmp_table != NO_TMP_TABLE || !share->tdc)
+    return rows_changed;
+
+  TDC_element *element= share->tdc;
+  TABLE *table;
+  mysql_mutex_lock(&element->LOCK_table_share);
+  All_share_tables_list::Iterator it(element->all_tables);
+  while ((table= it++))
+  {
+    if (reset)
+      (void) my_atomic_fas64_explicit(&table->stats_rows_changed, 0,
+                                      MY_MEMORY_ORDER_RELAXED);
+    else
+      rows_changed+= (ulonglong)
+        my_atomic_load64_explicit(&table->stats_rows_changed,
+                                  MY_MEMORY_ORDER_RELAXED);
+  }
+  mysql_mutex_unlock(&element->LOCK_table_share);
+  return rows_changed;
+}
+
+
+/*
+  Start counting the changes of a table anew after its statistics have
+  been collected
+*/
+
+static void save_statistics_changes(TABLE *table)
+{
+  TABLE_SHARE *share= table->s;
+  Stats_changes *entry;
+  mysql_mutex_lock(&LOCK_stats_changes);
+  if (!(entry=
+        (Stats_changes *) my_hash_search(&stats_changes_hash,
+                                         (uchar *) share->table_cache_key.str,
+                                         share->table_cache_key.length)))
+  {
+    if ((entry= (Stats_changes *) my_malloc(sizeof(Stats_changes),
+                                            MYF(MY_WME))))
+    {
+      entry->key_length= (uint) share->table_cache_key.length;
+      memcpy(entry->key, share->table_cache_key.str, entry->key_length);
+      if (my_hash_insert(&stats_changes_hash, (uchar *) entry))
+      {
+        my_free(entry);
+        entry= NULL;
+      }
+    }
+  }
+  if (entry)
+  {
+    entry->collected_rows= table->collected_stats->cardinality;
+    entry->rows_changed= 0;
+  }
+  mysql_mutex_unlock(&LOCK_stats_changes);
+}
+
+
+/**
+  @brief
+  Check whether the statistics on a table are recent enough to skip
+  collecting them
+
+  @param
+  thd         The thread handle
+  @param
+  table       The table to be analyzed
+
+  @details
+  The statistics are considered to be up to date when ANALYZE has collected
+  them since the server start, and less than analyze_refresh_percentage
+  percent of the rows of the table have been changed since then. Changes
+  that bypass the row operations of handler, like TRUNCATE, are caught by
+  comparing the current number of rows with the collected cardinality.
+
+  @retval
+  TRUE        The statistics do not need to be collected
+  @retval
+  FALSE       Otherwise
+*/
+
+bool statistics_are_up_to_date(THD *thd, TABLE *table)
+{
+  ulong refresh_percentage= thd->variables.analyze_refresh_percentage;
+  TABLE_SHARE *share= table->s;
+  ha_rows collected_rows;
+  ulonglong rows_changed;
+
+  if (!refresh_percentage || !my_hash_inited(&stats_changes_hash))
+    return FALSE;
+
+  mysql_mutex_lock(&LOCK_stats_changes);
+  Stats_changes *entry=
+    (Stats_changes *) my_hash_search(&stats_changes_hash,
+                                     (uchar *) share->table_cache_key.str,
+                                     share->table_cache_key.length);
+  if (!entry)
+  {
+    mysql_mutex_unlock(&LOCK_stats_changes);
+    return FALSE;
+  }
+  collected_rows= entry->collected_rows;
+  rows_changed= entry->rows_changed;
+  mysql_mutex_unlock(&LOCK_stats_changes);
+
+  rows_changed+= get_share_rows_changed(share, false);
+  if (table->file->info(HA_STATUS_VARIABLE | HA_STATUS_NO_LOCK))
+    return FALSE;
+  ha_rows records= table->file->stats.records;
+  set_if_bigger(rows_changed, records > collected_rows ?
+                              records - collected_rows :
+                              collected_rows - records);
+  return (double) rows_changed * 100 <
+         (double) refresh_percentage * collected_rows;
+}
+
+
 /**
   @brief 
   Collect statistical data for a table
@@ -2727,12 +3108,31 @@ int collect_statistics_for_table(THD *thd, TABLE *table)
   Field *table_field;
   ha_rows rows= 0;
   handler *file=table->file;
+  double sample_fraction= thd->variables.sample_percentage / 100;
 
   DBUG_ENTER("collect_statistics_for_table");
 
   table->collected_stats->cardinality_is_null= TRUE;
   table->collected_stats->cardinality= 0;
 
+  /*
+    Changes made while the statistics are collected may or may not be seen
+    by the collection: count them as changes made after it.
+  */
+  if (my_hash_inited(&stats_changes_hash))
+    forget_statistics_changes(table->s->table_cache_key.str,
+                              (uint) table->s->table_cache_key.length);
+  get_share_rows_changed(table->s, true);
+
+  if (sample_fraction == 0)
+  {
+    /* Let the sample have about ANALYZE_AUTO_SAMPLE_ROWS rows */
+    file->info(HA_STATUS_VARIABLE | HA_STATUS_NO_LOCK);
+    sample_fraction= 1;
+    if (file->stats.records > ANALYZE_AUTO_SAMPLE_ROWS)
+      sample_fraction= (double) ANALYZE_AUTO_SAMPLE_ROWS / file->stats.records;
+  }
+
   for (field_ptr= table->field; *field_ptr; field_ptr++)
   {
     table_field= *field_ptr;   
@@ -2756,12 +3156,14 @@ int collect_statistics_for_table(THD *thd, TABLE *table)
       if (rc)
         break;
 
+      bool sampled= sample_fraction >= 1 ||
+                    my_rnd(&thd->rand) < sample_fraction;
       for (field_ptr= table->field; *field_ptr; field_ptr++)
       {
         table_field= *field_ptr;
         if (!bitmap_is_set(table->read_set, table_field->field_index))
           continue;  
-        if ((rc= table_field->collected_stats->add(rows)))
+        if ((rc= table_field->collected_stats->add(rows, sampled)))
           break;
       }
       if (rc)
@@ -2924,6 +3326,9 @@ int update_statistics_for_table(THD *thd, TABLE *table)
 
   close_system_tables(thd, &open_tables_backup);
 
+  if (!rc && my_hash_inited(&stats_changes_hash))
+    save_statistics_changes(table);
+
   DBUG_RETURN(rc);
 }
 
@@ -3337,6 +3742,9 @@ int delete_statistics_for_table(THD *thd, const LEX_CSTRING *db,
   int rc= 0;
   bool has_error_active= thd->is_error();
   DBUG_ENTER("delete_statistics_for_table");
+
+  if (my_hash_inited(&stats_changes_hash))
+    forget_statistics_changes(db, tab);
    
   if (open_stat_tables(thd, tables, &open_tables_backup, TRUE))
   {
@@ -3583,6 +3991,9 @@ int rename_table_in_stat_tables(THD *thd, const LEX_CSTRING *db,
   Open_tables_backup open_tables_backup;
   int rc= 0;
   DBUG_ENTER("rename_table_in_stat_tables");
+
+  if (my_hash_inited(&stats_changes_hash))
+    forget_statistics_changes(db, tab);
    
   if (open_stat_tables(thd, tables, &open_tables_backup, TRUE))
   {
@@ -3976,9 +4387,30 @@ double get_column_range_cardinality(Field *field,
 double Histogram::point_selectivity(double pos, double avg_sel)
 {
   double sel;
+  uint pos_value= (uint) (pos * prec_factor());
+
+  if (uint mcv_count= get_mcv_count())
+  {
+    double min_mcv_sel= 1.0;
+    for (uint i= 0; i < mcv_count; i++)
+    {
+      if (get_mcv_pos(i) == pos_value)
+        return get_mcv_sel(i);
+      set_if_smaller(min_mcv_sel, get_mcv_sel(i));
+    }
+    /*
+      The value is not one of the most common values. The rows of the common
+      values already fill their own buckets, so the rows of the bucket 'pos'
+      falls into are shared only by the remaining distinct values.
+    */
+    double distincts= 1.0 / avg_sel;
+    if (distincts > mcv_count + 1)
+      avg_sel= 1.0 / (distincts - mcv_count);
+    set_if_smaller(avg_sel, min_mcv_sel);
+  }
+
   /* Find the bucket that contains the value 'pos'. */
   uint min= find_bucket(pos, TRUE);
-  uint pos_value= (uint) (pos * prec_factor());
 
   /* Find how many buckets this value occupies */
   uint max= min;
@@ -4054,6 +4486,26 @@ double Histogram::point_selectivity(double pos, double avg_sel)
   return sel;
 }
 
+
+/*
+  Get the fraction of rows with the most common values that fall into
+  [min_pos, max_pos]
+*/
+
+double Histogram::mcv_range_selectivity(double min_pos, double max_pos)
+{
+  uint min_value= (uint) (min_pos * prec_factor());
+  uint max_value= (uint) (max_pos * prec_factor());
+  double sel= 0;
+  for (uint i= 0; i < get_mcv_count(); i++)
+  {
+    uint mcv_pos= get_mcv_pos(i);
+    if (mcv_pos >= min_value && mcv_pos <= max_value)
+      sel+= get_mcv_sel(i);
+  }
+  return sel;
+}
+
 /*
   Check whether the table is one of the persistent statistical tables.
 */
@@ -42,7 +42,8 @@ typedef
 enum enum_histogram_type
 {
   SINGLE_PREC_HB,
-  DOUBLE_PREC_HB
+  DOUBLE_PREC_HB,
+  DOUBLE_PREC_MCV_HB
 } Histogram_type;
 
 enum enum_stat_tables
@@ -122,6 +123,10 @@ int alloc_statistics_for_table_share(THD* thd, TABLE_SHARE *share,
 void delete_stat_values_for_table_share(TABLE_SHARE *table_share);
 int alloc_statistics_for_table(THD *thd, TABLE *table);
 int update_statistics_for_table(THD *thd, TABLE *table);
+void init_statistics_changes();
+void free_statistics_changes();
+void flush_statistics_changes(TABLE_SHARE *share);
+bool statistics_are_up_to_date(THD *thd, TABLE *table);
 int delete_statistics_for_table(THD *thd, const LEX_CSTRING *db, const LEX_CSTRING *tab);
 int delete_statistics_for_column(THD *thd, TABLE *tab, Field *col);
 int delete_statistics_for_index(THD *thd, TABLE *tab, KEY *key_info,
@@ -149,12 +154,37 @@ class Histogram
   uint8 size; /* Size of values array, in bytes */
   uchar *values;
 
+  /*
+    A DOUBLE_PREC_MCV_HB histogram is laid out as
+
+      <#mcv> <mcv_1> ... <mcv_k> <bucket_1> ... <bucket_n>
+
+    #mcv is one byte with the number of used MCV slots. Every MCV slot takes
+    four bytes: the position of the value in [min_value, max_value] and the
+    fraction of non-NULL rows that have this value, both in double precision.
+    The number of MCV slots k depends only on the histogram size, so that the
+    buckets can be filled in before it is known which slots get used. The
+    remaining bytes are double precision height-balanced buckets.
+  */
+  static const uint mcv_slot_size= 4;
+
+  uint mcv_slots()
+  {
+    return type == DOUBLE_PREC_MCV_HB && size > 12 ? (size - 1U) / 12 : 0;
+  }
+
+  uint buckets_offset()
+  {
+    return type == DOUBLE_PREC_MCV_HB ? 1 + mcv_slots() * mcv_slot_size : 0;
+  }
+
   uint prec_factor()
   {
     switch (type) {
     case SINGLE_PREC_HB:
       return ((uint) (1 << 8) - 1);
     case DOUBLE_PREC_HB:
+    case DOUBLE_PREC_MCV_HB:
       return ((uint) (1 << 16) - 1);
     }
     return 1;
@@ -168,6 +198,8 @@ class Histogram
       return size;
     case DOUBLE_PREC_HB:
       return size / 2;
+    case DOUBLE_PREC_MCV_HB:
+      return size ? (size - buckets_offset()) / 2 : 0;
     }
     return 0;
   }
@@ -181,6 +213,8 @@ class Histogram
       return (uint) (((uint8 *) values)[i]);
     case DOUBLE_PREC_HB:
       return (uint) uint2korr(values + i * 2);
+    case DOUBLE_PREC_MCV_HB:
+      return (uint) uint2korr(values + buckets_offset() + i * 2);
     }
     return 0;
   }
@@ -224,6 +258,24 @@ class Histogram
     return i;
   }
 
+  uint get_mcv_count()
+  {
+    return mcv_slots() ? MY_MIN((uint) values[0], mcv_slots()) : 0;
+  }
+
+  uint get_mcv_pos(uint i)
+  {
+    return (uint) uint2korr(values + 1 + i * mcv_slot_size);
+  }
+
+  double get_mcv_sel(uint i)
+  {
+    return uint2korr(values + 1 + i * mcv_slot_size + 2) /
+           (double) prec_factor();
+  }
+
+  double mcv_range_selectivity(double min_pos, double max_pos);
+
 public:
 
   uint get_size() { return (uint) size; }
@@ -249,6 +301,9 @@ class Histogram
     case DOUBLE_PREC_HB:
       int2store(values + i * 2, val * prec_factor());
       return;
+    case DOUBLE_PREC_MCV_HB:
+      int2store(values + buckets_offset() + i * 2, val * prec_factor());
+      return;
     }
   }
 
@@ -261,6 +316,30 @@ class Histogram
     case DOUBLE_PREC_HB:
       int2store(values + i * 2, uint2korr(values + i * 2 - 2));
       return;
+    case DOUBLE_PREC_MCV_HB:
+      set_value(i, get_value(i - 1) / (double) prec_factor());
+      return;
+    }
+  }
+
+  /* Number of most common values the histogram can hold */
+  uint get_max_mcv_count() { return mcv_slots(); }
+
+  /*
+    Store the most common values. 'pos' and 'sel' are arrays of 'count'
+    positions and selectivities sorted by position.
+  */
+  void set_mcv(uint count, const double *pos, const double *sel)
+  {
+    DBUG_ASSERT(count <= mcv_slots());
+    if (type != DOUBLE_PREC_MCV_HB || !size)
+      return;
+    values[0]= (uchar) count;
+    for (uint i= 0; i < mcv_slots(); i++)
+    {
+      uchar *slot= values + 1 + i * mcv_slot_size;
+      int2store(slot, i < count ? pos[i] * prec_factor() : 0);
+      int2store(slot + 2, i < count ? sel[i] * prec_factor() : 0);
     }
   }
 
@@ -271,6 +350,13 @@ class Histogram
     uint min= find_bucket(min_pos, TRUE);
     uint max= find_bucket(max_pos, FALSE);
     sel= bucket_sel * (max - min + 1);
+    /*
+      The buckets are built over all rows, so the most common values are
+      already accounted for in them. Only make sure that a range is never
+      estimated to match fewer rows than the common values it contains.
+    */
+    if (get_mcv_count())
+      set_if_bigger(sel, mcv_range_selectivity(min_pos, max_pos));
     return sel;
   } 
   
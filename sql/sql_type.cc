@@ -7534,13 +7534,14 @@ Field *Type_handler_varchar::
                             const Column_definition_attributes *attr,
                             uint32 flags) const
 {
-  if (attr->unireg_check == Field::TMYSQL_COMPRESSED)
+  if (Compression_method *method=
+        Field::compression_method(attr->unireg_check))
     return new (mem_root)
       Field_varstring_compressed(rec.ptr(), (uint32) attr->length,
                                  HA_VARCHAR_PACKLENGTH((uint32) attr->length),
                                  rec.null_ptr(), rec.null_bit(),
                                  attr->unireg_check, name, share, attr->charset,
-                                 zlib_compression_method);
+                                 method);
   return new (mem_root)
     Field_varstring(rec.ptr(), (uint32) attr->length,
                     HA_VARCHAR_PACKLENGTH((uint32) attr->length),
@@ -7556,12 +7557,13 @@ Field *Type_handler_blob_common::
                             const Column_definition_attributes *attr,
                             uint32 flags) const
 {
-  if (attr->unireg_check == Field::TMYSQL_COMPRESSED)
+  if (Compression_method *method=
+        Field::compression_method(attr->unireg_check))
     return new (mem_root)
       Field_blob_compressed(rec.ptr(), rec.null_ptr(), rec.null_bit(),
                             attr->unireg_check, name, share,
                             attr->pack_flag_to_pack_length(), attr->charset,
-                            zlib_compression_method);
+                            method);
   return new (mem_root)
     Field_blob(rec.ptr(), rec.null_ptr(), rec.null_bit(),
                attr->unireg_check, name, share,
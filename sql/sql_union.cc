@@ -306,6 +306,9 @@ int select_union_recursive::send_data(List<Item> &values)
     if ((err= incr_table->file->ha_write_tmp_row(table->record[0])))
     {
       bool is_duplicate;
+      /* The row that filled the table is copied from its record[0] */
+      memcpy(incr_table->record[0], table->record[0],
+             incr_table->s->reclength);
       rc= create_internal_tmp_table_from_heap(thd, incr_table,
                                               tmp_table_param.start_recinfo, 
                                               &tmp_table_param.recinfo,
@@ -1765,12 +1768,18 @@ bool st_select_lex_unit::exec_recursive()
   else
     with_element->level++;
 
+  /*
+    Copy the new rows into the tables of all recursive references
+    reading incr_table only once.
+  */
+  saved_error=
+    incr_table->insert_all_rows_into_tmp_tables(thd,
+                                                with_element->rec_result->
+                                                  rec_tables,
+                                                tmp_table_param,
+                                                !is_unrestricted);
   while ((rec_table= li++))
   {
-    saved_error=
-      incr_table->insert_all_rows_into_tmp_table(thd, rec_table,
-                                                 tmp_table_param,
-                                                 !is_unrestricted);
     if (!with_element->rec_result->first_rec_table_to_update)
       with_element->rec_result->first_rec_table_to_update= rec_table;
     if (with_element->level == 1 && rec_table->reginfo.join_tab)
@@ -2203,6 +2203,129 @@ class Frame_scan_cursor : public Frame_cursor
   }
 };
 
+/*
+  A cursor that computes MIN/MAX over the rows between the top bound and the
+  bottom bound. It replaces Frame_scan_cursor for these functions.
+
+  MIN and MAX can not remove values, but the result only changes when the
+  row it was taken from leaves the frame. The cursor keeps the rows it has
+  already added and only adds the rows that entered the frame at the bottom.
+  The frame is scanned again only when the result row has left it at the
+  top. For a sliding frame this is much cheaper than scanning the whole frame
+  for every row.
+*/
+class Frame_scan_min_max_cursor : public Frame_cursor
+{
+public:
+  Frame_scan_min_max_cursor(const Frame_cursor &top_bound,
+                            const Frame_cursor &bottom_bound,
+                            Item_sum_hybrid *item) :
+    top_bound(top_bound), bottom_bound(bottom_bound), item(item),
+    have_rows(false) {}
+
+  void init(READ_RECORD *info)
+  {
+    cursor.init(info);
+  }
+
+  void pre_next_partition(ha_rows rownum)
+  {
+    curr_rownum= rownum;
+    reset();
+  }
+
+  void next_partition(ha_rows rownum)
+  {
+    compute_values_for_current_row();
+  }
+
+  void next_row()
+  {
+    curr_rownum++;
+    compute_values_for_current_row();
+  }
+
+  ha_rows get_curr_rownum() const
+  {
+    return curr_rownum;
+  }
+
+private:
+  const Frame_cursor &top_bound;
+  const Frame_cursor &bottom_bound;
+  Item_sum_hybrid *item;
+  Table_read_cursor cursor;
+  ha_rows curr_rownum;
+
+  /* Whether the rows before next_rownum have been added to the item. */
+  bool have_rows;
+  /* The first row that has not been added yet. */
+  ha_rows next_rownum;
+  /*
+    The row the result was taken from, HA_POS_ERROR if it is NULL. Of rows
+    with equal values it is the first one, so the result can only be from
+    a row in the frame.
+  */
+  ha_rows result_rownum;
+
+  void reset()
+  {
+    clear_sum_functions();
+    have_rows= false;
+    result_rownum= HA_POS_ERROR;
+  }
+
+  void compute_values_for_current_row()
+  {
+    if (top_bound.is_outside_computation_bounds() ||
+        bottom_bound.is_outside_computation_bounds())
+    {
+      reset();
+      return;
+    }
+
+    ha_rows top_rownum= top_bound.get_curr_rownum();
+    ha_rows bottom_rownum= bottom_bound.get_curr_rownum();
+    if (bottom_rownum < top_rownum)
+    {
+      /* Empty frame */
+      reset();
+      return;
+    }
+
+    /*
+      The added rows that are above the frame now can be kept if the result
+      was not taken from one of them: all of them are then no better than
+      the result.
+    */
+    if (!have_rows || top_rownum > next_rownum ||
+        bottom_rownum + 1 < next_rownum ||
+        (result_rownum != HA_POS_ERROR && result_rownum < top_rownum))
+    {
+      reset();
+      next_rownum= top_rownum;
+    }
+    have_rows= true;
+
+    DBUG_PRINT("info", ("COMPUTING (%llu %llu)", next_rownum, bottom_rownum));
+    cursor.move_to(next_rownum);
+    for (; next_rownum <= bottom_rownum; next_rownum++)
+    {
+      if (cursor.fetch()) //EOF
+        break;
+      add_value_to_items();
+      if (item->last_added_is_result())
+        result_rownum= next_rownum;
+      if (cursor.next()) // EOF
+      {
+        next_rownum++;
+        break;
+      }
+    }
+  }
+};
+
+
 /* A cursor that follows a target cursor. Each time a new row is added,
    the window functions are cleared and only have the row at which the target
    is point at added to them.
@@ -2675,8 +2798,13 @@ void get_window_functions_required_cursors(
     {
       frame_bottom->set_no_action();
       frame_top->set_no_action();
-      Frame_cursor *scan_cursor= new Frame_scan_cursor(*frame_top,
-                                                       *frame_bottom);
+      Frame_cursor *scan_cursor;
+      if (sum_func->sum_func() == Item_sum::MIN_FUNC ||
+          sum_func->sum_func() == Item_sum::MAX_FUNC)
+        scan_cursor= new Frame_scan_min_max_cursor(*frame_top, *frame_bottom,
+                                             (Item_sum_hybrid *) sum_func);
+      else
+        scan_cursor= new Frame_scan_cursor(*frame_top, *frame_bottom);
       scan_cursor->add_sum_func(sum_func);
       cursor_manager->add_cursor(scan_cursor);
 
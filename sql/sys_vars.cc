@@ -2262,6 +2262,14 @@ static Sys_var_uint Sys_max_prepared_stmt_count(
        VALID_RANGE(0, UINT_MAX32), DEFAULT(16382), BLOCK_SIZE(1),
        &PLock_prepared_stmt_count);
 
+static Sys_var_uint Sys_max_text_statement_cache_count(
+       "max_text_statement_cache_count",
+       "Maximum number of statements in the text statement caches of all "
+       "connections, see text_statement_cache_size",
+       GLOBAL_VAR(max_text_statement_cache_count), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, UINT_MAX32), DEFAULT(16382), BLOCK_SIZE(1),
+       &PLock_prepared_stmt_count);
+
 static Sys_var_ulong Sys_max_recursive_iterations(
        "max_recursive_iterations",
        "Maximum number of iterations when executing recursive queries",
@@ -2518,6 +2526,7 @@ export const char *optimizer_switch_names[]=
   "condition_pushdown_for_derived",
   "split_materialized",
   "condition_pushdown_for_subquery",
+  "condition_compilation",
   "default", 
   NullS
 };
@@ -3011,6 +3020,32 @@ static Sys_var_mybool Sys_slave_compressed_protocol(
        DEFAULT(FALSE));
 
 #ifdef HAVE_REPLICATION
+static const char *slave_compression_algorithm_names[]= {"zlib", "zstd", 0};
+static bool check_slave_compression_algorithm(sys_var *self, THD *thd,
+                                              set_var *var)
+{
+  if (my_compress_algorithm_supported((uint) var->save_result.ulonglong_value))
+    return false;
+  my_error(ER_NOT_SUPPORTED_YET, MYF(0),
+           "Protocol compression with zstd in this build");
+  return true;
+}
+static Sys_var_enum Sys_slave_compression_algorithm(
+       "slave_compression_algorithm",
+       "Compression algorithm of the master/slave protocol when "
+       "slave_compressed_protocol is ON. If the master does not support "
+       "zstd, zlib is used",
+       GLOBAL_VAR(opt_slave_compression_algorithm), CMD_LINE(REQUIRED_ARG),
+       slave_compression_algorithm_names, DEFAULT(MY_COMPRESS_ZLIB),
+       NO_MUTEX_GUARD, NOT_IN_BINLOG,
+       ON_CHECK(check_slave_compression_algorithm));
+
+static Sys_var_uint Sys_slave_zstd_compression_level(
+       "slave_zstd_compression_level",
+       "Compression level of zstd on the master/slave protocol",
+       GLOBAL_VAR(opt_slave_zstd_compression_level), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 22), DEFAULT(3), BLOCK_SIZE(1));
+
 static const char *slave_exec_mode_names[]= {"STRICT", "IDEMPOTENT", 0};
 static Sys_var_enum Slave_exec_mode(
        "slave_exec_mode",
@@ -3526,6 +3561,15 @@ static Sys_var_uint Sys_table_cache_instances(
        READ_ONLY GLOBAL_VAR(tc_instances), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(1, 64), DEFAULT(8), BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_text_statement_cache_size(
+       "text_statement_cache_size",
+       "The number of text protocol statements kept prepared per connection. "
+       "SELECT, INSERT, REPLACE, UPDATE and DELETE statements that differ "
+       "only in literal values are re-executed from their cached prepared "
+       "form, skipping the parser. 0 disables the cache",
+       SESSION_VAR(text_statement_cache_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 16384), DEFAULT(0), BLOCK_SIZE(1));
+
 static Sys_var_ulong Sys_thread_cache_size(
        "thread_cache_size",
        "How many threads we should keep in a cache for reuse. These are freed after 5 minutes of idle time",
@@ -4633,6 +4677,12 @@ static Sys_var_have Sys_have_compress(
        "and UNCOMPRESS() functions will only be available if set to YES.",
        READ_ONLY GLOBAL_VAR(have_compress), NO_CMD_LINE);
 
+static Sys_var_have Sys_have_zstd(
+       "have_zstd", "If the server can use zstd instead of zlib in the "
+       "compressed client/server protocol, this will be set to YES, "
+       "otherwise it will be NO.",
+       READ_ONLY GLOBAL_VAR(have_zstd), NO_CMD_LINE);
+
 static Sys_var_have Sys_have_crypt(
        "have_crypt", "If the crypt() system call is available this variable will "
        "be set to YES, otherwise it will be set to NO. If set to NO, the "
@@ -5714,6 +5764,17 @@ static Sys_var_keycache Sys_key_cache_segments(
        BLOCK_SIZE(1), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
        ON_UPDATE(repartition_keycache));
 
+static Sys_var_keycache Sys_key_cache_clock(
+       "key_cache_clock",
+       "If set to 1, the key cache is not segmented and replaces blocks "
+       "with the clock algorithm. Blocks found in such a cache are read "
+       "without locking it",
+       KEYCACHE_VAR(param_clock),
+       CMD_LINE(REQUIRED_ARG, OPT_KEY_CACHE_CLOCK),
+       VALID_RANGE(0, 1), DEFAULT(0),
+       BLOCK_SIZE(1), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
+       ON_UPDATE(repartition_keycache));
+
 static const char *log_slow_filter_names[]= 
 {
   "admin", "filesort", "filesort_on_disk", "filesort_priority_queue",
@@ -5886,10 +5947,29 @@ static Sys_var_enum Sys_histogram_type(
        "Specifies type of the histograms created by ANALYZE. "
        "Possible values are: "
        "SINGLE_PREC_HB - single precision height-balanced, "
-       "DOUBLE_PREC_HB - double precision height-balanced.",
+       "DOUBLE_PREC_HB - double precision height-balanced, "
+       "DOUBLE_PREC_MCV_HB - double precision height-balanced with a list "
+       "of the most common values.",
        SESSION_VAR(histogram_type), CMD_LINE(REQUIRED_ARG),
        histogram_types, DEFAULT(0));
 
+static Sys_var_double Sys_analyze_sample_percentage(
+       "analyze_sample_percentage",
+       "Percentage of rows from the table ANALYZE TABLE will sample to "
+       "count distinct values and build histograms. Set to 0 to sample "
+       "about 100000 rows",
+       SESSION_VAR(sample_percentage), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 100), DEFAULT(100));
+
+static Sys_var_ulong Sys_analyze_refresh_percentage(
+       "analyze_refresh_percentage",
+       "ANALYZE TABLE without a PERSISTENT FOR clause does not collect "
+       "engine-independent statistics on a table again when less than "
+       "this percentage of its rows have changed since ANALYZE collected "
+       "them. If set to 0, the statistics are always collected",
+       SESSION_VAR(analyze_refresh_percentage), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 100), DEFAULT(0), BLOCK_SIZE(1));
+
 static Sys_var_mybool Sys_no_thread_alarm(
        "debug_no_thread_alarm",
        "Disable system thread alarm calls. Disabling it may be useful "
@@ -441,6 +441,7 @@ void TABLE_SHARE::destroy()
   /* The mutexes are initialized only for shares that are part of the TDC */
   if (tmp_table == NO_TMP_TABLE)
   {
+    flush_statistics_changes(this);
     mysql_mutex_destroy(&LOCK_share);
     mysql_mutex_destroy(&LOCK_ha_data);
   }
@@ -3607,6 +3608,10 @@ int closefrm(TABLE *table)
 
   if (table->db_stat)
     error=table->file->ha_close();
+  if (int64 rows_changed= my_atomic_fas64_explicit(&table->stats_rows_changed,
+                                                    0, MY_MEMORY_ORDER_RELAXED))
+    my_atomic_add64_explicit(&table->s->stats_cb.rows_changed, rows_changed,
+                             MY_MEMORY_ORDER_RELAXED);
   table->alias.free();
   if (table->expr_arena)
     table->expr_arena->free_items();
@@ -8063,57 +8068,108 @@ bool TABLE::insert_all_rows_into_tmp_table(THD *thd,
                                            TABLE *tmp_table,
                                            TMP_TABLE_PARAM *tmp_table_param,
                                            bool with_cleanup)
+{
+  List<TABLE> tmp_tables;
+  if (tmp_tables.push_back(tmp_table, thd->mem_root))
+    return true;
+  return insert_all_rows_into_tmp_tables(thd, tmp_tables, tmp_table_param,
+                                         with_cleanup);
+}
+
+
+/*
+  Copy all rows of this table into each of the tables in tmp_tables.
+  The tables must have the same record format as this one.
+
+  The rows are read only once and written to all the tables, which matters
+  for recursive CTEs referenced more than once: the new rows of each
+  iteration are copied into the tables of all recursive references.
+*/
+
+bool TABLE::insert_all_rows_into_tmp_tables(THD *thd,
+                                            List<TABLE> &tmp_tables,
+                                            TMP_TABLE_PARAM *tmp_table_param,
+                                            bool with_cleanup)
 {
   int write_err= 0;
+  List_iterator_fast<TABLE> it(tmp_tables);
+  TABLE *tmp_table;
+  TABLE *first_table= tmp_tables.head();
+
+  DBUG_ENTER("TABLE::insert_all_rows_into_tmp_tables");
 
-  DBUG_ENTER("TABLE::insert_all_rows_into_tmp_table");
+  if (!first_table)
+    DBUG_RETURN(0);
 
   if (with_cleanup)
   {
-   if ((write_err= tmp_table->file->ha_delete_all_rows()))
-      goto err;
+    while ((tmp_table= it++))
+    {
+      if ((write_err= tmp_table->file->ha_delete_all_rows()))
+      {
+        tmp_table->file->print_error(write_err, MYF(0));
+        DBUG_RETURN(1);
+      }
+    }
+    it.rewind();
   }
-   
+
   if (file->indexes_are_disabled())
-    tmp_table->file->ha_disable_indexes(HA_KEY_SWITCH_ALL);
+  {
+    while ((tmp_table= it++))
+      tmp_table->file->ha_disable_indexes(HA_KEY_SWITCH_ALL);
+    it.rewind();
+  }
   file->ha_index_or_rnd_end();
 
   if (unlikely(file->ha_rnd_init_with_error(1)))
     DBUG_RETURN(1);
 
-  if (tmp_table->no_rows)
-    tmp_table->file->extra(HA_EXTRA_NO_ROWS);
-  else
+  /* update table->file->stats.records */
+  file->info(HA_STATUS_VARIABLE);
+  while ((tmp_table= it++))
   {
-    /* update table->file->stats.records */
-    file->info(HA_STATUS_VARIABLE);
-    tmp_table->file->ha_start_bulk_insert(file->stats.records);
+    if (tmp_table->no_rows)
+      tmp_table->file->extra(HA_EXTRA_NO_ROWS);
+    else
+      tmp_table->file->ha_start_bulk_insert(file->stats.records);
   }
 
-  while (likely(!file->ha_rnd_next(tmp_table->record[0])))
+  while (likely(!file->ha_rnd_next(first_table->record[0])))
   {
-    write_err= tmp_table->file->ha_write_tmp_row(tmp_table->record[0]);
-    if (unlikely(write_err))
+    it.rewind();
+    while ((tmp_table= it++))
     {
-      bool is_duplicate;
-      if (tmp_table->file->is_fatal_error(write_err, HA_CHECK_DUP) &&
-          create_internal_tmp_table_from_heap(thd, tmp_table,
-                                              tmp_table_param->start_recinfo, 
-                                              &tmp_table_param->recinfo,
-                                              write_err, 1, &is_duplicate))
-	DBUG_RETURN(1);
-       
-    }  
+      if (tmp_table != first_table)
+        memcpy(tmp_table->record[0], first_table->record[0],
+               first_table->s->reclength);
+      write_err= tmp_table->file->ha_write_tmp_row(tmp_table->record[0]);
+      if (unlikely(write_err))
+      {
+        bool is_duplicate;
+        if (tmp_table->file->is_fatal_error(write_err, HA_CHECK_DUP) &&
+            create_internal_tmp_table_from_heap(thd, tmp_table,
+                                                tmp_table_param->start_recinfo,
+                                                &tmp_table_param->recinfo,
+                                                write_err, 1, &is_duplicate))
+          DBUG_RETURN(1);
+      }
+    }
     if (unlikely(thd->check_killed()))
       goto err_killed;
   }
-  if (!tmp_table->no_rows && tmp_table->file->ha_end_bulk_insert())
-    goto err;
+  it.rewind();
+  while ((tmp_table= it++))
+  {
+    if (!tmp_table->no_rows &&
+        (write_err= tmp_table->file->ha_end_bulk_insert()))
+    {
+      tmp_table->file->print_error(write_err, MYF(0));
+      goto err_killed;
+    }
+  }
   DBUG_RETURN(0);
 
-err:
-  DBUG_PRINT("error",("Got error: %d",write_err));
-  file->print_error(write_err, MYF(0));
 err_killed:
   (void) file->ha_rnd_end();
   DBUG_RETURN(1);
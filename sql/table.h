@@ -580,6 +580,13 @@ struct TABLE_STATISTICS_CB
                                     from statistical tables */
   bool histograms_can_be_read;
   bool histograms_are_read;   
+  /*
+    Rows changed through the closed instances of this share, see
+    statistics_are_up_to_date(). Open instances count their changes in
+    TABLE::stats_rows_changed. Updated with my_atomic_add64_explicit()
+    as TABLE_SHARE is copied by value for temporary tables.
+  */
+  int64 rows_changed;
 };
 
 /**
@@ -1189,6 +1196,12 @@ struct TABLE
     is collected by the function collect_statistics_for_table
   */
   Table_statistics *collected_stats;
+  /*
+    Rows changed through this instance and not yet added to
+    s->stats_cb.rows_changed. Updated atomically, as ANALYZE TABLE in
+    another thread resets it under LOCK_table_share.
+  */
+  int64 stats_rows_changed;
 
   /* The estimate of the number of records in the table used by optimizer */ 
   ha_rows used_stat_records;
@@ -1492,6 +1505,10 @@ struct TABLE
                                       TABLE *tmp_table,
                                       TMP_TABLE_PARAM *tmp_table_param,
                                       bool with_cleanup);
+  bool insert_all_rows_into_tmp_tables(THD *thd,
+                                       List<TABLE> &tmp_tables,
+                                       TMP_TABLE_PARAM *tmp_table_param,
+                                       bool with_cleanup);
   Field *find_field_by_name(LEX_CSTRING *str) const;
   bool export_structure(THD *thd, class Row_definition_list *defs);
   bool is_splittable() { return spl_opt_info != NULL; }
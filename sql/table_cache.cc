@@ -172,19 +172,24 @@ struct Table_cache_instance
       {
         if (n_instances < tc_instances)
         {
+          /*
+            Double the number of active instances, so that a busy server
+            gets enough of them after a few activations.
+          */
+          uint32 new_instances= MY_MIN(n_instances * 2, tc_instances);
           if (my_atomic_cas32_weak_explicit((int32*) &tc_active_instances,
                                             (int32*) &n_instances,
-                                            (int32) n_instances + 1,
+                                            (int32) new_instances,
                                             MY_MEMORY_ORDER_RELAXED,
                                             MY_MEMORY_ORDER_RELAXED))
           {
             sql_print_information("Detected table cache mutex contention at instance %d: "
-                                  "%d%% waits. Additional table cache instance "
+                                  "%d%% waits. Additional table cache instances "
                                   "activated. Number of instances after "
                                   "activation: %d.",
                                   instance + 1,
                                   mutex_waits * 100 / (mutex_nowaits + mutex_waits),
-                                  n_instances + 1);
+                                  new_instances);
           }
         }
         else if (!tc_contention_warning_reported.exchange(true,
@@ -215,6 +220,27 @@ struct Table_cache_instance
 static Table_cache_instance *tc;
 
 
+/**
+  Pick the table cache instance for the current thread.
+
+  Where possible the instance is chosen by the CPU the thread is running
+  on: threads on different CPUs then use different free lists and
+  mutexes, whatever their thread ids are, and the mutex is normally
+  uncontended. It is still needed, as a thread may be preempted or
+  migrate to another CPU while holding it.
+*/
+
+static inline uint32 tc_instance(THD *thd, uint32 n_instances)
+{
+#ifdef HAVE_SCHED_GETCPU
+  int cpu= sched_getcpu();
+  if (cpu >= 0)
+    return (uint32) cpu % n_instances;
+#endif
+  return (uint32) (thd->thread_id % n_instances);
+}
+
+
 static void intern_close_table(TABLE *table)
 {
   delete table->triggers;
@@ -354,8 +380,9 @@ void tc_purge(bool mark_flushed)
 
 void tc_add_table(THD *thd, TABLE *table)
 {
-  uint32 i= thd->thread_id % my_atomic_load32_explicit((int32*) &tc_active_instances,
-                                                       MY_MEMORY_ORDER_RELAXED);
+  uint32 i= tc_instance(thd,
+                        my_atomic_load32_explicit((int32*) &tc_active_instances,
+                                                  MY_MEMORY_ORDER_RELAXED));
   TABLE *LRU_table= 0;
   TDC_element *element= table->s->tdc;
 
@@ -411,7 +438,7 @@ TABLE *tc_acquire_table(THD *thd, TDC_element *element)
   uint32 n_instances=
     my_atomic_load32_explicit((int32*) &tc_active_instances,
                               MY_MEMORY_ORDER_RELAXED);
-  uint32 i= thd->thread_id % n_instances;
+  uint32 i= tc_instance(thd, n_instances);
   TABLE *table;
 
   tc[i].lock_and_check_contention(n_instances, i);
@@ -781,6 +808,43 @@ void tdc_unlock_share(TDC_element *element)
 }
 
 
+/**
+  Take one more reference to a share which is already in use, without
+  locking TABLE_SHARE::tdc.LOCK_table_share.
+
+  A share with non-zero ref_count can neither be freed nor moved to the
+  unused list, since both happen only after ref_count dropped to zero
+  under the mutex. So it is enough to increment a non-zero ref_count.
+
+  @return The share, or NULL if the share is not in use or can not be
+          returned for these flags: the caller must take the locked path,
+          which reports the error if any.
+*/
+
+static TABLE_SHARE *tdc_acquire_used_share(TDC_element *element, uint flags)
+{
+  uint32 ref_count= element->ref_count.load(std::memory_order_relaxed);
+  TABLE_SHARE *share;
+
+  do
+  {
+    if (!ref_count)
+      return 0;
+  } while (!element->ref_count.compare_exchange_weak(ref_count, ref_count + 1,
+                                                     std::memory_order_acquire,
+                                                     std::memory_order_relaxed));
+  share= element->share;
+  DBUG_ASSERT(share);
+  if (unlikely(share->error) ||
+      !(flags & (share->is_view ? GTS_VIEW : GTS_TABLE)))
+  {
+    tdc_release_share(share);
+    return 0;
+  }
+  return share;
+}
+
+
 /*
   Get TABLE_SHARE for a table.
 
@@ -882,6 +946,12 @@ TABLE_SHARE *tdc_acquire_share(THD *thd, TABLE_LIST *tl, uint flags,
     status_var_increment(thd->status_var.table_open_cache_misses);
   }
 
+  if ((share= tdc_acquire_used_share(element, flags)))
+  {
+    lf_hash_search_unpin(thd->tdc_hash_pins);
+    goto end;
+  }
+
   mysql_mutex_lock(&element->LOCK_table_share);
   if (!(share= element->share))
   {
@@ -934,7 +1004,7 @@ TABLE_SHARE *tdc_acquire_share(THD *thd, TABLE_LIST *tl, uint flags,
 
 end:
   DBUG_PRINT("exit", ("share: %p  ref_count: %u",
-                      share, share->tdc->ref_count));
+                      share, (uint) share->tdc->ref_count));
   if (flags & GTS_NOLOCK)
   {
     tdc_release_share(share);
@@ -967,7 +1037,7 @@ void tdc_release_share(TABLE_SHARE *share)
   DBUG_PRINT("enter",
              ("share: %p  table: %s.%s  ref_count: %u  version: %lld",
               share, share->db.str, share->table_name.str,
-              share->tdc->ref_count, share->tdc->version));
+              (uint) share->tdc->ref_count, share->tdc->version));
   DBUG_ASSERT(share->tdc->ref_count);
 
   if (share->tdc->ref_count > 1)
@@ -38,12 +38,15 @@ struct TDC_element
   TABLE_SHARE *share;
 
   /**
-    Protects ref_count, m_flush_tickets, all_tables, flushed, all_tables_refs.
+    Protects m_flush_tickets, all_tables, flushed, all_tables_refs and
+    transitions of ref_count from and to zero. Once the share is in use,
+    more references may be taken without the mutex.
   */
   mysql_mutex_t LOCK_table_share;
   mysql_cond_t COND_release;
   TDC_element *next, **prev;            /* Link to unused shares */
-  uint ref_count;                       /* How many TABLE objects uses this */
+  /** How many TABLE objects uses this */
+  std::atomic<uint32> ref_count;
   uint all_tables_refs;                 /* Number of refs to all_tables */
   /**
     List of tickets representing threads waiting for the share to be flushed.
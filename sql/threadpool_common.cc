@@ -291,7 +291,8 @@ static void threadpool_remove_connection(THD *thd)
   end_connection(thd);
   close_connection(thd, 0);
   unlink_thd(thd);
-  delete thd;
+  if (!put_thd_in_pool(thd))
+    delete thd;
 
   /*
     Free resources associated with this connection: 
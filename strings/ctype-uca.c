@@ -34,6 +34,9 @@
 
 #include "strings_def.h"
 #include <m_ctype.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #define  MY_CS_COMMON_UCA_FLAGS (MY_CS_COMPILED|MY_CS_STRNXFRM|MY_CS_UNICODE|MY_CS_NON1TO1)
 
@@ -31748,6 +31751,71 @@ my_space_weight(const MY_UCA_WEIGHT_LEVEL *level)
 }
 
 
+/*
+  Number of bytes in an ASCII run that is mapped to weights in bulk
+  by the ASCII fast paths of the character sets with mbminlen=1.
+*/
+#define MY_UCA_ASCII_RUN 16
+
+
+/**
+  Helper function:
+  Check if the next MY_UCA_ASCII_RUN bytes are all ASCII characters.
+*/
+
+static inline my_bool
+my_uca_is_ascii_run(const uchar *str)
+{
+#ifdef __SSE2__
+  return !_mm_movemask_epi8(_mm_loadu_si128((const __m128i *) str));
+#else
+  ulonglong a, b;
+  memcpy(&a, str, 8);
+  memcpy(&b, str + 8, 8);
+  return !((a | b) & 0x8080808080808080ULL);
+#endif
+}
+
+
+/**
+  Helper function:
+  Find the length of the common prefix of two strings
+  that consists of ASCII characters only.
+
+  The prefix is compared in blocks of MY_UCA_ASCII_RUN bytes,
+  then byte by byte.
+
+  @param s      first string
+  @param t      second string
+  @param length length of the shorter string
+
+  @return Number of leading bytes that are equal ASCII characters
+*/
+
+static inline size_t
+my_uca_ascii_common_prefix(const uchar *s, const uchar *t, size_t length)
+{
+  const uchar *s0= s, *end= s + length;
+  for ( ; s + MY_UCA_ASCII_RUN <= end;
+        s+= MY_UCA_ASCII_RUN, t+= MY_UCA_ASCII_RUN)
+  {
+#ifdef __SSE2__
+    __m128i a= _mm_loadu_si128((const __m128i *) s);
+    __m128i b= _mm_loadu_si128((const __m128i *) t);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF ||
+        _mm_movemask_epi8(a))
+      break;
+#else
+    if (memcmp(s, t, MY_UCA_ASCII_RUN) || !my_uca_is_ascii_run(s))
+      break;
+#endif
+  }
+  for ( ; s < end && *s == *t && *s < 0x80; s++, t++)
+  { }
+  return s - s0;
+}
+
+
 /**
   Helper function:
   Find address of weights of the given character.
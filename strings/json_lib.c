@@ -2,6 +2,9 @@
 #include <string.h>
 #include <m_ctype.h>
 #include "json_lib.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 /*
   JSON escaping lets user specify UTF16 codes of characters.
@@ -26,6 +29,7 @@ void json_string_set_cs(json_string_t *s, CHARSET_INFO *i_cs)
   s->cs= i_cs;
   s->error= 0;
   s->wc= i_cs->cset->mb_wc;
+  s->ascii_based= i_cs->mbminlen == 1 && !(i_cs->state & MY_CS_NONASCII);
 }
 
 
@@ -243,6 +247,37 @@ static enum json_string_char_classes json_instr_chr_map[128] = {
 };
 
 
+/*
+  Skip the characters of a string constant that need no special handling,
+  that is ASCII characters except the quote, the backslash and the control
+  characters. Used for the ascii_based character sets only, so that any
+  other byte is left to the charset handler to be read as a character.
+
+  Returns the position of the first byte that was not skipped.
+*/
+static const uchar *skip_plain_ascii(const uchar *str, const uchar *end)
+{
+#ifdef __SSE2__
+  const __m128i quote= _mm_set1_epi8('"');
+  const __m128i bksl= _mm_set1_epi8('\\');
+  const __m128i space= _mm_set1_epi8(' ');
+  for ( ; end - str >= 16; str+= 16)
+  {
+    __m128i c= _mm_loadu_si128((const __m128i *) str);
+    /* Signed comparison: the control characters and the bytes >= 0x80 */
+    __m128i special= _mm_or_si128(_mm_cmplt_epi8(c, space),
+                                  _mm_or_si128(_mm_cmpeq_epi8(c, quote),
+                                               _mm_cmpeq_epi8(c, bksl)));
+    if (_mm_movemask_epi8(special))
+      break;
+  }
+#endif
+  for ( ; str < end && *str < 128 && json_instr_chr_map[*str] <= S_ETC; str++)
+  { }
+  return str;
+}
+
+
 static int read_4_hexdigits(json_string_t *s, uchar *dest)
 {
   int i, t, c_len;
@@ -354,6 +389,8 @@ static int skip_str_constant(json_engine_t *j)
   int t, c_len;
   for (;;)
   {
+    if (j->s.ascii_based)
+      j->s.c_str= skip_plain_ascii(j->s.c_str, j->s.str_end);
     if ((c_len= json_next_char(&j->s)) > 0)
     {
       j->s.c_str+= c_len;
@@ -680,6 +717,12 @@ static int read_keyname(json_engine_t *j)
 
 static void get_first_nonspace(json_string_t *js, int *t_next, int *c_len)
 {
+  if (js->ascii_based)
+  {
+    while (js->c_str < js->str_end && *js->c_str < 128 &&
+           json_chr_map[*js->c_str] == C_SPACE)
+      js->c_str++;
+  }
   do
   {
     if ((*c_len= json_next_char(js)) <= 0)
@@ -819,11 +862,24 @@ static int skip_colon(json_engine_t *j)
 }
 
 
+/* Read the rest of the key name, up to the colon. */
+static int skip_keyname(json_engine_t *j)
+{
+  do
+  {
+    if (j->s.ascii_based)
+      j->s.c_str= skip_plain_ascii(j->s.c_str, j->s.str_end);
+  } while (json_read_keyname_chr(j) == 0);
+
+  return j->s.error;
+}
+
+
 /* Skip colon and the value. */
 static int skip_key(json_engine_t *j)
 {
   int t_next, c_len;
-  while (json_read_keyname_chr(j) == 0) {}
+  skip_keyname(j);
 
   if (j->s.error)
     return 1;
@@ -926,13 +982,8 @@ int json_read_value(json_engine_t *j)
 {
   int t_next, c_len, res;
 
-  if (j->state == JST_KEY)
-  {
-    while (json_read_keyname_chr(j) == 0) {}
-
-    if (j->s.error)
-      return 1;
-  }
+  if (j->state == JST_KEY && skip_keyname(j))
+    return 1;
 
   get_first_nonspace(&j->s, &t_next, &c_len);
 
@@ -0,0 +1,247 @@
+/* Copyright (c) 2019, MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA */
+
+/*
+  Tests and benchmarks of the json_lib scanner on large documents.
+
+  For the ASCII based character sets the scanner skips runs of plain
+  ASCII characters in bulk. The results are checked against the
+  character by character scanning, which is forced by clearing
+  json_string_t::ascii_based, on valid and broken documents.
+
+  Then the scanning and the path search are timed. The number of rounds
+  can be given as the first argument.
+*/
+
+#include "my_config.h"
+#include "config.h"
+#include <tap.h>
+#include <my_global.h>
+#include <my_sys.h>
+#include <m_string.h>
+#include <json_lib.h>
+
+static CHARSET_INFO *ci;
+
+#define N_RECORDS 2000
+
+static uchar *doc;
+static size_t doc_length;
+
+
+/*
+  Generate an array of records with nested objects and arrays, long
+  strings, non-ASCII characters, escapings and pretty printing.
+*/
+static void generate_doc()
+{
+  size_t alloced= N_RECORDS * 512;
+  char *d;
+  uint i;
+
+  doc= (uchar *) my_malloc(alloced, MYF(MY_WME));
+  d= (char *) doc;
+  d+= my_snprintf(d, 16, "[\n");
+  for (i= 0; i < N_RECORDS; i++)
+  {
+    d+= my_snprintf(d, 512,
+                    "%s  {\"id\": %u, \"name\": \"customer number %u\",\n"
+                    "    \"email\": \"customer.%u@example.com\",\n"
+                    "    \"note\": \"%s\",\n"
+                    "    \"address\": {\"street\": \"Main street %u\", "
+                    "\"city\": \"K\xc3\xb6ln\", \"zip\": \"%u\"},\n"
+                    "    \"tags\": [\"a\", \"b\\\"c\", \"\\u00e9t\\u00e9\"],\n"
+                    "    \"score\": %u.%02u, \"active\": %s, \"ref\": null}",
+                    i ? ",\n" : "", i, i, i,
+                    (i % 3) ? "A longer text value that takes most of the "
+                              "record and has no special characters at all"
+                            : "Short \\\\ escaped \\t text",
+                    i * 7, (i * 31) % 100000, i % 100, (i * 13) % 100,
+                    (i & 1) ? "true" : "false");
+  }
+  d+= my_snprintf(d, 16, "\n]");
+  doc_length= d - (char *) doc;
+}
+
+
+/*
+  Scan the document, reading all keys and values, and compute a checksum
+  of the parser states, positions and values. Checking the fast path
+  against the slow one this way covers json_read_value() and the key
+  skipping, while json_skip_level() covers json_scan_next() alone.
+*/
+static int scan_doc(const uchar *js, size_t length, my_bool fast,
+                    ulonglong *csum)
+{
+  json_engine_t je;
+  *csum= 0;
+
+  json_scan_start(&je, ci, js, js + length);
+  je.s.ascii_based&= fast;
+
+  do
+  {
+    *csum= *csum * 31 + je.state;
+    if (je.state == JST_KEY || je.state == JST_VALUE)
+    {
+      if (json_read_value(&je))
+        break;
+      *csum= *csum * 31 + je.value_type;
+      *csum= *csum * 31 + (je.value_begin - js);
+      if (json_value_scalar(&je))
+        *csum= *csum * 31 + je.value_len;
+      else if ((je.s.c_str - js) % 2 && json_skip_level(&je))
+        break;
+    }
+    *csum= *csum * 31 + (je.s.c_str - js);
+  } while (json_scan_next(&je) == 0);
+
+  return je.s.error;
+}
+
+
+static int compare_scans(const uchar *js, size_t length, const char *what)
+{
+  ulonglong csum, csum_fast;
+  int error= scan_doc(js, length, FALSE, &csum);
+  int error_fast= scan_doc(js, length, TRUE, &csum_fast);
+  if (error != error_fast || csum != csum_fast)
+  {
+    diag("%s: error %d/%d checksum %llu/%llu", what, error, error_fast,
+         csum, csum_fast);
+    return 1;
+  }
+  return 0;
+}
+
+
+static void test_scan()
+{
+  uchar *broken= (uchar *) my_malloc(doc_length, MYF(MY_WME));
+  int failed= 0;
+  size_t pos;
+  ulonglong csum;
+
+  ok(scan_doc(doc, doc_length, TRUE, &csum) == 0, "valid document");
+  failed+= compare_scans(doc, doc_length, "valid document");
+
+  /*
+    Break the document in different places: truncate it, put a control
+    character, a bad utf8 byte or a quote inside the strings.
+  */
+  for (pos= 1; pos < doc_length; pos= pos * 3 / 2 + 7)
+  {
+    static const uchar bad_chars[]= {'\n', 0xC3, 0xFF, '"', '\\', ':'};
+    uint i;
+    failed+= compare_scans(doc, pos, "truncated document");
+    for (i= 0; i < array_elements(bad_chars); i++)
+    {
+      memcpy(broken, doc, doc_length);
+      broken[pos]= bad_chars[i];
+      failed+= compare_scans(broken, doc_length, "broken document");
+    }
+  }
+  ok(failed == 0, "bulk scanning matches character scanning");
+  my_free(broken);
+}
+
+
+static int find_path(const char *path, my_bool fast, uint *n_found)
+{
+  json_engine_t je;
+  json_path_t p;
+  json_path_step_t *cur_step;
+  uint array_counters[JSON_DEPTH_LIMIT];
+
+  *n_found= 0;
+  if (json_path_setup(&p, ci, (const uchar *) path,
+                      (const uchar *) path + strlen(path)))
+    return 1;
+  json_scan_start(&je, ci, doc, doc + doc_length);
+  je.s.ascii_based&= fast;
+  cur_step= p.steps;
+  while (json_find_path(&je, &p, &cur_step, array_counters) == 0)
+  {
+    (*n_found)++;
+    if (json_read_value(&je) ||
+        (!json_value_scalar(&je) && json_skip_level(&je)) ||
+        json_scan_next(&je))
+      break;
+  }
+  return je.s.error;
+}
+
+
+static void bench(uint rounds)
+{
+  static const char *paths[]= {"$[1999].address.city", "$[*].email",
+                               "$[*].tags[*]"};
+  ulonglong start, csum;
+  uint r, i, n_found;
+  int fast;
+
+  for (fast= 0; fast <= 1; fast++)
+  {
+    start= my_interval_timer();
+    for (r= 0; r < rounds; r++)
+      scan_doc(doc, doc_length, fast, &csum);
+    diag("scan %s: %.2f ms per %u kB document",
+         fast ? "bulk     " : "by chars ",
+         (double) (my_interval_timer() - start) / rounds / 1e6,
+         (uint) (doc_length / 1024));
+  }
+
+  for (i= 0; i < array_elements(paths); i++)
+  {
+    for (fast= 0; fast <= 1; fast++)
+    {
+      start= my_interval_timer();
+      for (r= 0; r < rounds; r++)
+        find_path(paths[i], fast, &n_found);
+      diag("path %-22s %s: %.2f ms, %u found", paths[i],
+           fast ? "bulk    " : "by chars",
+           (double) (my_interval_timer() - start) / rounds / 1e6, n_found);
+    }
+  }
+}
+
+
+int main(int argc __attribute__((unused)), char **argv)
+{
+  uint n_found, rounds= 5;
+  MY_INIT(argv[0]);
+  ci= &my_charset_utf8mb4_general_ci;
+
+  if (argv[1] && *argv[1])
+    rounds= atoi(argv[1]);
+
+  plan(4);
+  generate_doc();
+
+  test_scan();
+  ok(find_path("$[*].address.zip", TRUE, &n_found) == 0 &&
+     n_found == N_RECORDS, "path search");
+
+  ci= &my_charset_latin1;
+  ok(compare_scans(doc, doc_length, "latin1 document") == 0,
+     "bulk scanning in latin1");
+  ci= &my_charset_utf8mb4_general_ci;
+
+  bench(rounds);
+
+  my_free(doc);
+  my_end(0);
+  return exit_status();
+}
@@ -0,0 +1,253 @@
+/* Copyright (c) 2019, MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/*
+  Concurrent requests to simple and clock key caches: threads write,
+  partially write and read their own pages and read the pages of the
+  other threads, while another thread resizes and flushes the cache.
+  Afterwards the cache is flushed and the file must contain the last
+  version of every page. As in the server, a page is not read while it
+  is written.
+*/
+
+#include <my_global.h>
+#include <my_sys.h>
+#include <my_atomic.h>
+#include <keycache.h>
+#include <tap.h>
+
+#define BLOCK_SIZE 1024
+#define THREADS 8
+#define PAGES 400                               /* Pages of every thread */
+#define BLOCK_MEM (BLOCK_SIZE + 200)            /* Memory of a block */
+
+static KEY_CACHE keycache;
+static File file;
+static uint versions[THREADS][PAGES];
+static rw_lock_t page_locks[THREADS];           /* Like the MyISAM key locks */
+static uint iterations= 10000;
+static volatile int32 stop_resize;
+static volatile int32 errors;
+
+
+static my_off_t page_pos(uint thread, uint page)
+{
+  return (my_off_t) (thread * PAGES + page) * BLOCK_SIZE;
+}
+
+
+/* The contents of a version of a page, the first word is the page number */
+
+static void fill_page(uchar *buff, uint thread, uint page, uint version)
+{
+  uint i;
+  for (i= 0; i < BLOCK_SIZE / 4; i++)
+    int4store(buff + i * 4, (thread << 24) ^ (page << 8) ^ version ^ i);
+  int4store(buff, thread * PAGES + page);
+}
+
+
+static my_bool check_page(const uchar *buff, uint thread, uint page,
+                          uint version)
+{
+  uchar expected[BLOCK_SIZE];
+  fill_page(expected, thread, page, version);
+  return MY_TEST(memcmp(expected, buff, BLOCK_SIZE));
+}
+
+
+static void report_error(const char *msg, uint thread, uint page)
+{
+  my_atomic_add32(&errors, 1);
+  diag("%s: thread %u page %u", msg, thread, page);
+}
+
+
+/*
+  Changes go to the cache only (dont_write), as in the server. Writing
+  through to the file is not safe against a concurrent eviction.
+*/
+
+static void write_page(uint thread, uint page, my_bool partial)
+{
+  uchar buff[BLOCK_SIZE];
+  my_off_t pos= page_pos(thread, page);
+  fill_page(buff, thread, page, ++versions[thread][page]);
+  rw_wrlock(&page_locks[thread]);
+  if (partial)
+  {
+    /* The second half first, so that the first one is not a full block */
+    if (key_cache_write(&keycache, file, 0, pos + BLOCK_SIZE / 2, 3,
+                        buff + BLOCK_SIZE / 2, BLOCK_SIZE / 2, BLOCK_SIZE,
+                        1) ||
+        key_cache_write(&keycache, file, 0, pos, 3, buff, BLOCK_SIZE / 2,
+                        BLOCK_SIZE, 1))
+      report_error("partial write failed", thread, page);
+  }
+  else if (key_cache_write(&keycache, file, 0, pos, 3, buff, BLOCK_SIZE,
+                           BLOCK_SIZE, 1))
+    report_error("write failed", thread, page);
+  rw_unlock(&page_locks[thread]);
+}
+
+
+pthread_handler_t worker(void *arg)
+{
+  uint thread= (uint) (size_t) arg, i;
+  uint seed= thread * 7919 + 1;
+  uchar buff[BLOCK_SIZE];
+
+  my_thread_init();
+  for (i= 0; i < iterations; i++)
+  {
+    uint page= rand_r(&seed) % PAGES;
+    uint op= rand_r(&seed) % 10;
+    if (op < 3)
+      write_page(thread, page, op == 0);
+    else if (op < 8)
+    {
+      /* Only this thread changes its pages */
+      if (!key_cache_read(&keycache, file, page_pos(thread, page), 3, buff,
+                          BLOCK_SIZE, BLOCK_SIZE, 0) ||
+          check_page(buff, thread, page, versions[thread][page]))
+        report_error("wrong page read", thread, page);
+    }
+    else
+    {
+      uint other= rand_r(&seed) % THREADS;
+      my_bool read_error;
+      rw_rdlock(&page_locks[other]);
+      read_error= !key_cache_read(&keycache, file, page_pos(other, page), 3,
+                                  buff, BLOCK_SIZE, BLOCK_SIZE, 0);
+      rw_unlock(&page_locks[other]);
+      if (read_error || uint4korr(buff) != other * PAGES + page)
+        report_error("wrong page of another thread read", other, page);
+    }
+  }
+  my_thread_end();
+  return 0;
+}
+
+
+pthread_handler_t resizer(void *arg __attribute__((unused)))
+{
+  uint i= 0;
+  my_thread_init();
+  while (!my_atomic_load32(&stop_resize))
+  {
+    size_t mem= (++i % 2 ? 200 : 1200) * BLOCK_MEM;
+    my_sleep(20000);
+    if (!resize_key_cache(&keycache, BLOCK_SIZE, mem, 100, 300, 512))
+      report_error("resize failed", 0, 0);
+    if (i % 5 == 0 && flush_key_blocks(&keycache, file, 0, FLUSH_KEEP))
+      report_error("flush failed", 0, 0);
+  }
+  my_thread_end();
+  return 0;
+}
+
+
+static void test_keycache(my_bool clock, my_bool resize)
+{
+  pthread_t threads[THREADS], resize_thread;
+  uchar buff[BLOCK_SIZE];
+  uint thread, page, wrong_pages= 0;
+  const char *name= clock ? "clock" : "simple";
+  ulonglong start= my_interval_timer();
+
+  for (thread= 0; thread < THREADS; thread++)
+    for (page= 0; page < PAGES; page++)
+    {
+      versions[thread][page]= 0;
+      fill_page(buff, thread, page, 0);
+      my_pwrite(file, buff, BLOCK_SIZE, page_pos(thread, page),
+                MYF(MY_NABP | MY_WME));
+    }
+
+  bzero(&keycache, sizeof(keycache));
+  keycache.param_clock= clock;
+  errors= 0;
+  stop_resize= 0;
+  if (init_key_cache(&keycache, BLOCK_SIZE, 600 * BLOCK_MEM, 100, 300, 512,
+                     0) <= 0)
+  {
+    ok(0, "%s key cache: init_key_cache()", name);
+    ok(0, "%s key cache: file contents", name);
+    return;
+  }
+
+  for (thread= 0; thread < THREADS; thread++)
+    pthread_create(&threads[thread], 0, worker, (void*) (size_t) thread);
+  if (resize)
+    pthread_create(&resize_thread, 0, resizer, 0);
+  for (thread= 0; thread < THREADS; thread++)
+    pthread_join(threads[thread], 0);
+  if (resize)
+  {
+    my_atomic_store32(&stop_resize, 1);
+    pthread_join(resize_thread, 0);
+  }
+  if (flush_key_blocks(&keycache, file, 0, FLUSH_RELEASE))
+    report_error("flush failed", 0, 0);
+
+  ok(!errors && keycache.key_cache_type ==
+                (clock ? CLOCK_KEY_CACHE : SIMPLE_KEY_CACHE),
+     "%s key cache%s: %u requests of %d threads in %g secs",
+     name, resize ? " with resizes" : "", iterations * THREADS, THREADS,
+     (my_interval_timer() - start) / 1e9);
+
+  for (thread= 0; thread < THREADS; thread++)
+    for (page= 0; page < PAGES; page++)
+    {
+      if (my_pread(file, buff, BLOCK_SIZE, page_pos(thread, page),
+                   MYF(MY_NABP | MY_WME)) ||
+          check_page(buff, thread, page, versions[thread][page]))
+        wrong_pages++;
+    }
+  ok(!wrong_pages, "%s key cache%s: file contents, %u wrong pages",
+     name, resize ? " with resizes" : "", wrong_pages);
+  end_key_cache(&keycache, 1);
+}
+
+
+int main(int argc __attribute__((unused)), char **argv)
+{
+  char path[FN_REFLEN];
+  uint thread;
+  MY_INIT(argv[0]);
+
+  if (argv[1] && *argv[1])
+    iterations= (uint) atoi(argv[1]);
+
+  plan(8);
+
+  if ((file= create_temp_file(path, NULL, "kc", O_RDWR | O_TRUNC,
+                              MYF(MY_WME))) < 0)
+    BAIL_OUT("Could not create a temporary file");
+  for (thread= 0; thread < THREADS; thread++)
+    my_rwlock_init(&page_locks[thread], NULL);
+
+  test_keycache(0, 0);
+  test_keycache(0, 1);
+  test_keycache(1, 0);
+  test_keycache(1, 1);
+
+  for (thread= 0; thread < THREADS; thread++)
+    rwlock_destroy(&page_locks[thread]);
+  my_close(file, MYF(0));
+  my_delete(path, MYF(0));
+  my_end(0);
+  return exit_status();
+}
@@ -0,0 +1,266 @@
+/* Copyright (c) 2019, MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/*
+  Tests and benchmarks of the compression of protocol packets.
+
+  my_compress_packet() and my_uncompress_packet() are checked by round
+  trips with all compiled in algorithms, and zlib also against the old
+  my_compress() and my_uncompress() that the peers may use.
+
+  Then a result set of text protocol rows is compressed in packets of
+  the size of the net buffer and uncompressed again. The size of the
+  result set in MB can be given as the first argument.
+*/
+
+#include <my_global.h>
+#include <my_sys.h>
+#include <m_string.h>
+#include <tap.h>
+
+#define PACKET_SIZE 16384                       /* net_buffer_length */
+
+static ulong rnd_state= 1;
+
+static uint rnd(uint max)
+{
+  rnd_state= rnd_state * 1103515245 + 12345;
+  return (uint) ((rnd_state >> 16) % max);
+}
+
+
+/* A column of a text protocol row, all of them are shorter than 251 */
+static uchar *store_column(uchar *to, const char *str, size_t length)
+{
+  *to++= (uchar) length;
+  memcpy(to, str, length);
+  return to + length;
+}
+
+
+/* Text protocol rows, as a dump reads them */
+static size_t fill_rows(uchar *to, size_t length)
+{
+  static const char *words[]= { "the", "quick", "brown", "fox", "jumps",
+    "over", "lazy", "dog", "carefully", "final", "deposits", "sleep",
+    "among", "pending", "requests", "furiously" };
+  uchar *pos= to, *end= to + length - 256;
+  char col[200];
+  uint id= 0, i, col_length;
+
+  while (pos < end)
+  {
+    pos= store_column(pos, col, sprintf(col, "%u", ++id));
+    pos= store_column(pos, col, sprintf(col, "Customer#%09u",
+                                        rnd(150000)));
+    pos= store_column(pos, col, sprintf(col, "%d.%02u",
+                                        (int) rnd(2000000) - 1000000,
+                                        rnd(100)));
+    pos= store_column(pos, col, sprintf(col, "199%u-%02u-%02u", rnd(10),
+                                        1 + rnd(12), 1 + rnd(28)));
+    for (i= rnd(8) + 2, col_length= 0; i; i--)
+      col_length+= sprintf(col + col_length, "%s ",
+                           words[rnd(array_elements(words))]);
+    pos= store_column(pos, col, col_length);
+  }
+  return (size_t) (pos - to);
+}
+
+
+static size_t random_bytes(uchar *to, size_t length)
+{
+  size_t i;
+  for (i= 0; i < length; i++)
+    to[i]= (uchar) rnd(256);
+  return length;
+}
+
+
+/* Compress and uncompress, 0 if the data survived */
+static int round_trip(uint algorithm, int level, const uchar *data,
+                      size_t length, size_t *complen_out)
+{
+  uchar *buff= (uchar*) malloc(length + 1);
+  size_t complen, len;
+  int res= 1;
+
+  if ((complen= my_compress_packet(algorithm, level, data, length, buff)))
+  {
+    if (complen >= length)
+      goto end;
+    len= length;
+    if (my_uncompress_packet(algorithm, buff, complen, &len) ||
+        len != length)
+      goto end;
+  }
+  else
+  {
+    memcpy(buff, data, length);
+    len= 0;
+    if (my_uncompress_packet(algorithm, buff, length, &len) ||
+        len != length)
+      goto end;
+  }
+  res= memcmp(buff, data, length) != 0;
+  *complen_out= complen;
+end:
+  free(buff);
+  return res;
+}
+
+
+static void test_algorithm(uint algorithm, const char *name,
+                           const uchar *rows, const uchar *random)
+{
+  static const size_t sizes[]= { 1, 49, 50, 100, 1000, PACKET_SIZE,
+                                 1024*1024 };
+  uchar buff[PACKET_SIZE + 1];
+  size_t i, complen, len;
+  int failed= 0;
+
+  for (i= 0; i < array_elements(sizes); i++)
+  {
+    failed+= round_trip(algorithm, 0, rows, sizes[i], &complen);
+    /* Short packets are sent as they are, rows get always shorter */
+    if ((sizes[i] < MIN_COMPRESS_LENGTH && complen) ||
+        (sizes[i] >= 1000 && !complen))
+      failed++;
+    failed+= round_trip(algorithm, 1, rows + 17, sizes[i], &complen);
+    failed+= round_trip(algorithm, 9, rows, sizes[i], &complen);
+  }
+  ok(!failed, "%s: round trips", name);
+
+  ok(round_trip(algorithm, 0, random, PACKET_SIZE, &complen) == 0 &&
+     complen == 0, "%s: random data is not compressed", name);
+
+  complen= my_compress_packet(algorithm, 0, rows, PACKET_SIZE, buff);
+  buff[complen / 2]^= 0x55;
+  len= PACKET_SIZE;
+  ok(complen && my_uncompress_packet(algorithm, buff, complen, &len),
+     "%s: corrupted packet", name);
+}
+
+
+static void test_zlib_compatibility(const uchar *rows)
+{
+  uchar buff[PACKET_SIZE + 1];
+  size_t len= PACKET_SIZE, complen;
+
+  complen= my_compress_packet(MY_COMPRESS_ZLIB, 0, rows, PACKET_SIZE, buff);
+  ok(complen && !my_uncompress(buff, complen, &len) && len == PACKET_SIZE &&
+     !memcmp(buff, rows, PACKET_SIZE),
+     "my_uncompress() of my_compress_packet()");
+
+  memcpy(buff, rows, PACKET_SIZE);
+  len= PACKET_SIZE;
+  ok(!my_compress(buff, &len, &complen) && complen == PACKET_SIZE &&
+     !my_uncompress_packet(MY_COMPRESS_ZLIB, buff, len, &complen) &&
+     complen == PACKET_SIZE && !memcmp(buff, rows, PACKET_SIZE),
+     "my_uncompress_packet() of my_compress()");
+}
+
+
+/*
+  What net_real_write() and my_net_read() do with a result set sent in
+  packets of packet_size bytes
+*/
+static void bench(const char *name, uint algorithm, int level,
+                  size_t packet_size, const uchar *rows, size_t length)
+{
+  uchar buff[PACKET_SIZE + 1];
+  size_t pos, complen, total= 0, len;
+  ulonglong start, compress_time, uncompress_time= 0;
+
+  length-= length % packet_size;
+  start= my_interval_timer();
+  for (pos= 0; pos < length; pos+= packet_size)
+  {
+    if (level < 0)
+    {
+      /* The old way: a copy, and a new zlib stream for every packet */
+      memcpy(buff, rows + pos, packet_size);
+      len= packet_size;
+      if (my_compress(buff, &len, &complen) || !complen)
+        len= packet_size;
+    }
+    else if (!(len= my_compress_packet(algorithm, level, rows + pos,
+                                       packet_size, buff)))
+      len= packet_size;
+    total+= len;
+  }
+  compress_time= my_interval_timer() - start;
+
+  /* Compress again, and time only the uncompression */
+  for (pos= 0; pos < length; pos+= packet_size)
+  {
+    len= my_compress_packet(algorithm, level < 0 ? 0 : level, rows + pos,
+                            packet_size, buff);
+    complen= packet_size;
+    start= my_interval_timer();
+    if (level < 0)
+      my_uncompress(buff, len, &complen);
+    else
+      my_uncompress_packet(algorithm, buff, len, &complen);
+    uncompress_time+= my_interval_timer() - start;
+  }
+  diag("%-14s %5u byte packets: %5.1f%% of the size, "
+       "compress %6.1f MB/s, uncompress %6.1f MB/s",
+       name, (uint) packet_size, 100.0 * total / length,
+       length * 1e3 / compress_time, length * 1e3 / uncompress_time);
+}
+
+
+static void bench_all(size_t packet_size, const uchar *rows, size_t length)
+{
+  bench("my_compress()", MY_COMPRESS_ZLIB, -1, packet_size, rows, length);
+  bench("zlib level 6", MY_COMPRESS_ZLIB, 6, packet_size, rows, length);
+  bench("zlib level 1", MY_COMPRESS_ZLIB, 1, packet_size, rows, length);
+  if (my_compress_algorithm_supported(MY_COMPRESS_ZSTD))
+  {
+    bench("zstd level 1", MY_COMPRESS_ZSTD, 1, packet_size, rows, length);
+    bench("zstd level 3", MY_COMPRESS_ZSTD, 3, packet_size, rows, length);
+    bench("zstd level 9", MY_COMPRESS_ZSTD, 9, packet_size, rows, length);
+  }
+}
+
+
+int main(int argc __attribute__((unused)), char **argv)
+{
+  size_t length= 4 * 1024 * 1024, rows_length;
+  uchar *rows, *random;
+  MY_INIT(argv[0]);
+
+  if (argv[1] && *argv[1])
+    length= (size_t) atoi(argv[1]) * 1024 * 1024;
+  rows= (uchar*) malloc(length);
+  random= (uchar*) malloc(PACKET_SIZE);
+  rows_length= fill_rows(rows, length);
+  random_bytes(random, PACKET_SIZE);
+
+  plan(5 + (my_compress_algorithm_supported(MY_COMPRESS_ZSTD) ? 3 : 0));
+
+  test_algorithm(MY_COMPRESS_ZLIB, "zlib", rows, random);
+  test_zlib_compatibility(rows);
+  if (my_compress_algorithm_supported(MY_COMPRESS_ZSTD))
+    test_algorithm(MY_COMPRESS_ZSTD, "zstd", rows, random);
+
+  bench_all(PACKET_SIZE, rows, rows_length);
+  bench_all(1024, rows, rows_length / 4);
+
+  free(random);
+  free(rows);
+  my_end(0);
+  return exit_status();
+}
@@ -0,0 +1,277 @@
+/* Copyright (c) 2019, MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA */
+
+/*
+  UCA collation tests and microbenchmarks.
+
+  The utf8 and utf8mb4 UCA collations have fast paths for ASCII characters.
+  Their results are checked against the utf32 collations with the same
+  weights, which always use the generic weight scanner.
+
+  Then strnncoll(), strnncollsp() and strnxfrm() are timed on typical
+  ASCII data. The number of rounds can be given as the first argument.
+*/
+
+#include <tap.h>
+#include <my_global.h>
+#include <my_sys.h>
+#include <m_string.h>
+
+#define STRINGS     200
+#define MAX_CHARS   64
+#define XFRM_LENGTH (MAX_CHARS * 2 * 8)
+
+struct uca_string
+{
+  uchar utf8[MAX_CHARS * 3];
+  size_t utf8_length;
+  uchar utf32[MAX_CHARS * 4];
+  size_t utf32_length;
+};
+
+static struct uca_string strings[STRINGS];
+
+/*
+  The characters used for the random strings: ASCII letters and
+  punctuation with equal primary weights, spaces for PAD SPACE
+  comparison, and some BMP characters outside the ASCII range,
+  including one with an implicit weight.
+*/
+static const my_wc_t alphabet[]=
+{
+  'a', 'a', 'b', 'c', 'h', 'A', 'B', 'C', 'H', 'z', '0', '9',
+  ' ', ' ', '-', '_', '.', 0x00E9, 0x00C5, 0x4E00
+};
+
+static ulong rnd_state= 1;
+
+static uint rnd(uint max)
+{
+  rnd_state= rnd_state * 1103515245 + 12345;
+  return (uint) ((rnd_state >> 16) % max);
+}
+
+
+static void add_char(struct uca_string *str, my_wc_t wc)
+{
+  uchar *s= str->utf8 + str->utf8_length;
+  uchar *t= str->utf32 + str->utf32_length;
+  if (wc < 0x80)
+  {
+    s[0]= (uchar) wc;
+    str->utf8_length+= 1;
+  }
+  else if (wc < 0x800)
+  {
+    s[0]= (uchar) (0xC0 | (wc >> 6));
+    s[1]= (uchar) (0x80 | (wc & 0x3F));
+    str->utf8_length+= 2;
+  }
+  else
+  {
+    s[0]= (uchar) (0xE0 | (wc >> 12));
+    s[1]= (uchar) (0x80 | ((wc >> 6) & 0x3F));
+    s[2]= (uchar) (0x80 | (wc & 0x3F));
+    str->utf8_length+= 3;
+  }
+  t[0]= 0;
+  t[1]= 0;
+  t[2]= (uchar) (wc >> 8);
+  t[3]= (uchar) wc;
+  str->utf32_length+= 4;
+}
+
+
+/*
+  Generate strings that share prefixes of different lengths,
+  so that the comparisons find differences at any position.
+*/
+static void generate_strings()
+{
+  my_wc_t base[MAX_CHARS];
+  uint i, j;
+  /* Long ASCII runs first, then any characters */
+  for (i= 0; i < MAX_CHARS; i++)
+    base[i]= alphabet[rnd(i < MAX_CHARS / 2 ?
+                          12 : (uint) array_elements(alphabet))];
+  for (i= 0; i < STRINGS; i++)
+  {
+    struct uca_string *str= &strings[i];
+    uint prefix= rnd(MAX_CHARS - 8);
+    uint length= prefix + rnd(MAX_CHARS - prefix);
+    str->utf8_length= str->utf32_length= 0;
+    for (j= 0; j < prefix; j++)
+      add_char(str, base[j]);
+    for ( ; j < length; j++)
+      add_char(str, alphabet[rnd(array_elements(alphabet))]);
+  }
+}
+
+
+static int sign(int res)
+{
+  return res < 0 ? -1 : res > 0 ? 1 : 0;
+}
+
+
+/*
+  Compare the results of a collation with the fast paths to the results
+  of the utf32 collation with the same weights.
+*/
+static int test_collation(const char *name, const char *utf32_name)
+{
+  CHARSET_INFO *cs= get_charset_by_name(name, MYF(0));
+  CHARSET_INFO *ref= get_charset_by_name(utf32_name, MYF(0));
+  uint i, j, failed= 0;
+
+  if (!cs || !ref)
+  {
+    diag("Collation %s or %s not found", name, utf32_name);
+    return 1;
+  }
+
+  for (i= 0; i < STRINGS; i++)
+  {
+    const struct uca_string *s= &strings[i];
+    uchar buf[XFRM_LENGTH], ref_buf[XFRM_LENGTH];
+    size_t len, ref_len, dstlen;
+
+    for (j= 0; j < STRINGS; j++)
+    {
+      const struct uca_string *t= &strings[j];
+      int res= cs->coll->strnncoll(cs, s->utf8, s->utf8_length,
+                                   t->utf8, t->utf8_length, FALSE);
+      int ref_res= ref->coll->strnncoll(ref, s->utf32, s->utf32_length,
+                                        t->utf32, t->utf32_length, FALSE);
+      if (sign(res) != sign(ref_res))
+      {
+        diag("%s: strnncoll() mismatch for strings %u and %u", name, i, j);
+        failed++;
+      }
+      res= cs->coll->strnncollsp(cs, s->utf8, s->utf8_length,
+                                 t->utf8, t->utf8_length);
+      ref_res= ref->coll->strnncollsp(ref, s->utf32, s->utf32_length,
+                                      t->utf32, t->utf32_length);
+      if (sign(res) != sign(ref_res))
+      {
+        diag("%s: strnncollsp() mismatch for strings %u and %u", name, i, j);
+        failed++;
+      }
+    }
+
+    /* Full images, and images that end in the middle of a weight */
+    for (dstlen= 1; dstlen <= XFRM_LENGTH; dstlen= dstlen * 2 + 1)
+    {
+      len= cs->coll->strnxfrm(cs, buf, dstlen, MAX_CHARS,
+                              s->utf8, s->utf8_length,
+                              MY_STRXFRM_PAD_WITH_SPACE);
+      ref_len= ref->coll->strnxfrm(ref, ref_buf, dstlen, MAX_CHARS,
+                                   s->utf32, s->utf32_length,
+                                   MY_STRXFRM_PAD_WITH_SPACE);
+      if (len != ref_len || memcmp(buf, ref_buf, len))
+      {
+        diag("%s: strnxfrm() mismatch for string %u, dstlen=%u",
+             name, i, (uint) dstlen);
+        failed++;
+      }
+    }
+  }
+  return failed;
+}
+
+
+/*
+  Time the collation functions on ASCII strings that look like typical
+  key values: a long common prefix followed by a short distinct suffix.
+*/
+static void bench_collation(const char *name, uint rounds)
+{
+  CHARSET_INFO *cs= get_charset_by_name(name, MYF(0));
+  char keys[STRINGS][MAX_CHARS];
+  size_t lengths[STRINGS];
+  uchar buf[XFRM_LENGTH];
+  ulonglong start, calls= (ulonglong) rounds * STRINGS;
+  volatile int res= 0;
+  uint i, r;
+
+  if (!cs)
+    return;
+
+  for (i= 0; i < STRINGS; i++)
+    lengths[i]= my_snprintf(keys[i], sizeof(keys[i]),
+                            "customer-account-name-%u",
+                            1000000 + (i * 7919) % 1000);
+
+  start= my_interval_timer();
+  for (r= 0; r < rounds; r++)
+    for (i= 0; i < STRINGS; i++)
+      res+= cs->coll->strnncoll(cs, (uchar *) keys[i], lengths[i],
+                                (uchar *) keys[(i + r) % STRINGS],
+                                lengths[(i + r) % STRINGS], FALSE);
+  diag("%-24s strnncoll   %8.1f ns/call", name,
+       (double) (my_interval_timer() - start) / calls);
+
+  start= my_interval_timer();
+  for (r= 0; r < rounds; r++)
+    for (i= 0; i < STRINGS; i++)
+      res+= cs->coll->strnncollsp(cs, (uchar *) keys[i], lengths[i],
+                                  (uchar *) keys[(i + r) % STRINGS],
+                                  lengths[(i + r) % STRINGS]);
+  diag("%-24s strnncollsp %8.1f ns/call", name,
+       (double) (my_interval_timer() - start) / calls);
+
+  start= my_interval_timer();
+  for (r= 0; r < rounds; r++)
+    for (i= 0; i < STRINGS; i++)
+      res+= (int) cs->coll->strnxfrm(cs, buf, sizeof(buf), MAX_CHARS,
+                                     (uchar *) keys[i], lengths[i], 0);
+  diag("%-24s strnxfrm    %8.1f ns/call", name,
+       (double) (my_interval_timer() - start) / calls);
+}
+
+
+static const char *collations[][2]=
+{
+  {"utf8mb4_unicode_ci",       "utf32_unicode_ci"},
+  {"utf8mb4_unicode_520_ci",   "utf32_unicode_520_ci"},
+  {"utf8mb4_unicode_nopad_ci", "utf32_unicode_nopad_ci"},
+  {"utf8_unicode_ci",          "utf32_unicode_ci"},
+  /* Contractions, these use the generic scanner */
+  {"utf8mb4_czech_ci",         "utf32_czech_ci"},
+  {"utf8_spanish2_ci",         "utf32_spanish2_ci"}
+};
+
+
+int main(int argc __attribute__((unused)), char **argv)
+{
+  uint i, rounds= 100;
+  MY_INIT(argv[0]);
+
+  if (argv[1] && *argv[1])
+    rounds= atoi(argv[1]);
+
+  plan(array_elements(collations));
+  generate_strings();
+
+  for (i= 0; i < array_elements(collations); i++)
+    ok(test_collation(collations[i][0], collations[i][1]) == 0,
+       "Testing %s against %s", collations[i][0], collations[i][1]);
+
+  for (i= 0; i < array_elements(collations); i++)
+    bench_collation(collations[i][0], rounds);
+
+  my_end(0);
+  return exit_status();
+}
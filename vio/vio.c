@@ -209,6 +209,49 @@ my_bool vio_reset(Vio* vio, enum enum_vio_type type,
 }
 
 
+/**
+  Switch buffered reads of a socket-based Vio object on or off.
+
+  @remark Used by the server once the connection is established, when
+          no data can be left in the socket for another transport type
+          any more. The commands that a client sends without waiting
+          for the results are then read ahead with one recv() call.
+
+  @param vio    A VIO object.
+  @param on     Read through the buffer or directly from the socket.
+                The buffer must be empty when it is switched off.
+
+  @return Return value is zero on success.
+*/
+
+my_bool vio_set_buffered_read(Vio *vio, my_bool on)
+{
+  DBUG_ENTER("vio_set_buffered_read");
+#ifdef HAVE_VIO_READ_BUFF
+  if (vio->type != VIO_TYPE_TCPIP && vio->type != VIO_TYPE_SOCKET)
+    DBUG_RETURN(FALSE);
+  if (on && !vio->read_buffer)
+  {
+    if (!(vio->read_buffer= (char*) my_malloc(VIO_READ_BUFFER_SIZE,
+                                              MYF(MY_WME))))
+      DBUG_RETURN(TRUE);
+    vio->read_pos= vio->read_end= vio->read_buffer;
+    vio->read=     vio_read_buff;
+    vio->has_data= vio_buff_has_data;
+  }
+  else if (!on && vio->read_buffer)
+  {
+    DBUG_ASSERT(vio->read_pos == vio->read_end);
+    my_free(vio->read_buffer);
+    vio->read_buffer= vio->read_pos= vio->read_end= NULL;
+    vio->read=     vio_read;
+    vio->has_data= has_no_data;
+  }
+#endif
+  DBUG_RETURN(FALSE);
+}
+
+
 /* Create a new VIO for socket or TCP/IP connection. */
 
 Vio *mysql_socket_vio_new(MYSQL_SOCKET mysql_socket, enum enum_vio_type type, uint flags)
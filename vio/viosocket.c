@@ -1196,6 +1196,10 @@ my_bool vio_is_connected(Vio *vio)
   uint bytes= 0;
   DBUG_ENTER("vio_is_connected");
 
+  /* The peer sent more than was consumed, e.g. pipelined commands */
+  if (vio->read_pos < vio->read_end)
+    DBUG_RETURN(TRUE);
+
   /*
     The first step of detecting an EOF condition is verifying
     whether there is data to read. Data in this case would be